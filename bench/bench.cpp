@@ -0,0 +1,675 @@
+/*================================================================================= *
+*                                   +----------+                                    *
+*                                   | crossput |                                    *
+*                                   +----------+                                    *
+*                            Copyright 2024 Trice Helix                             *
+*                                                                                   *
+* This file is part of crossput and is distributed under the BSD-3-Clause License.  *
+* Please refer to LICENSE.txt for additional information.                           *
+* =================================================================================*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/uinput.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include "crossput.hpp"
+
+
+using namespace std::chrono_literals;
+using bench_clock = std::chrono::steady_clock;
+
+
+// all virtual devices share this prefix, which is used to tell them apart from real hardware
+const std::string DEVICE_NAME_PREFIX = "crossput-bench";
+
+
+struct BenchOptions
+{
+    uint32_t devices_per_type = 2;
+    uint32_t rate = 1000;           // reports per second and device
+    float duration = 2.0F;          // seconds per scenario
+    float settle = 1.0F;            // seconds to wait for device nodes to appear
+    std::string output;             // empty -> stdout
+};
+
+
+// ALLOCATION COUNTING
+
+// per thread, so the flooder does not interfere with the measured updates
+thread_local uint64_t tls_allocations = 0;
+
+
+void *CountedAllocate(const size_t size, const size_t alignment) noexcept
+{
+    tls_allocations++;
+    const size_t n = std::max<size_t>(size, 1);
+    return (alignment <= alignof(std::max_align_t)) ? std::malloc(n) : std::aligned_alloc(alignment, (n + alignment - 1) / alignment * alignment);
+}
+
+
+void *operator new(const size_t size)
+{
+    void *const p = CountedAllocate(size, alignof(std::max_align_t));
+    if (p == nullptr) { throw std::bad_alloc(); }
+    return p;
+}
+
+
+void *operator new(const size_t size, const std::align_val_t alignment)
+{
+    void *const p = CountedAllocate(size, static_cast<size_t>(alignment));
+    if (p == nullptr) { throw std::bad_alloc(); }
+    return p;
+}
+
+
+void *operator new(const size_t size, const std::nothrow_t &) noexcept { return CountedAllocate(size, alignof(std::max_align_t)); }
+void *operator new(const size_t size, const std::align_val_t alignment, const std::nothrow_t &) noexcept { return CountedAllocate(size, static_cast<size_t>(alignment)); }
+void operator delete(void *const p) noexcept { std::free(p); }
+void operator delete(void *const p, size_t) noexcept { std::free(p); }
+void operator delete(void *const p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *const p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+
+// VIRTUAL DEVICES
+
+class VirtualDevice
+{
+private:
+    int fd_ = -1;
+    crossput::DeviceType type_;
+    uint32_t tick_ = 0;
+
+public:
+    VirtualDevice(const crossput::DeviceType type, const uint32_t index) : type_(type)
+    {
+        fd_ = open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd_ < 0)
+        {
+            throw std::runtime_error(std::format("Failed to open /dev/uinput (errno {}). Write permissions are required to create virtual devices.", errno));
+        }
+
+        uinput_setup setup = {};
+        setup.id.bustype = BUS_VIRTUAL;
+        setup.id.vendor = 0x1209; // pid.codes test vendor
+        setup.id.product = 0x0001 + static_cast<uint16_t>(type);
+
+        const char *type_name = "unknown";
+        switch (type)
+        {
+        case crossput::DeviceType::MOUSE:
+            type_name = "mouse";
+            EnableEvent(UI_SET_EVBIT, EV_REL);
+            EnableEvent(UI_SET_RELBIT, REL_X);
+            EnableEvent(UI_SET_RELBIT, REL_Y);
+            EnableEvent(UI_SET_RELBIT, REL_WHEEL);
+            EnableEvent(UI_SET_EVBIT, EV_KEY);
+            EnableEvent(UI_SET_KEYBIT, BTN_LEFT);
+            EnableEvent(UI_SET_KEYBIT, BTN_RIGHT);
+            EnableEvent(UI_SET_KEYBIT, BTN_MIDDLE);
+            break;
+
+        case crossput::DeviceType::KEYBOARD:
+            type_name = "keyboard";
+            EnableEvent(UI_SET_EVBIT, EV_KEY);
+            for (int k = KEY_ESC; k <= KEY_KPDOT; k++) { EnableEvent(UI_SET_KEYBIT, k); }
+            break;
+
+        case crossput::DeviceType::GAMEPAD:
+            type_name = "gamepad";
+            EnableEvent(UI_SET_EVBIT, EV_KEY);
+            for (const int b : {BTN_SOUTH, BTN_EAST, BTN_NORTH, BTN_WEST, BTN_TL, BTN_TR, BTN_SELECT, BTN_START, BTN_THUMBL, BTN_THUMBR})
+            {
+                EnableEvent(UI_SET_KEYBIT, b);
+            }
+
+            EnableEvent(UI_SET_EVBIT, EV_ABS);
+            for (const int a : {ABS_X, ABS_Y, ABS_RX, ABS_RY, ABS_Z, ABS_RZ})
+            {
+                const bool is_trigger = a == ABS_Z || a == ABS_RZ;
+                uinput_abs_setup abs = {};
+                abs.code = static_cast<uint16_t>(a);
+                abs.absinfo.minimum = is_trigger ? 0 : -32768;
+                abs.absinfo.maximum = is_trigger ? 255 : 32767;
+                EnableEvent(UI_SET_ABSBIT, a);
+                if (ioctl(fd_, UI_ABS_SETUP, &abs) < 0) { Fail("UI_ABS_SETUP"); }
+            }
+            break;
+
+        default:
+            Fail("unsupported device type");
+        }
+
+        const std::string name = std::format("{} {} {}", DEVICE_NAME_PREFIX, type_name, index);
+        std::strncpy(setup.name, name.c_str(), UINPUT_MAX_NAME_SIZE - 1);
+        if (ioctl(fd_, UI_DEV_SETUP, &setup) < 0) { Fail("UI_DEV_SETUP"); }
+        if (ioctl(fd_, UI_DEV_CREATE) < 0) { Fail("UI_DEV_CREATE"); }
+    }
+
+    VirtualDevice(const VirtualDevice &) = delete;
+    VirtualDevice &operator=(const VirtualDevice &) = delete;
+
+    ~VirtualDevice()
+    {
+        if (fd_ >= 0)
+        {
+            ioctl(fd_, UI_DEV_DESTROY);
+            close(fd_);
+        }
+    }
+
+    // write a single report, returns number of (non-SYN) input events written
+    uint32_t EmitReport()
+    {
+        uint32_t n = 0;
+        const uint32_t t = tick_++;
+        switch (type_)
+        {
+        case crossput::DeviceType::MOUSE:
+            n += Emit(EV_REL, REL_X, (t & 1) ? 3 : -2);
+            n += Emit(EV_REL, REL_Y, (t & 2) ? 2 : -3);
+            if (t % 8 == 0) { n += Emit(EV_REL, REL_WHEEL, (t & 8) ? 1 : -1); }
+            if (t % 4 == 0) { n += Emit(EV_KEY, BTN_LEFT, (t / 4) & 1); }
+            break;
+
+        case crossput::DeviceType::KEYBOARD:
+            // press and release a rotating set of keys
+            n += Emit(EV_KEY, KEY_A + static_cast<int>((t / 2) % 26), (t & 1) ^ 1);
+            break;
+
+        case crossput::DeviceType::GAMEPAD:
+            {
+                const int sweep = static_cast<int>(t % 512) - 256;
+                n += Emit(EV_ABS, ABS_X, sweep * 128);
+                n += Emit(EV_ABS, ABS_Y, -sweep * 128);
+                n += Emit(EV_ABS, ABS_Z, static_cast<int>(t % 256));
+                if (t % 4 == 0) { n += Emit(EV_KEY, BTN_SOUTH, (t / 4) & 1); }
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        Emit(EV_SYN, SYN_REPORT, 0);
+        return n;
+    }
+
+private:
+    void EnableEvent(const unsigned long request, const int code)
+    {
+        if (ioctl(fd_, request, code) < 0) { Fail("uinput capability setup"); }
+    }
+
+    uint32_t Emit(const int type, const int code, const int value)
+    {
+        input_event ev = {};
+        ev.type = static_cast<uint16_t>(type);
+        ev.code = static_cast<uint16_t>(code);
+        ev.value = value;
+        return (write(fd_, &ev, sizeof(ev)) == static_cast<ssize_t>(sizeof(ev))) ? 1 : 0;
+    }
+
+    [[noreturn]] void Fail(const char *what)
+    {
+        const int e = errno;
+        close(fd_);
+        fd_ = -1;
+        throw std::runtime_error(std::format("Failed to create virtual device: {} (errno {}).", what, e));
+    }
+};
+
+
+// floods all virtual devices at a fixed rate from a background thread
+class Flooder
+{
+private:
+    std::vector<VirtualDevice *> devices_;
+    std::thread thread_;
+    std::atomic<bool> stop_ = false;
+    std::atomic<uint64_t> events_written_ = 0;
+    uint32_t rate_;
+
+public:
+    Flooder(std::vector<VirtualDevice *> devices, const uint32_t rate) : devices_(std::move(devices)), rate_(rate) {}
+    ~Flooder() { Stop(); }
+
+    void Start()
+    {
+        stop_ = false;
+        thread_ = std::thread([this]()
+        {
+            const auto interval = std::chrono::duration_cast<bench_clock::duration>(std::chrono::duration<double>(1.0 / std::max(rate_, 1U)));
+            auto next = bench_clock::now();
+            while (!stop_.load(std::memory_order_relaxed))
+            {
+                uint64_t n = 0;
+                for (VirtualDevice *const p_device : devices_) { n += p_device->EmitReport(); }
+                events_written_.fetch_add(n, std::memory_order_relaxed);
+
+                next += interval;
+                std::this_thread::sleep_until(next);
+            }
+        });
+    }
+
+    void Stop()
+    {
+        stop_ = true;
+        if (thread_.joinable()) { thread_.join(); }
+    }
+
+    uint64_t EventsWritten() const { return events_written_.load(std::memory_order_relaxed); }
+};
+
+
+// MEASUREMENTS
+
+struct ScenarioResult
+{
+    std::string name;
+    uint64_t updates = 0;
+    uint64_t events = 0;
+    uint64_t allocations = 0; // by the measured updates, expected to be zero
+    double update_seconds = 0.0;
+};
+
+
+struct LatencyResult
+{
+    std::vector<double> samples; // microseconds
+};
+
+
+double Seconds(const bench_clock::duration d)
+{
+    return std::chrono::duration<double>(d).count();
+}
+
+
+// repeatedly updates all devices for the configured duration
+ScenarioResult RunScenario(const std::string &name, const BenchOptions &options, Flooder *const p_flooder)
+{
+    ScenarioResult result;
+    result.name = name;
+
+    // drain anything pending from previous scenarios
+    crossput::UpdateAllDevices();
+
+    const uint64_t events_before = p_flooder != nullptr ? p_flooder->EventsWritten() : 0;
+    if (p_flooder != nullptr) { p_flooder->Start(); }
+
+    const auto end = bench_clock::now() + std::chrono::duration_cast<bench_clock::duration>(std::chrono::duration<float>(options.duration));
+    const uint64_t allocations_before = tls_allocations;
+    bench_clock::duration busy = {};
+    while (true)
+    {
+        const auto t0 = bench_clock::now();
+        if (t0 >= end) { break; }
+
+        crossput::UpdateAllDevices();
+        busy += bench_clock::now() - t0;
+        result.updates++;
+    }
+    result.allocations = tls_allocations - allocations_before;
+
+    if (p_flooder != nullptr)
+    {
+        p_flooder->Stop();
+
+        // process events which were written after the last measured update
+        std::this_thread::sleep_for(10ms);
+        const auto t0 = bench_clock::now();
+        crossput::UpdateAllDevices();
+        busy += bench_clock::now() - t0;
+        result.updates++;
+
+        result.events = p_flooder->EventsWritten() - events_before;
+    }
+
+    result.update_seconds = Seconds(busy);
+    return result;
+}
+
+
+// measures the time between the kernel timestamping an event and crossput exposing it via the event history
+LatencyResult RunLatency(const BenchOptions &options, Flooder &flooder, const std::vector<crossput::IDevice *> &devices)
+{
+    constexpr uint32_t HISTORY_CAPACITY = 4096;
+
+    LatencyResult result;
+    std::vector<crossput::InputEvent> events;
+    std::vector<uint64_t> since(devices.size(), 0);
+
+    for (crossput::IDevice *const p_device : devices) { p_device->SetEventHistoryCapacity(HISTORY_CAPACITY); }
+    crossput::UpdateAllDevices();
+    for (size_t i = 0; i < devices.size(); i++)
+    {
+        // skip whatever has been recorded so far
+        events.clear();
+        devices[i]->ReadEvents(0, events);
+        if (!events.empty()) { since[i] = events.back().timestamp + 1; }
+    }
+
+    flooder.Start();
+    const auto end = bench_clock::now() + std::chrono::duration_cast<bench_clock::duration>(std::chrono::duration<float>(options.duration));
+    while (bench_clock::now() < end)
+    {
+        crossput::UpdateAllDevices();
+        const uint64_t now = crossput::NowTimestamp(); // same time base as the event timestamps
+
+        for (size_t i = 0; i < devices.size(); i++)
+        {
+            events.clear();
+            devices[i]->ReadEvents(since[i], events);
+            for (const crossput::InputEvent &ev : events)
+            {
+                if (ev.timestamp <= now) { result.samples.push_back(static_cast<double>(now - ev.timestamp)); }
+                since[i] = std::max(since[i], ev.timestamp + 1);
+            }
+        }
+    }
+    flooder.Stop();
+
+    for (crossput::IDevice *const p_device : devices) { p_device->SetEventHistoryCapacity(0); }
+    std::sort(result.samples.begin(), result.samples.end());
+    return result;
+}
+
+
+double Percentile(const std::vector<double> &sorted, const double p)
+{
+    if (sorted.empty()) { return 0.0; }
+    const size_t index = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+
+#ifdef CROSSPUT_FEATURE_AGGREGATE
+// aggregates all bench devices of each type, returns aggregate IDs
+std::vector<crossput::ID> AggregateByType(const std::vector<crossput::IDevice *> &devices)
+{
+    std::vector<crossput::ID> aggregates;
+    for (const crossput::DeviceType type : {crossput::DeviceType::MOUSE, crossput::DeviceType::KEYBOARD, crossput::DeviceType::GAMEPAD})
+    {
+        std::vector<crossput::ID> ids;
+        for (crossput::IDevice *const p_device : devices)
+        {
+            if (p_device->GetType() == type) { ids.push_back(p_device->GetID()); }
+        }
+
+        if (ids.size() < 2) { continue; }
+
+        crossput::IDevice *const p_aggregate = crossput::Aggregate(ids, type);
+        if (p_aggregate != nullptr) { aggregates.push_back(p_aggregate->GetID()); }
+    }
+    return aggregates;
+}
+#endif // CROSSPUT_FEATURE_AGGREGATE
+
+
+// OUTPUT
+
+std::string ScenarioJson(const ScenarioResult &r)
+{
+    const double updates = static_cast<double>(std::max<uint64_t>(r.updates, 1));
+    const double events = static_cast<double>(std::max<uint64_t>(r.events, 1));
+    return std::format(
+        "    {{\"name\": \"{}\", \"updates\": {}, \"update_seconds\": {:.6f}, \"updates_per_second\": {:.1f}, "
+        "\"update_ns\": {:.1f}, \"events\": {}, \"event_ns\": {:.1f}, \"allocations\": {}}}",
+        r.name,
+        r.updates,
+        r.update_seconds,
+        r.update_seconds > 0.0 ? static_cast<double>(r.updates) / r.update_seconds : 0.0,
+        r.update_seconds * 1E9 / updates,
+        r.events,
+        r.events > 0 ? r.update_seconds * 1E9 / events : 0.0,
+        r.allocations);
+}
+
+
+void PrintUsage()
+{
+    std::cout <<
+        "Usage: crossput-bench [options]\n"
+        "  --devices N     virtual devices per type (default 2)\n"
+        "  --rate HZ       reports per second and device (default 1000)\n"
+        "  --duration S    seconds per scenario (default 2)\n"
+        "  --settle S      seconds to wait for device nodes (default 1)\n"
+        "  --output FILE   write JSON to FILE instead of stdout"
+        << std::endl;
+}
+
+
+bool ParseOptions(const int argc, char **argv, BenchOptions &options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--help" || arg == "-h") { return false; }
+        else if (arg == "--devices" && has_value) { options.devices_per_type = static_cast<uint32_t>(std::stoul(argv[++i])); }
+        else if (arg == "--rate" && has_value) { options.rate = static_cast<uint32_t>(std::stoul(argv[++i])); }
+        else if (arg == "--duration" && has_value) { options.duration = std::stof(argv[++i]); }
+        else if (arg == "--settle" && has_value) { options.settle = std::stof(argv[++i]); }
+        else if (arg == "--output" && has_value) { options.output = argv[++i]; }
+        else
+        {
+            std::cerr << "Unknown or incomplete option \"" << arg << "\"." << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+
+int main(int argc, char **argv)
+{
+    BenchOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    try
+    {
+        // create virtual hardware before crossput touches /dev/input, so the first discovery is cold
+        std::vector<std::unique_ptr<VirtualDevice>> virtual_devices;
+        std::vector<VirtualDevice *> flood_targets;
+        for (const crossput::DeviceType type : {crossput::DeviceType::MOUSE, crossput::DeviceType::KEYBOARD, crossput::DeviceType::GAMEPAD})
+        {
+            for (uint32_t i = 0; i < options.devices_per_type; i++)
+            {
+                virtual_devices.push_back(std::make_unique<VirtualDevice>(type, i));
+                flood_targets.push_back(virtual_devices.back().get());
+            }
+        }
+
+        std::this_thread::sleep_for(std::chrono::duration<float>(options.settle));
+
+        // discovery
+        auto t0 = bench_clock::now();
+        crossput::DiscoverDevices();
+        const double discover_cold = Seconds(bench_clock::now() - t0);
+
+        crossput::DestroyAllDevices();
+        t0 = bench_clock::now();
+        crossput::DiscoverDevices();
+        const double discover_warm = Seconds(bench_clock::now() - t0);
+
+        // nothing changed since the previous discovery
+        t0 = bench_clock::now();
+        crossput::DiscoverDevices();
+        const double discover_unchanged = Seconds(bench_clock::now() - t0);
+
+        // one device plugged in since the previous discovery, it is removed again afterwards
+        std::vector<crossput::IDevice *> known_devices;
+        crossput::GetDevices(known_devices);
+        auto p_hotplugged = std::make_unique<VirtualDevice>(crossput::DeviceType::MOUSE, options.devices_per_type);
+        std::this_thread::sleep_for(std::chrono::duration<float>(options.settle));
+
+        t0 = bench_clock::now();
+        const size_t rescan_found = crossput::DiscoverDevices();
+        const double discover_rescan = Seconds(bench_clock::now() - t0);
+
+        std::vector<crossput::IDevice *> rescanned_devices;
+        crossput::GetDevices(rescanned_devices);
+        for (crossput::IDevice *const p_device : rescanned_devices)
+        {
+            if (std::find(known_devices.begin(), known_devices.end(), p_device) == known_devices.end()) { crossput::DestroyDevice(p_device->GetID()); }
+        }
+        p_hotplugged.reset();
+
+        // only keep virtual devices to make results independent of the host's hardware
+        crossput::UpdateAllDevices();
+        std::vector<crossput::IDevice *> all_devices;
+        crossput::GetDevices(all_devices);
+
+        std::vector<crossput::IDevice *> devices;
+        for (crossput::IDevice *const p_device : all_devices)
+        {
+            if (p_device->GetDisplayName().starts_with(DEVICE_NAME_PREFIX)) { devices.push_back(p_device); }
+            else { crossput::DestroyDevice(p_device->GetID()); }
+        }
+
+        if (devices.size() != virtual_devices.size())
+        {
+            std::cerr << std::format("Only {} of {} virtual devices were discovered. Consider increasing --settle.", devices.size(), virtual_devices.size()) << std::endl;
+            return 1;
+        }
+
+        Flooder flooder(flood_targets, options.rate);
+        std::vector<ScenarioResult> scenarios;
+
+        scenarios.push_back(RunScenario("idle", options, nullptr));
+        scenarios.push_back(RunScenario("flood", options, &flooder));
+
+        #ifdef CROSSPUT_FEATURE_CALLBACK
+        {
+            // trivial handlers so that only dispatch overhead is measured
+            uint64_t num_callbacks = 0;
+            crossput::RegisterGlobalMouseMoveCallback([&](const crossput::IMouse *, int64_t, int64_t, int64_t, int64_t) { num_callbacks++; });
+            crossput::RegisterGlobalMouseScrollCallback([&](const crossput::IMouse *, int64_t, int64_t, int64_t, int64_t) { num_callbacks++; });
+            crossput::RegisterGlobalMouseButtonCallback([&](const crossput::IMouse *, uint32_t, float, bool) { num_callbacks++; });
+            crossput::RegisterGlobalKeyboardKeyCallback([&](const crossput::IKeyboard *, crossput::Key, float, bool) { num_callbacks++; });
+            crossput::RegisterGlobalGamepadButtonCallback([&](const crossput::IGamepad *, crossput::Button, float, bool) { num_callbacks++; });
+            crossput::RegisterGlobalGamepadThumbstickCallback([&](const crossput::IGamepad *, uint32_t, float, float) { num_callbacks++; });
+
+            scenarios.push_back(RunScenario("flood_callbacks", options, &flooder));
+            crossput::UnregisterAllCallbacks();
+        }
+        #endif // CROSSPUT_FEATURE_CALLBACK
+
+        #ifdef CROSSPUT_FEATURE_AGGREGATE
+        {
+            const std::vector<crossput::ID> aggregates = AggregateByType(devices);
+            if (!aggregates.empty())
+            {
+                scenarios.push_back(RunScenario("flood_aggregate", options, &flooder));
+                for (const crossput::ID id : aggregates) { crossput::DestroyDevice(id); }
+            }
+        }
+        #endif // CROSSPUT_FEATURE_AGGREGATE
+
+        const LatencyResult latency = RunLatency(options, flooder, devices);
+
+        // assemble report
+        std::string json = "{\n";
+        json += std::format(
+            "  \"config\": {{\"devices_per_type\": {}, \"rate_hz\": {}, \"duration_s\": {:.3f}, "
+            "\"feature_callback\": {}, \"feature_force\": {}, \"feature_aggregate\": {}}},\n",
+            options.devices_per_type, options.rate, options.duration,
+            #ifdef CROSSPUT_FEATURE_CALLBACK
+            true,
+            #else
+            false,
+            #endif // CROSSPUT_FEATURE_CALLBACK
+            #ifdef CROSSPUT_FEATURE_FORCE
+            true,
+            #else
+            false,
+            #endif // CROSSPUT_FEATURE_FORCE
+            #ifdef CROSSPUT_FEATURE_AGGREGATE
+            true
+            #else
+            false
+            #endif // CROSSPUT_FEATURE_AGGREGATE
+        );
+        json += std::format(
+            "  \"discover\": {{\"devices\": {}, \"cold_ms\": {:.3f}, \"warm_ms\": {:.3f}, \"unchanged_ms\": {:.3f}, \"rescan_ms\": {:.3f}, \"rescan_found\": {}}},\n",
+            devices.size(), discover_cold * 1E3, discover_warm * 1E3, discover_unchanged * 1E3, discover_rescan * 1E3, rescan_found);
+
+        json += "  \"scenarios\": [\n";
+        for (size_t i = 0; i < scenarios.size(); i++)
+        {
+            json += ScenarioJson(scenarios[i]);
+            json += (i + 1 < scenarios.size()) ? ",\n" : "\n";
+        }
+        json += "  ],\n";
+
+        json += std::format(
+            "  \"latency_us\": {{\"samples\": {}, \"p50\": {:.1f}, \"p90\": {:.1f}, \"p99\": {:.1f}, \"p999\": {:.1f}, \"max\": {:.1f}}}\n",
+            latency.samples.size(),
+            Percentile(latency.samples, 0.5),
+            Percentile(latency.samples, 0.9),
+            Percentile(latency.samples, 0.99),
+            Percentile(latency.samples, 0.999),
+            latency.samples.empty() ? 0.0 : latency.samples.back());
+        json += "}\n";
+
+        crossput::DestroyAllDevices();
+
+        // steady-state updates must not allocate
+        bool allocated = false;
+        for (const ScenarioResult &r : scenarios)
+        {
+            if (r.allocations != 0)
+            {
+                std::cerr << std::format("Scenario \"{}\" allocated {} times during steady-state updates.", r.name, r.allocations) << std::endl;
+                allocated = true;
+            }
+        }
+
+        if (options.output.empty())
+        {
+            std::cout << json;
+        }
+        else
+        {
+            std::ofstream file(options.output);
+            file << json;
+            if (!file)
+            {
+                std::cerr << "Failed to write " << options.output << std::endl;
+                return 1;
+            }
+        }
+
+        if (allocated) { return 1; }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -17,6 +17,12 @@
 #include <string>
 #include <vector>
 
+// awaitables require C++20 coroutines in the including translation unit, the library itself always provides them
+#if defined(CROSSPUT_FEATURE_CALLBACK) && (__cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)) && __has_include(<coroutine>)
+#include <coroutine>
+#define CROSSPUT_COROUTINES
+#endif
+
 
 namespace crossput
 {
@@ -27,6 +33,7 @@ namespace crossput
 
     #ifdef CROSSPUT_FEATURE_FORCE
     class IForce;
+    class IForceStream;
     #endif // CROSSPUT_FEATURE_FORCE
 
 
@@ -204,6 +211,9 @@ namespace crossput
     /// @brief Total number of valid cross-platform keys (crossput::Key enum).
     inline constexpr size_t NUM_KEY_CODES = 112;
 
+    /// @brief Number of 64-bit words required to store one digital state bit per key (see IKeyboard::GetKeyStates()).
+    inline constexpr size_t NUM_KEY_STATE_WORDS = (NUM_KEY_CODES + 63) / 64;
+
     /// @brief Inputs which do not have a cross-platform representation are internally handled using this value.
     ///        To check whether a key is actually valid or not, use IsValidKey().
     inline constexpr Key INVALID_KEY = static_cast<Key>(255U);
@@ -266,13 +276,135 @@ namespace crossput
     /// @brief Total number of valid cross-platform buttons (crossput::Button enum).
     inline constexpr size_t NUM_BUTTON_CODES = 16;
 
+    /// @brief Number of 64-bit words required to store one digital state bit per button (see IGamepad::GetButtonStates()).
+    inline constexpr size_t NUM_BUTTON_STATE_WORDS = (NUM_BUTTON_CODES + 63) / 64;
+
     /// @brief Inputs which do not have a cross-platform representation are internally handled using this value.
     ///        To check whether a button is actually valid or not, use IsValidButton().
     inline constexpr Button INVALID_BUTTON = static_cast<Button>(255U);
     constexpr bool IsValidButton(const Button button) noexcept { return static_cast<int>(button) < NUM_BUTTON_CODES; }
 
 
-    #ifdef CROSSPUT_FEATURE_CALLBACK
+    /// @brief Non-virtual read access to the buttons or keys of a device (see IMouse::GetButtonView(), IKeyboard::GetKeyView(), and IGamepad::GetButtonView()).
+    ///        Reads are inlined loads from the internal state of the device, which always reflect its most recent update.
+    ///        Intended for frequent reads in hot loops, the results are identical to the ones of the corresponding virtual methods.
+    ///        A view remains valid until its device is destroyed. Everything reads as released while the device is disconnected.
+    class StateView
+    {
+    private:
+        const float *p_values_;
+        const uint64_t *p_states_;
+        const uint64_t *p_timestamps_;
+        const bool *p_is_connected_;
+        uint32_t count_;
+
+    public:
+        /// @brief Create an empty view, which reads as released.
+        StateView() noexcept : p_values_(nullptr), p_states_(nullptr), p_timestamps_(nullptr), p_is_connected_(nullptr), count_(0) {}
+
+        StateView(const float *const p_values, const uint64_t *const p_states, const uint64_t *const p_timestamps, const bool *const p_is_connected, const uint32_t count) noexcept :
+            p_values_(p_values), p_states_(p_states), p_timestamps_(p_timestamps), p_is_connected_(p_is_connected), count_(count) {}
+
+        /// @return Number of readable entries, indexed by mouse button index, Key, or Button. Indices beyond this number read as released.
+        inline uint32_t GetCount() const noexcept { return count_; }
+
+        /// @return True if the entry is currently "pressed" (see e.g. IKeyboard::GetKeyState()).
+        inline bool GetState(const uint32_t index) const noexcept
+        {
+            return index < count_ && *p_is_connected_ && ((p_states_[index / 64] >> (index % 64)) & 1) != 0;
+        }
+
+        /// @return Normalized state value of the entry in range [0.0;1.0] (see e.g. IKeyboard::GetKeyValue()).
+        inline float GetValue(const uint32_t index) const noexcept
+        {
+            return (index < count_ && *p_is_connected_) ? p_values_[index] : 0.0F;
+        }
+
+        /// @return Timestamp of the last state change of the entry in microseconds, zero if it never changed (see e.g. IKeyboard::GetKeyTimestamps()).
+        inline uint64_t GetTimestamp(const uint32_t index) const noexcept
+        {
+            return (index < count_ && *p_is_connected_) ? p_timestamps_[index] : 0;
+        }
+
+        inline bool GetState(const Key key) const noexcept { return GetState(static_cast<uint32_t>(key)); }
+        inline float GetValue(const Key key) const noexcept { return GetValue(static_cast<uint32_t>(key)); }
+        inline uint64_t GetTimestamp(const Key key) const noexcept { return GetTimestamp(static_cast<uint32_t>(key)); }
+        inline bool GetState(const Button button) const noexcept { return GetState(static_cast<uint32_t>(button)); }
+        inline float GetValue(const Button button) const noexcept { return GetValue(static_cast<uint32_t>(button)); }
+        inline uint64_t GetTimestamp(const Button button) const noexcept { return GetTimestamp(static_cast<uint32_t>(button)); }
+    };
+
+
+    /// @brief Kind of input recorded in the event history of a device.
+    ///        Values of this enum are sequential unsigned integers starting at 0.
+    enum class InputEventType : uint8_t
+    {
+        /// @brief Mouse moved. Uses InputEvent::delta.
+        MOUSE_MOVE = 0,
+
+        /// @brief Mouse wheel scrolled. Uses InputEvent::delta.
+        MOUSE_SCROLL,
+
+        /// @brief Value and/or state of a mouse button changed. InputEvent::code is the button index. Uses InputEvent::value and InputEvent::state.
+        MOUSE_BUTTON,
+
+        /// @brief Value and/or state of a keyboard key changed. InputEvent::code is a value of the Key enum. Uses InputEvent::value and InputEvent::state.
+        KEYBOARD_KEY,
+
+        /// @brief Value and/or state of a gamepad button changed. InputEvent::code is a value of the Button enum. Uses InputEvent::value and InputEvent::state.
+        GAMEPAD_BUTTON,
+
+        /// @brief Position of a thumbstick changed. InputEvent::code is the thumbstick index. Uses InputEvent::axes.
+        GAMEPAD_THUMBSTICK
+    };
+
+
+    /// @brief Absolute position on two axes, e.g. of a thumbstick.
+    struct InputEventAxes
+    {
+        float x;
+        float y;
+    };
+
+
+    /// @brief Relative movement on two axes, e.g. of a mouse or its scroll wheel.
+    struct InputEventDelta
+    {
+        int32_t dx;
+        int32_t dy;
+    };
+
+
+    /// @brief Compact record of a single change of input, stored in the event history of a device.
+    struct InputEvent
+    {
+        /// @brief Timestamp provided by the underlying hardware/driver in microseconds, unmodified. Aggregates use the timestamp of their update.
+        ///        All timestamps share the monotonic time base of NowTimestamp(), regardless of the platform or kind of device.
+        uint64_t timestamp;
+
+        /// @brief Kind of input, which also determines the meaning of the remaining fields.
+        InputEventType type;
+
+        /// @brief New digital state of a button/key.
+        bool state;
+
+        /// @brief Button index, Key, Button, or thumbstick index.
+        uint16_t code;
+
+        union
+        {
+            /// @brief New analog value of a button/key.
+            float value;
+
+            /// @brief New position of a thumbstick.
+            InputEventAxes axes;
+
+            /// @brief Movement since the previous event of the same type.
+            InputEventDelta delta;
+        };
+    };
+
+
     /// @brief Information about an event that involved a change in a device's status.
     ///        Values of this enum are sequential unsigned integers starting at 0.
     enum class DeviceStatusChange : uint8_t
@@ -292,6 +424,49 @@ namespace crossput
     };
 
 
+    /// @brief Determines when UpdateAllDevices() updates a device. Explicit invocations of IDevice::Update() are not affected.
+    ///        Values of this enum are sequential unsigned integers starting at 0.
+    enum class UpdatePolicy : uint8_t
+    {
+        /// @brief Updated during every invocation of UpdateAllDevices(). This is the default.
+        ALWAYS = 0,
+
+        /// @brief Updated during every invocation while its input changes. After ADAPTIVE_IDLE_UPDATES updates without any change,
+        ///        the number of invocations between two updates doubles, up to the maximum interval of the device. Any change restores it to 1.
+        ///        While disconnected, reconnecting is attempted with exponential backoff, up to MAX_RECONNECT_INTERVAL invocations apart.
+        ///        Native input is buffered by the platform in the meantime, so skipped updates delay input but do not lose it.
+        ADAPTIVE,
+
+        /// @brief Never updated by UpdateAllDevices(), only by explicit invocations of IDevice::Update().
+        MANUAL
+    };
+
+    /// @brief Number of consecutive updates without any change after which the interval of a device with policy UpdatePolicy::ADAPTIVE grows.
+    inline constexpr uint32_t ADAPTIVE_IDLE_UPDATES = 4;
+
+    /// @brief Default maximum number of invocations of UpdateAllDevices() between two updates of an idle device with policy UpdatePolicy::ADAPTIVE.
+    inline constexpr uint32_t DEFAULT_MAX_UPDATE_INTERVAL = 8;
+
+    /// @brief Upper limit of the maximum update interval of any device.
+    inline constexpr uint32_t MAX_UPDATE_INTERVAL = 1024;
+
+    /// @brief Maximum number of invocations of UpdateAllDevices() between two attempts to reconnect a device with policy UpdatePolicy::ADAPTIVE.
+    inline constexpr uint32_t MAX_RECONNECT_INTERVAL = 256;
+
+
+    #ifdef CROSSPUT_FEATURE_CALLBACK
+    /// @brief Determines when callbacks for changes of input are invoked. Status callbacks are always invoked immediately.
+    ///        Values of this enum are sequential unsigned integers starting at 0.
+    enum class CallbackDelivery : uint8_t
+    {
+        /// @brief Callbacks are invoked as soon as a change of input is processed, i.e. during device updates. This is the default.
+        IMMEDIATE = 0,
+
+        /// @brief Changes of input are queued during device updates, and the callbacks are invoked later via DispatchPendingCallbacks().
+        DEFERRED
+    };
+
+
     namespace impl
     {
         template <typename TDevice, typename... TData>
@@ -521,9 +696,65 @@ namespace crossput
         /// @brief Update the input data of this device to the most recent state provided by the underlying hardware/driver.
         ///        If this device is currently disconnected, this will also attempt to reconnect.
         ///        Aggregates update all of their member devices and perform some additional operations to freeze input data until the next update.
+        ///        Once connected, updating a device does not allocate memory, except for the first time internal buffers grow to fit the device's input rate.
         ///        Invoking this method during a callback will throw an exception.
         virtual void Update() = 0;
 
+        /// @brief Set the maximum number of native input events fetched from the operating system with a single read operation during Update().
+        ///        Larger batches reduce the overhead per event for high-rate devices (e.g. gaming mice), at the cost of a slightly larger buffer per device.
+        ///        Platforms which do not read native events in batches ignore this value.
+        ///        Aggregates apply the value to all of their members.
+        /// @param size Number of events, clamped to an implementation-defined range. The default is 64.
+        virtual void SetReadBatchSize(const uint32_t size) = 0;
+
+        /// @return Maximum number of native input events fetched from the operating system with a single read operation.
+        virtual uint32_t GetReadBatchSize() const = 0;
+
+        /// @brief Set the number of input events retained in the event history of this device, which records every change of input in order.
+        ///        Memory for the history is allocated once by this method, recording events never allocates.
+        ///        Any existing history is discarded. The history is disabled by default.
+        ///        Invoking this method during a callback will throw an exception.
+        /// @param capacity Maximum number of events retained, where 0 disables the history. Once full, the oldest events are overwritten.
+        virtual void SetEventHistoryCapacity(const uint32_t capacity) = 0;
+
+        /// @return Maximum number of events retained in the event history of this device, or 0 if it is disabled.
+        virtual uint32_t GetEventHistoryCapacity() const = 0;
+
+        /// @brief Copy all events from the history of this device with a timestamp greater than the given one, from oldest to newest.
+        ///        If more events than max_events are available, only the newest ones are copied.
+        /// @param since_timestamp Exclusive lower bound, e.g. the timestamp of the last event previously read. 0 reads the entire history.
+        /// @param events Destination array of at least max_events elements.
+        /// @param max_events Maximum number of events to copy.
+        /// @return Number of events copied.
+        virtual size_t ReadEvents(const uint64_t since_timestamp, InputEvent *const events, const size_t max_events) const = 0;
+
+        /// @brief Append all events from the history of this device with a timestamp greater than the given one to a vector, from oldest to newest.
+        /// @param since_timestamp Exclusive lower bound, e.g. the timestamp of the last event previously read. 0 reads the entire history.
+        /// @param events Vector the events are appended to.
+        /// @return Number of events appended.
+        virtual size_t ReadEvents(const uint64_t since_timestamp, std::vector<InputEvent> &events) const = 0;
+
+        /// @return Global generation (see GetGlobalGeneration()) of the most recent change of input or status of this device, 0 if it never changed.
+        ///         Values of different devices are drawn from the same counter and can therefore be compared.
+        virtual uint64_t GetGeneration() const = 0;
+
+        /// @brief Set the policy which determines when UpdateAllDevices() updates this device.
+        ///        Members of aggregates are updated by their aggregates, so their own policy only takes effect once they are no members anymore.
+        /// @param policy The default is UpdatePolicy::ALWAYS.
+        /// @param max_interval Maximum number of invocations of UpdateAllDevices() between two updates while idle (UpdatePolicy::ADAPTIVE only),
+        ///        i.e. lower values prioritize the device. Clamped to range [1;MAX_UPDATE_INTERVAL].
+        virtual void SetUpdatePolicy(const UpdatePolicy policy, const uint32_t max_interval = DEFAULT_MAX_UPDATE_INTERVAL) = 0;
+
+        /// @return Policy which determines when UpdateAllDevices() updates this device.
+        virtual UpdatePolicy GetUpdatePolicy() const = 0;
+
+        /// @return Maximum number of invocations of UpdateAllDevices() between two updates of this device while idle (UpdatePolicy::ADAPTIVE only).
+        virtual uint32_t GetMaxUpdateInterval() const = 0;
+
+        /// @return Timestamp (in microseconds) of the most recent update of this device, whether via UpdateAllDevices() or explicitly,
+        ///         including updates that only attempted to reconnect. 0 if it was never updated.
+        virtual uint64_t GetLastUpdateTimestamp() const = 0;
+
         #ifdef CROSSPUT_FEATURE_CALLBACK
         /// @brief Whenever this device's status changes, the callback is invoked.
         ///        Invoking this method during a callback will throw an exception.
@@ -589,6 +820,31 @@ namespace crossput
         ///        All pointers and references to affected forces are invalidated.
         ///        This method works on disconnected devices.
         virtual void DestroyAllForces() = 0;
+
+        /// @brief Upload the parameters of all forces created by this device that were modified since they were last uploaded, in a single pass.
+        ///        Forces whose parameters did not change are skipped, so modifying multiple forces via IForce::Params() and committing them once per frame is cheap.
+        ///        Aggregates commit the forces of all underlying members.
+        ///        Does nothing if this device is disconnected.
+        virtual void CommitForces() = 0;
+
+        /// @brief Start a worker thread dedicated to uploading force parameters of this device at a fixed rate (e.g. 500-1000 Hz for wheels and flight sticks),
+        ///        independent of the thread that updates devices. New parameters are pushed into the stream from any single thread without blocking,
+        ///        and the worker only uploads the newest parameters of each force per iteration.
+        ///        While the stream is running, forces of this device must be started before and must not be accessed via IForce::Params(), IForce::WriteParams(),
+        ///        IForce::SetActive(), or CommitForces(). Creating and destroying forces, as well as updating and destroying this device, remain safe.
+        ///        Aggregates do not support streaming, start streams on their members instead.
+        ///        Invoking this method during a callback will throw an exception.
+        /// @param interval Minimum amount of time between two iterations of the worker in seconds, at least MIN_FORCE_STREAM_INTERVAL (smaller values are raised to it).
+        ///                 Only used if the stream was not running yet.
+        /// @param p_stream If this method returns true, pointer to the stream, which is valid until StopForceStream() is invoked or this device is destroyed.
+        ///                 Otherwise, the value will be nullptr.
+        /// @return True if the stream is running (including streams started previously), false if this device does not support streaming.
+        virtual bool TryStartForceStream(const float interval, IForceStream *&p_stream) = 0;
+
+        /// @brief Stop the force stream of this device and wait for the worker to finish its current iteration.
+        ///        Parameters which are still queued are discarded. Does nothing if no stream is running.
+        ///        Invoking this method during a callback will throw an exception.
+        virtual void StopForceStream() = 0;
         #endif // CROSSPUT_FEATURE_FORCE
 
         #ifdef CROSSPUT_FEATURE_AGGREGATE
@@ -602,6 +858,10 @@ namespace crossput
     };
 
 
+    /// @brief Number of mouse buttons whose changes are tracked individually (see IMouse::GetChangedButtons()).
+    inline constexpr size_t MAX_TRACKED_MOUSE_BUTTONS = 64;
+
+
     /// @brief Cross-Platform mouse interface.
     class IMouse : public virtual IDevice
     {
@@ -673,6 +933,37 @@ namespace crossput
             return GetButtonState(index, t);
         }
 
+        /// @brief Copy the digital states of all buttons into a bitset in a single call.
+        ///        Bit (i % 64) of word (i / 64) is set if the button with index i is currently "pressed".
+        ///        All bits are cleared if the mouse is disconnected.
+        /// @param states Destination bitset.
+        /// @param num_words Number of 64-bit words the destination can hold.
+        virtual void GetButtonStates(uint64_t *const states, const size_t num_words) const = 0;
+
+        /// @brief Copy the normalized state values of all buttons in a single call (see GetButtonValue()).
+        /// @param values Destination array indexed by button index.
+        /// @param max_count Number of values the destination can hold.
+        /// @return Number of values written, which is the smaller one of max_count and GetButtonCount().
+        virtual uint32_t GetButtonValues(float *const values, const uint32_t max_count) const = 0;
+
+        /// @brief Copy the timestamps of the last state changes of all buttons in a single call.
+        ///        Timestamps are in microseconds and share the time base of InputEvent::timestamp. Zero indicates that the state never changed.
+        /// @param timestamps Destination array indexed by button index.
+        /// @param max_count Number of timestamps the destination can hold.
+        /// @return Number of timestamps written, which is the smaller one of max_count and GetButtonCount().
+        virtual uint32_t GetButtonTimestamps(uint64_t *const timestamps, const uint32_t max_count) const = 0;
+
+        /// @brief Query which buttons changed their value or state after the given generation in a single call.
+        ///        Bit (i % 64) of word (i / 64) is set if the button with index i changed. Only the first MAX_TRACKED_MOUSE_BUTTONS buttons are tracked.
+        ///        Changes of connection status are not reflected by individual bits, but by GetGeneration().
+        /// @param since_generation Exclusive lower bound, e.g. the value of GetGlobalGeneration() after the previous query.
+        /// @param changed Destination bitset.
+        /// @param num_words Number of 64-bit words the destination can hold.
+        virtual void GetChangedButtons(const uint64_t since_generation, uint64_t *const changed, const size_t num_words) const = 0;
+
+        /// @return View of the buttons which reads them without virtual calls, valid until the mouse is destroyed (see StateView).
+        virtual StateView GetButtonView() const = 0;
+
         #ifdef CROSSPUT_FEATURE_CALLBACK
         /// @brief Whenever the mouse is moved, the callback is invoked.
         ///        The values provided to the callback may be more precise (multiple smaller increments) than the total "delta" between updates.
@@ -744,6 +1035,31 @@ namespace crossput
             return GetKeyState(key, t);
         }
 
+        /// @brief Copy the digital states of all keys into a bitset in a single call.
+        ///        Bit (i % 64) of word (i / 64) is set if the key with code i is currently "pressed".
+        ///        All bits are cleared if the keyboard is disconnected.
+        /// @param states Destination of at least NUM_KEY_STATE_WORDS words.
+        virtual void GetKeyStates(uint64_t *const states) const = 0;
+
+        /// @brief Copy the normalized state values of all keys in a single call (see GetKeyValue()).
+        /// @param values Destination of at least NUM_KEY_CODES values, indexed by key code.
+        virtual void GetKeyValues(float *const values) const = 0;
+
+        /// @brief Copy the timestamps of the last state changes of all keys in a single call.
+        ///        Timestamps are in microseconds and share the time base of InputEvent::timestamp. Zero indicates that the state never changed.
+        /// @param timestamps Destination of at least NUM_KEY_CODES timestamps, indexed by key code.
+        virtual void GetKeyTimestamps(uint64_t *const timestamps) const = 0;
+
+        /// @brief Query which keys changed their value or state after the given generation in a single call.
+        ///        Bit (i % 64) of word (i / 64) is set if the key with code i changed.
+        ///        Changes of connection status are not reflected by individual bits, but by GetGeneration().
+        /// @param since_generation Exclusive lower bound, e.g. the value of GetGlobalGeneration() after the previous query.
+        /// @param changed Destination of at least NUM_KEY_STATE_WORDS words.
+        virtual void GetChangedKeys(const uint64_t since_generation, uint64_t *const changed) const = 0;
+
+        /// @return View of the keys which reads them without virtual calls, valid until the keyboard is destroyed (see StateView).
+        virtual StateView GetKeyView() const = 0;
+
         #ifdef CROSSPUT_FEATURE_CALLBACK
         /// @brief Whenever the digital state or analog value of any key changes, the callback is invoked.
         ///        The key value/state provided to the callback may be an intermediate between updates that is not equal to the final value/state.
@@ -766,6 +1082,32 @@ namespace crossput
     };
 
 
+    /// @brief Number of thumbsticks per gamepad which can have an individual AxisProfile.
+    inline constexpr size_t MAX_THUMBSTICK_PROFILES = 8;
+
+    /// @brief Post-processing of an analog input, applied once whenever the input changes during the update of a gamepad.
+    ///        For thumbsticks, the profile is applied radially to the magnitude of the position, so the direction is preserved.
+    ///        The magnitude is mapped by removing both deadzones, rescaling the remainder to [0.0, 1.0], applying the response curve,
+    ///        and finally rescaling the result to [anti_deadzone, 1.0].
+    struct AxisProfile
+    {
+        /// @brief Magnitudes up to this value read as 0, clamped to [0.0, 1.0).
+        float deadzone;
+
+        /// @brief Magnitudes of at least 1 - outer_deadzone read as 1, clamped to [0.0, 1.0 - deadzone).
+        float outer_deadzone;
+
+        /// @brief Smallest magnitude reported outside of the deadzone (e.g. to compensate for a deadzone of the consumer), clamped to [0.0, 1.0).
+        float anti_deadzone;
+
+        /// @brief Exponent of the response curve, 1 is linear and greater values give finer control close to the center. Clamped to [0.1, 10.0].
+        float exponent;
+    };
+
+    /// @brief Profile which leaves values unmodified, used by default.
+    inline constexpr AxisProfile LINEAR_AXIS_PROFILE = {0.0F, 0.0F, 0.0F, 1.0F};
+
+
     /// @brief Cross-platform gamepad interface.
     class IGamepad : public virtual IDevice
     {
@@ -797,6 +1139,31 @@ namespace crossput
             return GetButtonState(button, t);
         }
 
+        /// @brief Copy the digital states of all buttons and triggers into a bitset in a single call.
+        ///        Bit (i % 64) of word (i / 64) is set if the button with code i is currently "pressed".
+        ///        All bits are cleared if the gamepad is disconnected.
+        /// @param states Destination of at least NUM_BUTTON_STATE_WORDS words.
+        virtual void GetButtonStates(uint64_t *const states) const = 0;
+
+        /// @brief Copy the normalized state values of all buttons and triggers in a single call (see GetButtonValue()).
+        /// @param values Destination of at least NUM_BUTTON_CODES values, indexed by button code.
+        virtual void GetButtonValues(float *const values) const = 0;
+
+        /// @brief Copy the timestamps of the last state changes of all buttons and triggers in a single call.
+        ///        Timestamps are in microseconds and share the time base of InputEvent::timestamp. Zero indicates that the state never changed.
+        /// @param timestamps Destination of at least NUM_BUTTON_CODES timestamps, indexed by button code.
+        virtual void GetButtonTimestamps(uint64_t *const timestamps) const = 0;
+
+        /// @brief Query which buttons and triggers changed their value or state after the given generation in a single call.
+        ///        Bit (i % 64) of word (i / 64) is set if the button with code i changed.
+        ///        Changes of connection status and thumbsticks are not reflected by individual bits, but by GetGeneration().
+        /// @param since_generation Exclusive lower bound, e.g. the value of GetGlobalGeneration() after the previous query.
+        /// @param changed Destination of at least NUM_BUTTON_STATE_WORDS words.
+        virtual void GetChangedButtons(const uint64_t since_generation, uint64_t *const changed) const = 0;
+
+        /// @return View of the buttons and triggers which reads them without virtual calls, valid until the gamepad is destroyed (see StateView).
+        virtual StateView GetButtonView() const = 0;
+
         /// @return Number of thumbsticks that can be queried via GetThumbstick().
         ///         This may not be the number of physical thumbsticks of the hardware.
         virtual uint32_t GetThumbstickCount() const = 0;
@@ -808,6 +1175,37 @@ namespace crossput
         /// @param y Vertical value in range [-1.0;+1.0].  (negative v | ^ positive)
         virtual void GetThumbstick(const uint32_t index, float &x, float &y) const = 0;
 
+        /// @brief Copy the positions of all thumbsticks in a single call (see GetThumbstick()).
+        /// @param xy Destination array receiving interleaved x and y values, which must be able to hold 2 * max_count values.
+        /// @param max_count Number of thumbsticks the destination can hold.
+        /// @return Number of thumbsticks written, which is the smaller one of max_count and GetThumbstickCount().
+        virtual uint32_t GetThumbsticks(float *const xy, const uint32_t max_count) const = 0;
+
+        /// @brief Get the position of a thumbstick before its profile was applied (see SetThumbstickProfile()).
+        /// @param index Index of the thumbstick.
+        /// @param x Set to the unprocessed X position, which is 0 for invalid indices or while disconnected.
+        /// @param y Set to the unprocessed Y position, which is 0 for invalid indices or while disconnected.
+        virtual void GetRawThumbstick(const uint32_t index, float &x, float &y) const = 0;
+
+        /// @brief Set the post-processing of a thumbstick, which takes effect with its next movement.
+        ///        Values provided to thumbstick callbacks are processed, so callbacks are only invoked if the processed position changes
+        ///        (e.g. not at all while the thumbstick jitters within its deadzone).
+        /// @param index Index of the thumbstick, a value of MAX_THUMBSTICK_PROFILES or greater is ignored.
+        /// @param profile Profile applied to the thumbstick, see AxisProfile for the valid ranges.
+        virtual void SetThumbstickProfile(const uint32_t index, const AxisProfile &profile) = 0;
+
+        /// @return Profile of the thumbstick, LINEAR_AXIS_PROFILE for invalid indices.
+        virtual AxisProfile GetThumbstickProfile(const uint32_t index) const = 0;
+
+        /// @brief Set the post-processing of an analog button (usually a trigger), which takes effect with its next change.
+        ///        The profile is applied before the threshold, and purely digital buttons are unaffected.
+        /// @param button Button to which the profile applies, invalid buttons are ignored.
+        /// @param profile Profile applied to the button, see AxisProfile for the valid ranges.
+        virtual void SetButtonProfile(const Button button, const AxisProfile &profile) = 0;
+
+        /// @return Profile of the button, LINEAR_AXIS_PROFILE for invalid buttons.
+        virtual AxisProfile GetButtonProfile(const Button button) const = 0;
+
         #ifdef CROSSPUT_FEATURE_CALLBACK
         /// @brief Whenever the digital state or analog value of any button or trigger changes, the callback is invoked.
         ///        The button or trigger value/state provided to the callback may be an intermediate between updates that is not equal to the final value/state.
@@ -878,6 +1276,7 @@ namespace crossput
         virtual ForceParams &Params() noexcept = 0;
 
         /// @brief Upload the current force parameters to the hardware.
+        ///        If the parameters are equal to the ones previously uploaded, the upload may be skipped.
         ///        Will always fail if the force has been orphaned or the type set within the parameters has changed.
         /// @return True if the current parameters have been uploaded to the hardware, false otherwise.
         virtual bool WriteParams() = 0;
@@ -897,9 +1296,70 @@ namespace crossput
         IForce() noexcept = default;
         virtual ~IForce() = default;
     };
+
+
+    /// @brief Lower limit of the interval of a force stream in seconds, i.e. the worker never uploads at more than 1 kHz.
+    inline constexpr float MIN_FORCE_STREAM_INTERVAL = 0.001F;
+
+    /// @brief Lock-free channel to the worker of a force stream (see IDevice::TryStartForceStream()).
+    class IForceStream
+    {
+    public:
+        /// @brief Number of parameter updates that can be queued at once.
+        static constexpr size_t QUEUE_CAPACITY = 256;
+
+        /// @return ID of the device whose forces are streamed.
+        virtual ID GetDeviceID() const noexcept = 0;
+
+        /// @brief Queue new parameters for a force of the streaming device, which the worker uploads during its next iteration.
+        ///        If multiple parameters are queued for the same force in between two iterations, only the newest ones are uploaded.
+        ///        This method never blocks and may be invoked from any thread, but only from a single thread at a time.
+        /// @param force_id Value returned by IForce::GetID(). Parameters of forces which do not exist (anymore) are discarded by the worker.
+        /// @return True if the parameters were queued, false if the queue is full.
+        virtual bool Push(const ID force_id, const ForceParams &params) = 0;
+
+        /// @return Number of parameter updates the worker applied to forces so far. May be invoked from any thread.
+        virtual uint64_t GetUploadCount() const noexcept = 0;
+
+    protected:
+        IForceStream() noexcept = default;
+        virtual ~IForceStream() = default;
+    };
     #endif // CROSSPUT_FEATURE_FORCE
 
 
+    // GLOBAL MEMORY API
+
+    /// @brief Number of objects allocated at once by each pool (see SetAllocator()).
+    inline constexpr size_t POOL_CHUNK_CAPACITY = 16;
+
+    /// @brief Source of memory provided by the user (see SetAllocator()).
+    struct Allocator
+    {
+        /// @brief Allocate at least size bytes aligned to alignment (a power of two). Returning nullptr makes crossput throw std::bad_alloc.
+        void *(*allocate)(size_t size, size_t alignment, void *p_user);
+
+        /// @brief Free memory returned by allocate, with the same size and alignment it was allocated with.
+        void (*deallocate)(void *p_memory, size_t size, size_t alignment, void *p_user);
+
+        /// @brief Passed to both functions.
+        void *p_user;
+    };
+
+    /// @brief Set the source of memory for devices, forces, callbacks, action maps, and the nodes of the maps which index them.
+    ///        Must be invoked while none of these objects exist (e.g. before the first invocation of DiscoverDevices()), otherwise an exception is thrown.
+    ///        The functions of the allocator are only invoked by threads performing management operations, and must remain valid until the program exits.
+    ///        Invoking this function during a callback will throw an exception.
+    /// @param allocator Allocator to use, functions which are nullptr restore the default of global operator new and delete.
+    /// @param use_pools If true, objects of equal size are allocated from pools of POOL_CHUNK_CAPACITY objects at a time,
+    ///        so devices of the same type are adjacent in memory and repeatedly creating and destroying objects does not fragment the heap.
+    ///        Once all objects of a pool have been destroyed, it keeps a single chunk for reuse until DestroyAllDevices() or SetAllocator() is invoked.
+    void SetAllocator(const Allocator &allocator, const bool use_pools = true);
+
+    /// @return Number of bytes currently allocated from the allocator (see SetAllocator()), including unused objects of pools.
+    size_t GetAllocatedBytes();
+
+
     // GLOBAL DEVICE MANAGEMENT
 
     /// @brief Search for input devices which are not accessible via an IDevice interface yet.
@@ -908,11 +1368,66 @@ namespace crossput
     /// @returns Number of new devices discovered.
     size_t DiscoverDevices();
 
-    /// @brief Effectively invokes the Update() method on all devices (including aggregates).
+    /// @brief Enable or disable the hotplug monitor, which tracks input devices appearing and disappearing via notifications from the operating system.
+    ///        While the monitor is enabled, disconnected devices only attempt to reconnect and DiscoverDevices() only searches for new devices
+    ///        after the set of available hardware has actually changed, making both operations nearly free otherwise.
+    ///        Note that devices which were destroyed are still re-discovered by the next invocation of DiscoverDevices().
+    ///        The monitor is disabled by default.
+    ///        Invoking this function during a callback will throw an exception.
+    /// @param enabled Whether the monitor should be running.
+    /// @return True if the monitor is in the requested state, false if it could not be started.
+    bool SetHotplugMonitorEnabled(const bool enabled);
+
+    /// @return True if the hotplug monitor is currently running, false otherwise.
+    bool IsHotplugMonitorEnabled();
+
+    /// @brief Set the number of threads used to probe hardware during DiscoverDevices() and when the hotplug monitor is enabled.
+    ///        Disconnected devices always probe sequentially while attempting to reconnect, as they do so during every update.
+    ///        Probing opens and queries every input device file, which stalls for tens of milliseconds on some hardware (e.g. Bluetooth gamepads).
+    ///        With more than one thread, all files are probed concurrently and the results are then processed on the calling thread in a deterministic order.
+    ///        Only affects platforms on which crossput probes hardware itself (currently Linux).
+    ///        Invoking this function during a callback will throw an exception.
+    /// @param count Number of threads. Values below 2 disable parallel probing, which is the default.
+    void SetProbeThreadCount(const uint32_t count);
+
+    /// @return Number of threads used to probe hardware.
+    uint32_t GetProbeThreadCount();
+
+    /// @brief Enable or disable buffering of native input as it arrives, instead of querying the input history of the platform during each device update.
+    ///        Buffered input is handled in the order it arrived, which avoids revisiting the history of devices with high polling rates (e.g. gaming mice).
+    ///        If the buffer of a device overflows between two updates, that device falls back to querying the history once, so no input is lost.
+    ///        Only affects platforms which provide such a history (currently Windows). Buffering is disabled by default.
+    ///        Invoking this function during a callback will throw an exception.
+    /// @param enabled Whether input should be buffered.
+    void SetReadingBufferEnabled(const bool enabled);
+
+    /// @return True if buffering of native input is enabled, false otherwise.
+    bool IsReadingBufferEnabled();
+
+    /// @brief Effectively invokes the Update() method on all devices (including aggregates) whose update policy (see IDevice::SetUpdatePolicy()) is due.
     ///        Depending on the aggregation structure, this may cause a single device to be updated multiple times.
     ///        Invoking this function during a callback will throw an exception.
     void UpdateAllDevices();
 
+    /// @brief Current time in the time base of all timestamps reported by crossput (e.g. InputEvent::timestamp, IKeyboard::GetKeyTimestamps()).
+    ///        The time base is monotonic, i.e. unaffected by adjustments of the system clock, and shared by all processes of the system.
+    ///        Its origin is unspecified (currently CLOCK_MONOTONIC on Linux and the GameInput timestamp on Windows).
+    /// @return Timestamp in microseconds.
+    uint64_t NowTimestamp();
+
+    /// @brief Block the calling thread until any device has pending input or might have changed its status, or until the timeout expires.
+    ///        This allows applications which are mostly idle to sleep instead of continuously updating devices.
+    ///        Devices are never updated by this function, so the reported devices should be updated afterwards.
+    ///        Aggregates are never reported, though their members are.
+    ///        Reconnection of disconnected devices can only be detected while the hotplug monitor is enabled (see SetHotplugMonitorEnabled()).
+    ///        Invoking this function during a callback will throw an exception.
+    /// @param ready_devices Pointers to all devices which are ready to be updated are appended to this vector.
+    /// @param timeout Maximum amount of time to wait in seconds. Zero returns immediately, negative values (and values above one billion, e.g. FLT_MAX) wait indefinitely.
+    /// @param p_hotplug_detected Optional, set to true if the hotplug monitor reported that devices appeared or disappeared, false otherwise.
+    ///        In that case the function returns before the timeout expires, even if no existing device is ready (DiscoverDevices() might find new devices).
+    /// @return Number of new entries in the vector. Zero indicates that the timeout expired, unless a hotplug was detected.
+    size_t WaitForInput(std::vector<IDevice *> &ready_devices, const float timeout, bool *const p_hotplug_detected = nullptr);
+
     /// @brief Remove all devices from the internal registry and delete their interface objects.
     ///        All device pointers and references are invalidated, including aggregates.
     ///        New interfaces for the underlying hardware may be created by DiscoverDevices().
@@ -943,7 +1458,48 @@ namespace crossput
     /// @return Number of new entries in the vector.
     size_t GetGamepads(std::vector<IGamepad *> &gamepads, const bool ignore_disconnected = false);
 
-    /// @brief Access a device by its runtime-unique ID.
+    /// @brief Read-only view of a contiguous range of device pointers owned by crossput.
+    ///        A span is invalidated whenever any device is created or destroyed (including aggregates).
+    template <typename T>
+    struct DeviceSpan
+    {
+        T *const *data;
+        size_t size;
+
+        constexpr T *const *begin() const noexcept { return data; }
+        constexpr T *const *end() const noexcept { return data + size; }
+        constexpr bool empty() const noexcept { return size == 0; }
+        constexpr T *operator[](const size_t index) const noexcept { return data[index]; }
+    };
+
+    /// @return Current value of the global change generation, which is advanced by every change of input or status of any device.
+    ///         Storing the value allows querying all changes that happen afterwards via GetChangedDevices() and the GetChanged*() methods of devices.
+    uint64_t GetGlobalGeneration();
+
+    /// @brief Copy pointers to all devices (including aggregates) whose input or status changed after the given generation to the given vector.
+    /// @param since_generation Exclusive lower bound, e.g. the value of GetGlobalGeneration() after the previous query. 0 yields every device that ever changed.
+    /// @return Number of new entries in the vector.
+    size_t GetChangedDevices(const uint64_t since_generation, std::vector<IDevice *> &devices);
+
+    /// @brief Access all available devices (including aggregates) without copying or casting any pointers.
+    ///        The order of devices is unspecified and may change whenever a device is destroyed.
+    /// @return Span which is valid until the next device is created or destroyed.
+    DeviceSpan<IDevice> GetDeviceSpan();
+
+    /// @brief Access all available mouse devices without copying or casting any pointers.
+    /// @return Span which is valid until the next device is created or destroyed.
+    DeviceSpan<IMouse> GetMouseSpan();
+
+    /// @brief Access all available keyboard devices without copying or casting any pointers.
+    /// @return Span which is valid until the next device is created or destroyed.
+    DeviceSpan<IKeyboard> GetKeyboardSpan();
+
+    /// @brief Access all available gamepad devices without copying or casting any pointers.
+    /// @return Span which is valid until the next device is created or destroyed.
+    DeviceSpan<IGamepad> GetGamepadSpan();
+
+    /// @brief Access a device by its runtime-unique ID in constant time.
+    ///        IDs of destroyed devices are never resolved, even if the internal storage of the device has been reused.
     /// @returns Pointer to device (or aggregate) if it exists, nullptr otherwise.
     IDevice *GetDevice(const ID id);
 
@@ -966,6 +1522,22 @@ namespace crossput
     ///        Invoking this function during a callback will throw an exception.
     void UnregisterAllCallbacks();
 
+    /// @brief Set when callbacks for changes of input are invoked.
+    ///        Changes which are already queued remain queued until DispatchPendingCallbacks() is invoked.
+    ///        Invoking this function during a callback will throw an exception.
+    /// @param delivery Delivery mode, the default is CallbackDelivery::IMMEDIATE.
+    void SetCallbackDelivery(const CallbackDelivery delivery);
+
+    /// @return Current delivery mode of callbacks for changes of input.
+    CallbackDelivery GetCallbackDelivery();
+
+    /// @brief Invoke callbacks for all changes of input queued since the last invocation of this function, in the order the changes occurred.
+    ///        Only callbacks which are registered at the time of dispatch are invoked. Changes of destroyed devices are discarded.
+    ///        Afterwards, coroutines awaiting the queued changes are resumed (see InputAwaitable).
+    ///        Invoking this function during a callback will throw an exception.
+    /// @return Number of queued changes which have been dispatched, plus the number of resumed coroutines.
+    size_t DispatchPendingCallbacks();
+
     /// @brief Whenever any device status changes, the callback is invoked.
     ///        Invoking this function during a callback will throw an exception.
     /// @param callback void (const IDevice *device, const DeviceStatusChange status)
@@ -1050,6 +1622,98 @@ namespace crossput
     #endif // CROSSPUT_FEATURE_CALLBACK
 
 
+    // GLOBAL COROUTINE API
+
+    #ifdef CROSSPUT_COROUTINES
+    /// @brief Input which resumed a coroutine suspended on an InputAwaitable.
+    struct InputWakeup
+    {
+        /// @brief Device whose input resumed the coroutine, nullptr if it was destroyed before deferred resumption (see CallbackDelivery::DEFERRED).
+        const IDevice *p_device;
+
+        /// @brief Mouse button index, Key, Button, or DeviceStatusChange which resumed the coroutine.
+        uint32_t code;
+
+        /// @brief Normalized state value of the button or key, 0.0 for status changes.
+        float value;
+    };
+
+
+    namespace impl
+    {
+        inline constexpr uint32_t _ANY_CODE = 0xFFFFFFFFU;
+
+        // node of an intrusive list of suspended coroutines, which lives inside the awaitable (and thus the coroutine frame)
+        struct _InputWaiter
+        {
+            _InputWaiter *p_prev;
+            _InputWaiter *p_next;
+            void *p_list; // list the waiter is linked into, nullptr if none
+            std::coroutine_handle<> handle;
+            ID device_id; // 0 for any device
+            unsigned short ctypeid;
+            uint32_t code; // _ANY_CODE for any
+            InputWakeup wakeup;
+        };
+
+        void _SuspendWaiter(_InputWaiter &waiter);
+        void _CancelWaiter(_InputWaiter &waiter) noexcept;
+    }
+
+
+    /// @brief Suspends a coroutine until a certain input occurs, returned by NextMouseButtonPress(), NextKeyPress(), NextButtonPress(), and NextStatusChange().
+    ///        While suspended, the coroutine is linked into a list per kind of input without any allocation, it costs nothing as long as no input of that kind occurs.
+    ///        The coroutine is resumed by the update of the device (or by DispatchPendingCallbacks() for CallbackDelivery::DEFERRED),
+    ///        with the same restrictions on the management API as callbacks until it suspends again.
+    ///        If the coroutine is destroyed while suspended, it is removed from the list. Must be awaited at most once.
+    class InputAwaitable
+    {
+    private:
+        impl::_InputWaiter waiter_;
+
+    public:
+        InputAwaitable(const ID device_id, const unsigned short ctypeid, const uint32_t code) noexcept :
+            waiter_{nullptr, nullptr, nullptr, std::coroutine_handle<>(), device_id, ctypeid, code, InputWakeup{nullptr, 0, 0.0F}} {}
+
+        InputAwaitable(const InputAwaitable &) = delete;
+        InputAwaitable &operator=(const InputAwaitable &) = delete;
+        ~InputAwaitable() { impl::_CancelWaiter(waiter_); }
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(const std::coroutine_handle<> handle)
+        {
+            waiter_.handle = handle;
+            impl::_SuspendWaiter(waiter_);
+        }
+
+        InputWakeup await_resume() const noexcept { return waiter_.wakeup; }
+    };
+
+
+    /// @brief Await the next change of a mouse button which reports it as "pressed" (including changes of value while held).
+    /// @param p_mouse Mouse to wait for, nullptr for any mouse.
+    /// @param index Mouse button index to wait for, omit for any button.
+    InputAwaitable NextMouseButtonPress(const IMouse *const p_mouse, const uint32_t index = impl::_ANY_CODE);
+
+    /// @brief Await the next change of a key which reports it as "pressed" (including changes of value while held).
+    /// @param p_keyboard Keyboard to wait for, nullptr for any keyboard.
+    /// @param key Key to wait for, INVALID_KEY for any key.
+    InputAwaitable NextKeyPress(const IKeyboard *const p_keyboard, const Key key = INVALID_KEY);
+
+    /// @brief Await the next change of a gamepad button or trigger which reports it as "pressed" (including changes of value while held).
+    /// @param p_gamepad Gamepad to wait for, nullptr for any gamepad.
+    /// @param button Button to wait for, INVALID_BUTTON for any button.
+    InputAwaitable NextButtonPress(const IGamepad *const p_gamepad, const Button button = INVALID_BUTTON);
+
+    /// @brief Await the next change of status of a device, which always resumes immediately (regardless of the CallbackDelivery).
+    ///        Coroutines waiting for input of a device which is destroyed are not resumed, waiting for DeviceStatusChange::DESTROYED allows to handle this.
+    /// @param status Status change to wait for.
+    /// @param p_device Device to wait for, nullptr for any device.
+    InputAwaitable NextStatusChange(const DeviceStatusChange status, const IDevice *const p_device = nullptr);
+    #endif // CROSSPUT_COROUTINES
+
+
     // GLOBAL AGGREGATE API
 
     #ifdef CROSSPUT_FEATURE_AGGREGATE
@@ -1066,6 +1730,421 @@ namespace crossput
     ///    [OR] nullptr if no members are specified or any kind of failure occurrs during aggregation.
     IDevice *Aggregate(const std::vector<ID> &ids, const DeviceType type_hint = DeviceType::UNKNOWN);
     #endif // CROSSPUT_FEATURE_AGGREGATE
+
+
+    // GLOBAL THREADING API
+
+    /// @brief Copy of the input data of a single device at a specific point in time, published by the input thread.
+    ///        Fields which are not relevant to the type of device are zero.
+    struct DeviceSnapshot
+    {
+        /// @brief Maximum number of buttons/keys stored in a snapshot.
+        static constexpr uint32_t MAX_BUTTONS = static_cast<uint32_t>(NUM_KEY_CODES);
+
+        /// @brief Maximum number of thumbsticks stored in a snapshot.
+        static constexpr uint32_t MAX_THUMBSTICKS = 8;
+
+        /// @brief Number of times a snapshot of the device has been published. Snapshots with an identical sequence are identical.
+        uint64_t sequence;
+
+        /// @brief ID of the device.
+        ID device_id;
+
+        /// @brief Type of the device.
+        DeviceType type;
+
+        /// @brief Result of IDevice::IsConnected().
+        bool is_connected;
+
+        /// @brief Mouse only: Results of IMouse::GetPosition(), IMouse::GetDelta(), IMouse::GetScroll(), and IMouse::GetScrollDelta() (X and Y).
+        int64_t position[2];
+        int64_t delta[2];
+        int64_t scroll[2];
+        int64_t scroll_delta[2];
+
+        /// @brief Number of valid entries in the button arrays (mouse buttons, keys, or gamepad buttons). Indices correspond to the enum values of Key or Button.
+        uint32_t button_count;
+
+        /// @brief Keyboard only: Result of IKeyboard::GetNumKeysPressed().
+        uint32_t num_keys_pressed;
+
+        /// @brief Gamepad only: Number of valid entries in the thumbstick array.
+        uint32_t thumbstick_count;
+
+        /// @brief Analog value of each button/key.
+        float button_values[MAX_BUTTONS];
+
+        /// @brief Time in seconds since the last state change of each button/key, relative to the moment the snapshot was published.
+        float button_times[MAX_BUTTONS];
+
+        /// @brief Digital state of each button/key.
+        bool button_states[MAX_BUTTONS];
+
+        /// @brief Gamepad only: Position (X and Y) of each thumbstick.
+        float thumbsticks[MAX_THUMBSTICKS][2];
+    };
+
+    /// @brief Start a thread owned by crossput which continuously invokes UpdateAllDevices() and publishes a snapshot of every device afterwards.
+    ///        This decouples the rate at which input is processed from the rate at which the application reads it.
+    ///        Only devices which exist when the thread is started receive snapshots.
+    ///        While the thread is running, devices must only be read via AcquireSnapshot(), and no other crossput function may be invoked
+    ///        besides StopInputThread() and IsInputThreadRunning(). Callbacks are invoked on the input thread.
+    ///        Invoking this function during a callback will throw an exception.
+    /// @param interval Minimum amount of time between two updates in seconds.
+    /// @return True if the thread was started, false if it is already running.
+    bool StartInputThread(const float interval);
+
+    /// @brief Stop the input thread and wait for it to finish its current update.
+    ///        Afterwards, all crossput functions can be used normally again.
+    ///        If the thread was terminated by an exception, the exception is rethrown by this function.
+    ///        Does nothing if the thread is not running.
+    ///        Invoking this function during a callback will throw an exception.
+    void StopInputThread();
+
+    /// @return True if the input thread is running, false otherwise.
+    ///         Turns false as soon as the thread was terminated by an exception, which StopInputThread() rethrows.
+    bool IsInputThreadRunning();
+
+    /// @brief Copy the most recently published snapshot of a device.
+    ///        This function may be invoked from any number of threads at any time while the input thread is running.
+    ///        It never blocks the input thread and always provides a consistent snapshot (no partially published data).
+    /// @param device_id ID of the device.
+    /// @param snapshot Destination of the copy. Unmodified if this function returns false.
+    /// @return True if a snapshot of the device exists, false otherwise.
+    bool AcquireSnapshot(const ID device_id, DeviceSnapshot &snapshot);
+
+
+    // GLOBAL CAPTURE API
+
+    /// @brief Determines how fast replay devices consume their captured input.
+    ///        Values of this enum are sequential unsigned integers starting at 0.
+    enum class ReplayMode : uint8_t
+    {
+        /// @brief Input is replayed with the original timing, relative to the first update of the replay device.
+        REAL_TIME = 0,
+
+        /// @brief Every update consumes up to IDevice::GetReadBatchSize() captured records regardless of their timing.
+        UNTHROTTLED
+    };
+
+    /// @brief Start recording every change of input (see InputEvent) and every status change of all devices to a compact binary file.
+    ///        Recording happens during device updates, independent of callbacks and event history capacities.
+    ///        An existing file at the path is overwritten.
+    ///        Invoking this function during a callback will throw an exception.
+    /// @param path Path of the capture file.
+    /// @return True if the capture was started, false if a capture is already running.
+    bool StartCapture(const std::string &path);
+
+    /// @brief Stop recording and close the capture file. Does nothing if no capture is running.
+    ///        An exception is thrown if the capture could not be written completely.
+    ///        Invoking this function during a callback will throw an exception.
+    void StopCapture();
+
+    /// @return True if a capture is currently running, false otherwise.
+    bool IsCapturing();
+
+    /// @brief Create a replay device for every device recorded in a capture file.
+    ///        Replay devices are regular mice, keyboards, or gamepads which read the file via memory mapping instead of communicating with hardware,
+    ///        and are destroyed like any other device. They connect on their first update and disconnect once all captured input has been replayed.
+    ///        Replay devices never have any force capabilities.
+    ///        Invoking this function during a callback will throw an exception.
+    /// @param path Path of the capture file.
+    /// @param mode Determines the playback speed of all created devices.
+    /// @param devices Pointers to all created devices are appended to this vector.
+    /// @return Number of new entries in the vector.
+    size_t CreateReplayDevices(const std::string &path, const ReplayMode mode, std::vector<IDevice *> &devices);
+
+
+    // GLOBAL SHARED MEMORY API
+
+    /// @brief Maximum number of devices published by an input server.
+    inline constexpr size_t MAX_SERVER_DEVICES = 32;
+
+    /// @brief Determines which other processes may read the segment of an input server.
+    ///        The segment holds the live state of all published devices and an event ring of every change of input,
+    ///        i.e. every process which can read it can log all keystrokes of published keyboards.
+    ///        Values of this enum are sequential unsigned integers starting at 0.
+    enum class ServerAccess : uint8_t
+    {
+        /// @brief Only processes of the same user can read the segment (mode 0600 on Linux).
+        ///        On Windows, the segment is created in the session namespace with the default security descriptor of the server process.
+        OWNER = 0,
+
+        /// @brief Processes of the same user and of members of the owning group of the segment can read it (mode 0640 on Linux).
+        ///        The owning group is the effective group of the server process. Behaves like OWNER on Windows.
+        GROUP
+    };
+
+    /// @brief Start publishing the input of the devices of this process into a named shared-memory segment,
+    ///        which lets other processes read them via ConnectInputServer() instead of opening the same hardware themselves.
+    ///        The state of every device (see DeviceSnapshot) is published at the end of each invocation of UpdateAllDevices(), including the ones of the input thread.
+    ///        Every change of input is additionally appended to an event ring, from which clients invoke their callbacks and fill their event histories.
+    ///        Devices are assigned to the segment on their first update or change of input while the server is running, up to MAX_SERVER_DEVICES.
+    ///        Aggregates and devices mirrored from another server are never published.
+    ///        A segment of the same name which is still used by a running server causes an exception.
+    ///        On Linux, a stale segment of the same name (i.e. of a server whose process no longer exists) is replaced.
+    ///        Every process which can read the segment sees all input of the published devices, including every keystroke (see ServerAccess).
+    ///        By default, only processes of the same user can read it.
+    ///        Invoking this function during a callback will throw an exception.
+    /// @param name Name of the segment, which must not be empty or contain slashes or backslashes.
+    /// @param access Determines which other processes may read the segment.
+    /// @return True if the server was started, false if this process already runs a server.
+    bool StartInputServer(const std::string &name, const ServerAccess access = ServerAccess::OWNER);
+
+    /// @brief Stop publishing and remove the segment. Client devices of the server disconnect on their next update.
+    ///        Does nothing if no server is running.
+    ///        Invoking this function during a callback will throw an exception.
+    void StopInputServer();
+
+    /// @return True if this process runs an input server, false otherwise.
+    bool IsInputServerRunning();
+
+    /// @brief Create a client device for every device published by an input server of another (or the same) process.
+    ///        Client devices are regular mice, keyboards, or gamepads backed by the read-only segment, and are destroyed like any other device.
+    ///        IDevice::Update() copies the most recently published state out of the segment and replays the events published since the previous update,
+    ///        without issuing any system calls. Events which have been overwritten in the meantime are skipped, the state is always up-to-date.
+    ///        Client devices never have any force capabilities, their thresholds are determined by the server (setters are ignored, getters return 0).
+    ///        They are disconnected while the server is not running, including after its process terminated without stopping it (checked at most every 100 milliseconds).
+    ///        Invoking the function again for the same segment only creates devices which have been published since.
+    ///        If the server is not running anymore but was restarted in the meantime, devices are created for the new segment instead,
+    ///        while the devices of the previous one stay disconnected.
+    ///        Invoking this function during a callback will throw an exception.
+    /// @param name Name of the segment (see StartInputServer()).
+    /// @param devices Pointers to all created devices are appended to this vector.
+    /// @return Number of new entries in the vector.
+    size_t ConnectInputServer(const std::string &name, std::vector<IDevice *> &devices);
+
+
+    // GLOBAL REMOTE API
+
+    /// @brief Append a compact packet describing the state of a device to a buffer, e.g. for streaming input to another machine.
+    ///        The packet only includes buttons/keys which changed after since_generation, with digital states packed alongside analog values quantized to 15 bits.
+    ///        Mouse position/scroll data and all thumbsticks (quantized to 16 bits) are always included. A keyboard packet with a single changed key is usually below 10 bytes long.
+    ///        Passing 0 as since_generation includes every button/key that ever changed, which fully resynchronizes a receiver (e.g. after lost packets or status changes).
+    ///        Packets are applied to devices created via CreateRemoteDevice() using ApplyDeviceState(). Aggregates can be serialized like any other device.
+    /// @param device_id ID of the device.
+    /// @param since_generation Usually the generation of the most recent packet acknowledged by the receiver.
+    /// @param packet The packet is appended to this vector, so multiple packets can share a single buffer.
+    /// @param generation Set to the current global generation (see GetGlobalGeneration()), which serves as since_generation of later packets once this one has been received.
+    /// @return True if a packet was appended, false if the device does not exist or is not a mouse, keyboard, or gamepad.
+    bool SerializeDeviceState(const ID device_id, const uint64_t since_generation, std::vector<uint8_t> &packet, uint64_t &generation);
+
+    /// @brief Create a mouse, keyboard, or gamepad whose input is received from another process or machine via ApplyDeviceState().
+    ///        Remote devices are destroyed like any other device. They connect once a packet of a connected device has been applied.
+    ///        Remote devices never have any force capabilities, their thresholds are determined by the sender (setters are ignored, getters return 0).
+    ///        Invoking this function during a callback will throw an exception.
+    /// @param type Type of the device, which must match the type of the serialized devices.
+    /// @param display_name Result of IDevice::GetDisplayName().
+    /// @return Pointer to the new device, nullptr if the type is not a mouse, keyboard, or gamepad.
+    IDevice *CreateRemoteDevice(const DeviceType type, const std::string &display_name);
+
+    /// @brief Apply a packet created by SerializeDeviceState() to a remote device.
+    ///        Timestamps are converted to the local clock, and all changes are propagated to callbacks and the event history as if they happened during an update.
+    ///        Malformed packets are never applied partially.
+    ///        Invoking this function during a callback will throw an exception.
+    /// @param device_id ID of the remote device.
+    /// @param data Start of the packet.
+    /// @param size Number of available bytes, which may include subsequent packets.
+    /// @return Number of bytes consumed by the packet, 0 if nothing was applied because the device is not a remote device,
+    ///         the packet is malformed, or it describes a different type of device.
+    size_t ApplyDeviceState(const ID device_id, const uint8_t *const data, const size_t size);
+
+
+    // GLOBAL ACTION API
+
+    /// @brief Kind of input an action binding reads.
+    ///        Values of this enum are sequential unsigned integers starting at 0.
+    enum class ActionSource : uint8_t
+    {
+        /// @brief Key of a keyboard. The code is a value of Key.
+        KEY = 0,
+
+        /// @brief Button of a mouse. The code is the index of the button, which must be smaller than MAX_TRACKED_MOUSE_BUTTONS.
+        MOUSE_BUTTON,
+
+        /// @brief Button of a gamepad. The code is a value of Button.
+        GAMEPAD_BUTTON,
+
+        /// @brief X axis of a gamepad thumbstick. The code is the index of the thumbstick, which must be smaller than DeviceSnapshot::MAX_THUMBSTICKS.
+        THUMBSTICK_X,
+
+        /// @brief Y axis of a gamepad thumbstick. The code is the index of the thumbstick, which must be smaller than DeviceSnapshot::MAX_THUMBSTICKS.
+        THUMBSTICK_Y
+    };
+
+    class IActionMap;
+
+    #ifdef CROSSPUT_FEATURE_CALLBACK
+    /// @brief Invoked with the index, value, and new state of an action whenever its state changes.
+    using ActionCallback = std::function<void (const IActionMap *const, const uint32_t, const float, const bool)>;
+    #endif // CROSSPUT_FEATURE_CALLBACK
+
+    /// @brief Set of named actions (e.g. "jump", "steer") bound to inputs of any number of devices or aggregates.
+    ///        Bindings are compiled into a flat table grouped by device, so every evaluation reads each bound device once via its bulk getters
+    ///        and resolves all actions in a single linear pass. All action maps are evaluated at the end of every invocation of UpdateAllDevices().
+    ///        The value of an action is the scaled input value with the largest magnitude among its bindings (0 for missing or disconnected devices),
+    ///        and the action is active while the magnitude of its value reaches its threshold.
+    class IActionMap
+    {
+    public:
+        /// @brief Add a new action without any bindings.
+        ///        Invoking this method during a callback will throw an exception.
+        /// @param name Name of the action, which does not have to be unique.
+        /// @param threshold Magnitude of the value at which the action becomes active, clamped to [0.0, 1.0].
+        /// @return Index of the new action, which identifies it in all other methods.
+        virtual uint32_t AddAction(const std::string &name, const float threshold) = 0;
+
+        /// @return Number of actions, all indices below are valid.
+        virtual uint32_t GetActionCount() const = 0;
+
+        /// @param name Name of the action.
+        /// @param action Set to the index of the first action with the name, unmodified if no such action exists.
+        /// @return True if an action with the name exists, false otherwise.
+        virtual bool FindAction(const std::string &name, uint32_t &action) const = 0;
+
+        /// @return Name of the action, empty if the index is invalid.
+        virtual std::string GetActionName(const uint32_t action) const = 0;
+
+        /// @brief Bind an input to an action. Actions can have any number of bindings.
+        ///        The binding takes effect during the next evaluation, bindings to devices which do not exist (yet) are allowed.
+        ///        Invoking this method during a callback will throw an exception.
+        /// @param action Index of the action.
+        /// @param device_id ID of the device or aggregate providing the input.
+        /// @param source Kind of input.
+        /// @param code Key, button, or thumbstick index (see ActionSource).
+        /// @param scale Factor applied to the input value, e.g. -1.0 to invert an axis or to let a key steer to the left.
+        /// @return True if the binding was added, false if the action or code is invalid.
+        virtual bool Bind(const uint32_t action, const ID device_id, const ActionSource source, const uint32_t code, const float scale = 1.0F) = 0;
+
+        /// @brief Remove all bindings of an action.
+        ///        Invoking this method during a callback will throw an exception.
+        /// @param action Index of the action.
+        virtual void ClearBindings(const uint32_t action) = 0;
+
+        /// @brief Evaluate all actions based on the current input of the bound devices, which detects changes of their states.
+        ///        This is only necessary if devices are updated individually instead of via UpdateAllDevices().
+        ///        Invoking this method during a callback will throw an exception.
+        virtual void Evaluate() = 0;
+
+        /// @return Value of the action as of the most recent evaluation, 0 if the index is invalid.
+        virtual float GetActionValue(const uint32_t action) const = 0;
+
+        /// @return True if the action was active during the most recent evaluation, false otherwise or if the index is invalid.
+        virtual bool GetActionState(const uint32_t action) const = 0;
+
+        /// @return True if the action became active during the most recent evaluation, false otherwise or if the index is invalid.
+        virtual bool WasActionPressed(const uint32_t action) const = 0;
+
+        /// @return True if the action became inactive during the most recent evaluation, false otherwise or if the index is invalid.
+        virtual bool WasActionReleased(const uint32_t action) const = 0;
+
+        #ifdef CROSSPUT_FEATURE_CALLBACK
+        /// @brief Set a callback which is invoked during evaluation whenever the state of the action changes, replacing the previous one.
+        ///        An empty function removes the callback.
+        ///        Invoking this method during a callback will throw an exception.
+        /// @param action Index of the action.
+        /// @param callback Function to invoke.
+        /// @return True if the callback was set, false if the index is invalid.
+        virtual bool SetActionCallback(const uint32_t action, ActionCallback &&callback) = 0;
+        #endif // CROSSPUT_FEATURE_CALLBACK
+
+    protected:
+        virtual ~IActionMap() = default;
+    };
+
+    /// @brief Create a new action map without any actions.
+    ///        Invoking this function during a callback will throw an exception.
+    /// @return Pointer to the new action map, valid until DestroyActionMap().
+    IActionMap *CreateActionMap();
+
+    /// @brief Destroy an action map created via CreateActionMap(). Does nothing if the pointer is nullptr.
+    ///        Invoking this function during a callback will throw an exception.
+    /// @param p_map Pointer to the action map.
+    void DestroyActionMap(IActionMap *const p_map);
+
+
+    // GLOBAL STATS API
+
+    #ifdef CROSSPUT_FEATURE_STATS
+    /// @brief Number of buckets in the update time histogram of DeviceStats.
+    inline constexpr size_t NUM_UPDATE_TIME_BUCKETS = 32;
+
+    /// @brief Number of buckets in the latency histograms of DeviceStats.
+    inline constexpr size_t NUM_LATENCY_BUCKETS = 160;
+
+    /// @brief Counters collected during device updates. All values only ever increase until ResetStats() is invoked.
+    struct DeviceStats
+    {
+        /// @brief Number of individual events/readings received from the underlying hardware/driver.
+        uint64_t events_read;
+
+        /// @brief Number of groups of events that were processed together (SYN_REPORT on Linux, readings on Windows).
+        uint64_t event_groups;
+
+        /// @brief Number of system/driver calls issued while updating.
+        uint64_t syscalls;
+
+        /// @brief Number of times the driver dropped events because they were not read fast enough (SYN_DROPPED on Linux).
+        ///        A rising count indicates that devices are updated too rarely.
+        uint64_t overruns;
+
+        /// @brief Number of attempts to reconnect to the underlying hardware/driver while disconnected.
+        uint64_t reconnect_attempts;
+
+        /// @brief Number of callbacks invoked for the device (see the event-centric API), including global callbacks.
+        uint64_t callbacks_invoked;
+
+        /// @brief Number of invocations of IDevice::Update().
+        uint64_t updates;
+
+        /// @brief Total time spent in IDevice::Update() in nanoseconds.
+        ///        The update of an aggregate includes the updates of its members.
+        uint64_t update_time_total;
+
+        /// @brief Longest time spent in a single invocation of IDevice::Update() in nanoseconds.
+        uint64_t update_time_max;
+
+        /// @brief Histogram of update times. Bucket 0 counts updates shorter than 1 nanosecond,
+        ///        bucket i counts updates in the range [2^(i-1), 2^i) nanoseconds, and the last bucket also counts all longer updates.
+        uint64_t update_time_histogram[NUM_UPDATE_TIME_BUCKETS];
+
+        /// @brief Longest delivery latency (see latency_histogram) in microseconds.
+        uint64_t latency_max;
+
+        /// @brief Histogram of delivery latencies, i.e. the time from the timestamp of a change of input (provided by the kernel or GameInput)
+        ///        until the update which made it visible via polling and invoked immediately delivered callbacks.
+        ///        Bucket i counts latencies of i microseconds for i < 8. Beyond, every range [2^k, 2^(k+1)) microseconds is divided into 8 buckets of equal width,
+        ///        and the last bucket also counts all longer latencies. Use GetLatencyPercentile() for running percentiles.
+        uint64_t latency_histogram[NUM_LATENCY_BUCKETS];
+
+        /// @brief Histogram of callback latencies, i.e. the time from the timestamp of a change of input until a callback was invoked for it,
+        ///        immediately or via DispatchPendingCallbacks(). Counted once per change, not per callback. Same buckets as latency_histogram.
+        uint64_t callback_latency_histogram[NUM_LATENCY_BUCKETS];
+    };
+
+    /// @brief Get the counters collected for a device.
+    /// @param id ID of the device.
+    /// @param stats Destination of the counters, unmodified if the device does not exist.
+    /// @return True if the device exists, false otherwise.
+    bool GetDeviceStats(const ID id, DeviceStats &stats);
+
+    /// @brief Get the sum of the counters of all devices, including devices that have already been destroyed,
+    ///        and of calls which are not attributable to a single device (e.g. waiting for input).
+    ///        The maximum update time is the maximum of all devices.
+    /// @param stats Destination of the counters.
+    void GetGlobalStats(DeviceStats &stats);
+
+    /// @brief Reset the counters of all devices and the global counters to 0.
+    ///        Invoking this function during a callback will throw an exception.
+    void ResetStats();
+
+    /// @brief Estimate a percentile from one of the latency histograms of DeviceStats, e.g. the 99th percentile of delivery latencies of a device:
+    ///        GetLatencyPercentile(stats.latency_histogram, 0.99F). The estimate overshoots by at most one eighth of the latency.
+    /// @param histogram DeviceStats::latency_histogram or DeviceStats::callback_latency_histogram.
+    /// @param percentile Fraction of latencies in range [0.0;1.0] which are less than or equal to the result.
+    /// @return Upper bound of the bucket containing the percentile in microseconds, 0 if the histogram is empty.
+    uint64_t GetLatencyPercentile(const uint64_t (&histogram)[NUM_LATENCY_BUCKETS], const float percentile);
+    #endif // CROSSPUT_FEATURE_STATS
 }
 
 
@@ -14,13 +14,21 @@
 #include "crossput.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <bit>
 #include <bitset>
 #include <cassert>
 #include <chrono>
 #include <climits>
+#include <cmath>
+#include <cstring>
 #include <format>
+#include <limits>
+#include <mutex>
+#include <new>
 #include <stdexcept>
+#include <thread>
+#include <tuple>
 #include <typeindex>
 #include <unordered_map>
 #include <utility>
@@ -54,8 +62,220 @@ namespace crossput
     extern ID::value_type glob_id_counter;
     inline ID ReserveID() { return { glob_id_counter++ }; }
 
-    // all device interfaces, including aggregates
-    extern std::unordered_map<ID, BaseInterface *> glob_interfaces;
+    // global change generation counter, advanced by every change of input or status of any device
+    extern uint64_t glob_generation;
+
+    // number of invocations of UpdateAllDevices(), drives the update policies of devices
+    extern uint64_t glob_update_tick;
+
+
+    // MEMORY
+
+    // source of the memory of devices, forces, callback wrappers, action maps, and the nodes of the maps indexing them
+    // all allocations are forwarded to an Allocator of the user (global new/delete by default) and accounted,
+    // single objects of equal size and alignment are optionally taken from pools which allocate POOL_CHUNK_CAPACITY objects at a time
+    class MemoryResource
+    {
+    private:
+        static constexpr size_t MAX_POOLS = 32; // objects of further sizes are allocated individually
+
+        // free objects and chunks are linked through their first bytes
+        struct Pool
+        {
+            size_t size;
+            size_t alignment;
+            size_t stride;
+            size_t chunk_header_size;
+            void *p_free;
+            void *p_chunks;
+            size_t live_count;
+        };
+
+        const Allocator allocator_;
+        const bool use_pools_;
+        Pool pools_[MAX_POOLS] = {};
+        size_t pool_count_ = 0;
+        size_t allocated_bytes_ = 0;
+        size_t live_count_ = 0; // allocations not returned to the allocator yet (including chunks)
+
+    public:
+        constexpr MemoryResource(const Allocator &allocator, const bool use_pools) noexcept : allocator_(allocator), use_pools_(use_pools) {}
+
+        void *Allocate(const size_t size, const size_t alignment);
+        void Deallocate(void *const p, const size_t size, const size_t alignment) noexcept;
+
+        // same as Allocate()/Deallocate(), but taken from a pool if enabled
+        void *AllocateObject(const size_t size, const size_t alignment);
+        void DeallocateObject(void *const p, const size_t size, const size_t alignment) noexcept;
+
+        // returns the chunks of pools without live objects to the allocator
+        void ReleaseIdlePools() noexcept;
+
+        constexpr size_t GetAllocatedBytes() const noexcept { return allocated_bytes_; }
+        constexpr size_t GetLiveCount() const noexcept { return live_count_; }
+
+    private:
+        Pool *FindPool(const size_t size, const size_t alignment) noexcept;
+        void LinkChunk(Pool &pool, char *const p_chunk) noexcept;
+        void TrimPool(Pool &pool) noexcept;
+        void ReleasePool(Pool &pool) noexcept;
+    };
+
+    extern MemoryResource *glob_p_memory;
+
+
+    // allocates objects of derived classes from glob_p_memory
+    // (which is only replaced while no such objects exist)
+    class MemoryManaged
+    {
+    public:
+        static inline void *operator new(const size_t size)
+        {
+            return glob_p_memory->AllocateObject(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+        }
+
+        static inline void *operator new(const size_t size, const std::align_val_t alignment)
+        {
+            return glob_p_memory->AllocateObject(size, static_cast<size_t>(alignment));
+        }
+
+        static inline void operator delete(void *const p, const size_t size) noexcept
+        {
+            glob_p_memory->DeallocateObject(p, size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+        }
+
+        static inline void operator delete(void *const p, const size_t size, const std::align_val_t alignment) noexcept
+        {
+            glob_p_memory->DeallocateObject(p, size, static_cast<size_t>(alignment));
+        }
+    };
+
+
+    // allocator of containers, bound to the memory resource which is current during construction of the container
+    template <typename T>
+    class MemoryAllocator
+    {
+    public:
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+        MemoryResource *p_resource;
+
+        MemoryAllocator() noexcept : p_resource(glob_p_memory) {}
+
+        template <typename U>
+        MemoryAllocator(const MemoryAllocator<U> &other) noexcept : p_resource(other.p_resource) {}
+
+        // single elements (e.g. nodes of maps) are pooled, arrays (e.g. buckets) vary in size
+        inline T *allocate(const size_t n)
+        {
+            return static_cast<T *>(n == 1
+                ? p_resource->AllocateObject(sizeof(T), alignof(T))
+                : p_resource->Allocate(n * sizeof(T), alignof(T)));
+        }
+
+        inline void deallocate(T *const p, const size_t n) noexcept
+        {
+            if (n == 1) { p_resource->DeallocateObject(p, sizeof(T), alignof(T)); }
+            else { p_resource->Deallocate(p, n * sizeof(T), alignof(T)); }
+        }
+
+        template <typename U>
+        constexpr bool operator==(const MemoryAllocator<U> &other) const noexcept { return p_resource == other.p_resource; }
+    };
+
+    template <typename TKey, typename TValue>
+    using ManagedMap = std::unordered_map<TKey, TValue, std::hash<TKey>, std::equal_to<TKey>, MemoryAllocator<std::pair<const TKey, TValue>>>;
+
+    template <typename TKey, typename TValue>
+    using ManagedMultimap = std::unordered_multimap<TKey, TValue, std::hash<TKey>, std::equal_to<TKey>, MemoryAllocator<std::pair<const TKey, TValue>>>;
+
+
+    // dense registry of all device interfaces, including aggregates
+    // device IDs encode a slot index and the generation of that slot, which makes lookups O(1) without hashing
+    // and lets stale IDs of destroyed devices be detected even when their slot is reused
+    class DeviceRegistry
+    {
+    private:
+        static constexpr ID::value_type DEVICE_ID_BIT = static_cast<ID::value_type>(1) << 63; // never set in IDs of other objects
+        static constexpr unsigned int GENERATION_SHIFT = 32;
+        static constexpr ID::value_type SLOT_MASK = 0xFFFFFFFFULL;
+        static constexpr uint32_t GENERATION_MASK = 0x7FFFFFFFU;
+        static constexpr uint32_t UNREGISTERED = 0xFFFFFFFFU;
+
+        struct Slot
+        {
+            BaseInterface *p_interface;
+            uint32_t generation;
+            uint32_t index; // in interfaces_, UNREGISTERED if not registered (yet)
+            uint32_t typed_index; // in array of corresponding type
+            DeviceType type;
+        };
+
+        std::vector<Slot> slots_;
+        std::vector<uint32_t> free_slots_;
+
+        // dense arrays, each accompanied by the slot index of every element
+        std::vector<BaseInterface *> interfaces_;
+        std::vector<IDevice *> devices_;
+        std::vector<uint32_t> interface_slots_;
+        std::vector<IMouse *> mice_;
+        std::vector<uint32_t> mouse_slots_;
+        std::vector<IKeyboard *> keyboards_;
+        std::vector<uint32_t> keyboard_slots_;
+        std::vector<IGamepad *> gamepads_;
+        std::vector<uint32_t> gamepad_slots_;
+
+    public:
+        // assign an ID to an interface under construction
+        ID Reserve(BaseInterface *const p_interface);
+
+        // add a fully constructed interface to the dense arrays
+        void Register(BaseInterface *const p_interface);
+
+        // remove interface from the dense arrays (if registered) and invalidate its ID
+        void Release(const ID id);
+
+        inline BaseInterface *Find(const ID id) const noexcept
+        {
+            if ((id.value & DEVICE_ID_BIT) == 0) { return nullptr; }
+
+            const size_t slot = static_cast<size_t>(id.value & SLOT_MASK);
+            if (slot >= slots_.size()) { return nullptr; }
+
+            const Slot &s = slots_[slot];
+            return (s.index != UNREGISTERED && s.generation == static_cast<uint32_t>(id.value >> GENERATION_SHIFT & GENERATION_MASK))
+                ? s.p_interface
+                : nullptr;
+        }
+
+        constexpr size_t Size() const noexcept { return interfaces_.size(); }
+        constexpr const std::vector<BaseInterface *> &Interfaces() const noexcept { return interfaces_; }
+        constexpr const std::vector<IDevice *> &Devices() const noexcept { return devices_; }
+        constexpr const std::vector<IMouse *> &Mice() const noexcept { return mice_; }
+        constexpr const std::vector<IKeyboard *> &Keyboards() const noexcept { return keyboards_; }
+        constexpr const std::vector<IGamepad *> &Gamepads() const noexcept { return gamepads_; }
+
+    private:
+        template <typename T>
+        static inline void SwapRemove(std::vector<T *> &values, std::vector<uint32_t> &value_slots, const uint32_t index, std::vector<Slot> &slots, uint32_t Slot::*index_member)
+        {
+            const uint32_t last = static_cast<uint32_t>(values.size() - 1);
+            if (index != last)
+            {
+                values[index] = values[last];
+                value_slots[index] = value_slots[last];
+                slots[value_slots[index]].*index_member = index;
+            }
+
+            values.pop_back();
+            value_slots.pop_back();
+        }
+    };
+
+    extern DeviceRegistry glob_devices;
 
 
     inline constexpr float TimestampDeltaSeconds(const timestamp_t first, const timestamp_t second) noexcept
@@ -75,97 +295,173 @@ namespace crossput
     }
 
 
-    // timestamp, state (encoded), threshold, value
-    struct TSTV
+    // structure-of-arrays storage of timestamps, digital states, thresholds and values
+    // (keeps each attribute contiguous so bulk readers can copy it without touching the others)
+    template <size_t N>
+    class StateArray
     {
-        timestamp_t _a;
-        float _b;
-        float _c;
+    public:
+        static constexpr size_t NUM_STATE_WORDS = (N + 63) / 64;
+
+    private:
+        timestamp_t timestamps_[N] = {};
+        float thresholds_[N] = {};
+        float values_[N] = {};
+        uint64_t states_[NUM_STATE_WORDS] = {};
 
-        constexpr timestamp_t Timestamp() const noexcept { return _a & TIMESTAMP_BITMASK; }
-        constexpr void SetTimestamp(const timestamp_t timestamp) noexcept { _a = (_a & STATE_BITMASK) | (timestamp & TIMESTAMP_BITMASK); }
+    public:
+        constexpr timestamp_t Timestamp(const size_t i) const noexcept { return timestamps_[i]; }
 
-        constexpr bool State() const noexcept { return static_cast<bool>(_a & STATE_BITMASK); }
-        constexpr void SetState(const bool state) noexcept { _a = (static_cast<timestamp_t>(state) << (sizeof(timestamp_t) * CHAR_BIT - 1)) | (_a & TIMESTAMP_BITMASK); }
+        constexpr bool State(const size_t i) const noexcept { return (states_[i / 64] >> (i % 64)) & 1; }
 
-        constexpr void SetTimestampState(const timestamp_t timestamp, const bool state) noexcept
-        {
-            _a = (static_cast<timestamp_t>(state) << (sizeof(timestamp_t) * CHAR_BIT - 1))
-                | (timestamp & TIMESTAMP_BITMASK);
-        }
+        constexpr float Threshold(const size_t i) const noexcept { return thresholds_[i]; }
+        constexpr void SetThreshold(const size_t i, const float threshold) noexcept { thresholds_[i] = threshold; }
 
-        constexpr float Threshold() const noexcept { return _b; }
-        constexpr void SetThreshold(const float threshold) noexcept { _b = threshold; }
+        constexpr float Value(const size_t i) const noexcept { return values_[i]; }
 
-        constexpr float Value() const noexcept { return _c; }
-        constexpr void SetValue(const float value) noexcept { _c = value; }
+        // clears everything including thresholds
+        constexpr void Reset() noexcept { *this = {}; }
 
-        
         // returns true if underlying values were actually modified
-        [[nodiscard]] constexpr bool Modify(const float new_value, const timestamp_t ts, bool &new_state) noexcept
+        [[nodiscard]] constexpr bool Modify(const size_t i, const float new_value, const timestamp_t ts, bool &new_state) noexcept
         {
-            const bool old_state = State();
-            new_state = AnalogToDigital(new_value, Threshold(), old_state);
-            const bool value_changed = new_value != Value();
+            const bool old_state = State(i);
+            new_state = AnalogToDigital(new_value, thresholds_[i], old_state);
+            const bool value_changed = new_value != values_[i];
             const bool state_changed = new_state != old_state;
-            const bool force_write = Timestamp() == 0;
-            
-            if (state_changed || force_write) { SetTimestampState(ts, new_state); }
-            if (value_changed || force_write) { SetValue(new_value); }
+            const bool force_write = timestamps_[i] == 0;
+
+            if (state_changed || force_write) { SetTimestampState(i, ts, new_state); }
+            if (value_changed || force_write) { values_[i] = new_value; }
 
             return value_changed || state_changed || (force_write && new_state);
         }
 
         // returns true if the underlying values were actually modified
         // KBD VERSION
-        [[nodiscard]] constexpr bool Modify(const float new_value, const timestamp_t ts, bool &new_state, auto &counter) noexcept
+        [[nodiscard]] constexpr bool Modify(const size_t i, const float new_value, const timestamp_t ts, bool &new_state, auto &counter) noexcept
         {
-            const bool old_state = State();
-            new_state = AnalogToDigital(new_value, Threshold(), old_state);
-            const bool value_changed = new_value != Value();
+            const bool old_state = State(i);
+            new_state = AnalogToDigital(new_value, thresholds_[i], old_state);
+            const bool value_changed = new_value != values_[i];
             const bool state_changed = new_state != old_state;
-            const bool force_write = Timestamp() == 0;
-            
+            const bool force_write = timestamps_[i] == 0;
+
             if (state_changed || force_write)
             {
-                SetTimestampState(ts, new_state);
+                SetTimestampState(i, ts, new_state);
                 if (new_state) { counter++; }
                 else if (!force_write) { counter--; }
             }
-            if (value_changed || force_write) { SetValue(new_value); }
+            if (value_changed || force_write) { values_[i] = new_value; }
 
             return value_changed || state_changed || (force_write && new_state);
         }
-        
-        constexpr void Modify(const float new_value, const timestamp_t ts) noexcept
+
+        // overwrites an entry with externally determined data (e.g. received from another machine),
+        // returns true if the value or digital state changed
+        constexpr bool Assign(const size_t i, const float value, const timestamp_t ts, const bool state) noexcept
         {
-            const bool old_state = State();
-            const bool new_state = AnalogToDigital(new_value, Threshold(), old_state);
-            const bool force_write = Timestamp() == 0;
-            
-            if (new_state != old_state || force_write) { SetTimestampState(ts, new_state); }
-            if (new_value != Value() || force_write) { SetValue(new_value); }
+            const bool changed = value != values_[i] || state != State(i);
+            SetTimestampState(i, ts, state);
+            values_[i] = value;
+            return changed;
         }
 
-        // KBD VERSION
-        constexpr void Modify(const float new_value, const timestamp_t ts, auto &counter) noexcept
+        // non-virtual read access for users (see StateView), limited to the first count entries
+        inline StateView View(const bool &is_connected, const size_t count = N) const noexcept
+        {
+            return StateView(values_, states_, timestamps_, &is_connected, static_cast<uint32_t>(std::min(count, N)));
+        }
+
+        // bulk readers, everything reads as released if the device is disconnected
+        inline void CopyStates(uint64_t *const states, const size_t num_words, const bool is_connected) const noexcept
         {
-            const bool old_state = State();
-            const bool new_state = AnalogToDigital(new_value, Threshold(), old_state);
-            const bool force_write = Timestamp() == 0;
-            
-            if (new_state != old_state || force_write)
+            const size_t n = is_connected ? std::min(num_words, NUM_STATE_WORDS) : 0;
+            std::memcpy(states, states_, n * sizeof(uint64_t));
+            std::memset(states + n, 0, (num_words - n) * sizeof(uint64_t));
+        }
+
+        inline void CopyValues(float *const values, const size_t count, const bool is_connected) const noexcept
+        {
+            const size_t n = std::min(count, N);
+            if (is_connected) { std::memcpy(values, values_, n * sizeof(float)); }
+            else { std::memset(values, 0, n * sizeof(float)); }
+        }
+
+        inline void CopyTimestamps(uint64_t *const timestamps, const size_t count, const bool is_connected) const noexcept
+        {
+            const size_t n = std::min(count, N);
+            if (is_connected) { std::memcpy(timestamps, timestamps_, n * sizeof(timestamp_t)); }
+            else { std::memset(timestamps, 0, n * sizeof(timestamp_t)); }
+        }
+
+    private:
+        constexpr void SetTimestampState(const size_t i, const timestamp_t ts, const bool state) noexcept
+        {
+            timestamps_[i] = ts;
+            const uint64_t bit = static_cast<uint64_t>(1) << (i % 64);
+            states_[i / 64] = state ? (states_[i / 64] | bit) : (states_[i / 64] & ~bit);
+        }
+    };
+
+
+    // generation of the most recent change of each input, answers "changed since" queries without bookkeeping by the reader
+    template <size_t N>
+    class ChangeGenerations
+    {
+    private:
+        uint64_t generations_[N] = {};
+
+    public:
+        constexpr void Mark(const size_t i, const uint64_t generation) noexcept
+        {
+            if (i < N) [[likely]] { generations_[i] = generation; }
+        }
+
+        inline void Collect(const uint64_t since_generation, uint64_t *const changed, const size_t num_words) const noexcept
+        {
+            std::memset(changed, 0, num_words * sizeof(uint64_t));
+            const size_t n = std::min(N, num_words * 64);
+            for (size_t i = 0; i < n; i++)
             {
-                SetTimestampState(ts, new_state);
-                if (new_state) { counter++; }
-                else if (!force_write) { counter--; }
+                changed[i / 64] |= static_cast<uint64_t>(generations_[i] > since_generation) << (i % 64);
             }
-            if (new_value != Value() || force_write) { SetValue(new_value); }
         }
+    };
+
+
+    // bounded lock-free queue with exactly one producer thread and one consumer thread
+    template <typename T, size_t CAPACITY>
+    class SpscQueue
+    {
+        static_assert(std::has_single_bit(CAPACITY), "capacity must be a power of two");
 
     private:
-        static constexpr timestamp_t STATE_BITMASK = static_cast<timestamp_t>(1) << (sizeof(timestamp_t) * CHAR_BIT - 1);
-        static constexpr timestamp_t TIMESTAMP_BITMASK = ~STATE_BITMASK;
+        alignas(64) std::atomic<size_t> head_ = 0; // index of next read, only written by the consumer
+        alignas(64) std::atomic<size_t> tail_ = 0; // index of next write, only written by the producer
+        T items_[CAPACITY];
+
+    public:
+        inline bool TryPush(const T &item) noexcept
+        {
+            const size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail - head_.load(std::memory_order_acquire) == CAPACITY) { return false; }
+
+            items_[tail & (CAPACITY - 1)] = item;
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        inline bool TryPop(T &item) noexcept
+        {
+            const size_t head = head_.load(std::memory_order_relaxed);
+            if (head == tail_.load(std::memory_order_acquire)) { return false; }
+
+            item = items_[head & (CAPACITY - 1)];
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
     };
 
 
@@ -192,35 +488,484 @@ namespace crossput
     };
 
 
+    // range of native events read per system call
+    constexpr uint32_t DEFAULT_READ_BATCH_SIZE = 64;
+    constexpr uint32_t MAX_READ_BATCH_SIZE = 4096;
+
+
+    // AXIS PROFILES
+
+    constexpr AxisProfile ClampAxisProfile(const AxisProfile &profile) noexcept
+    {
+        AxisProfile p;
+        p.deadzone = std::clamp(profile.deadzone, 0.0F, 0.99F);
+        p.outer_deadzone = std::clamp(profile.outer_deadzone, 0.0F, 0.99F - p.deadzone);
+        p.anti_deadzone = std::clamp(profile.anti_deadzone, 0.0F, 0.99F);
+        p.exponent = std::clamp(profile.exponent, 0.1F, 10.0F);
+        return p;
+    }
+
+
+    constexpr bool IsLinearAxisProfile(const AxisProfile &p) noexcept
+    {
+        return p.deadzone == 0.0F && p.outer_deadzone == 0.0F && p.anti_deadzone == 0.0F && p.exponent == 1.0F;
+    }
+
+
+    // maps a magnitude in [0.0, 1.0] according to a clamped profile
+    inline float ApplyAxisProfile(const AxisProfile &p, const float magnitude) noexcept
+    {
+        if (magnitude <= p.deadzone) { return 0.0F; }
+
+        float t = std::min(1.0F, (magnitude - p.deadzone) / (1.0F - p.outer_deadzone - p.deadzone));
+        if (p.exponent != 1.0F) { t = std::pow(t, p.exponent); }
+        return p.anti_deadzone + (1.0F - p.anti_deadzone) * t;
+    }
+
+
+    // implements:
+    // IGamepad::GetRawThumbstick(...)
+    // IGamepad::SetThumbstickProfile(...)
+    // IGamepad::GetThumbstickProfile(...)
+    // IGamepad::SetButtonProfile(...)
+    // IGamepad::GetButtonProfile(...)
+    // and processes the thumbsticks and analog buttons of gamepads which produce their own input
+    class GamepadProfileManager : public virtual IGamepad
+    {
+    private:
+        AxisProfile thumbstick_profiles_[MAX_THUMBSTICK_PROFILES];
+        AxisProfile button_profiles_[NUM_BUTTON_CODES];
+        float raw_thumbsticks_[MAX_THUMBSTICK_PROFILES * 2] = {};
+        uint32_t active_thumbstick_profiles_ = 0; // bitset of non-linear profiles
+        uint32_t active_button_profiles_ = 0;
+
+        static_assert(MAX_THUMBSTICK_PROFILES <= 32 && NUM_BUTTON_CODES <= 32);
+
+    public:
+        GamepadProfileManager() noexcept
+        {
+            std::fill(std::begin(thumbstick_profiles_), std::end(thumbstick_profiles_), LINEAR_AXIS_PROFILE);
+            std::fill(std::begin(button_profiles_), std::end(button_profiles_), LINEAR_AXIS_PROFILE);
+        }
+
+        void GetRawThumbstick(const uint32_t index, float &x, float &y) const override final
+        {
+            if (index < MAX_THUMBSTICK_PROFILES && index < GetThumbstickCount())
+            {
+                x = raw_thumbsticks_[index * 2];
+                y = raw_thumbsticks_[index * 2 + 1];
+            }
+            else
+            {
+                x = 0.0F;
+                y = 0.0F;
+            }
+        }
+
+        void SetThumbstickProfile(const uint32_t index, const AxisProfile &profile) override final
+        {
+            if (index >= MAX_THUMBSTICK_PROFILES) { return; }
+
+            thumbstick_profiles_[index] = ClampAxisProfile(profile);
+            SetActiveBit(active_thumbstick_profiles_, index, !IsLinearAxisProfile(thumbstick_profiles_[index]));
+        }
+
+        AxisProfile GetThumbstickProfile(const uint32_t index) const override final
+        {
+            return index < MAX_THUMBSTICK_PROFILES ? thumbstick_profiles_[index] : LINEAR_AXIS_PROFILE;
+        }
+
+        void SetButtonProfile(const Button button, const AxisProfile &profile) override final
+        {
+            if (!IsValidButton(button)) { return; }
+
+            const int i = static_cast<int>(button);
+            button_profiles_[i] = ClampAxisProfile(profile);
+            SetActiveBit(active_button_profiles_, i, !IsLinearAxisProfile(button_profiles_[i]));
+        }
+
+        AxisProfile GetButtonProfile(const Button button) const override final
+        {
+            return IsValidButton(button) ? button_profiles_[static_cast<int>(button)] : LINEAR_AXIS_PROFILE;
+        }
+
+    protected:
+        // stores the raw position and replaces it by the processed one
+        inline void ProcessThumbstick(const uint32_t index, float &x, float &y) noexcept
+        {
+            if (index >= MAX_THUMBSTICK_PROFILES) [[unlikely]] { return; }
+
+            raw_thumbsticks_[index * 2] = x;
+            raw_thumbsticks_[index * 2 + 1] = y;
+            if ((active_thumbstick_profiles_ & (1U << index)) == 0) [[likely]] { return; }
+
+            // radial, so the direction is preserved
+            const float magnitude = std::sqrt(x * x + y * y);
+            const float processed = ApplyAxisProfile(thumbstick_profiles_[index], std::min(magnitude, 1.0F));
+            const float scale = magnitude > 0.0F ? processed / magnitude : 0.0F;
+            x = std::clamp(x * scale, -1.0F, 1.0F);
+            y = std::clamp(y * scale, -1.0F, 1.0F);
+        }
+
+        inline float ProcessButton(const Button button, const float value) const noexcept
+        {
+            const int i = static_cast<int>(button);
+            if ((active_button_profiles_ & (1U << i)) == 0) [[likely]] { return value; }
+            return ApplyAxisProfile(button_profiles_[i], std::clamp(value, 0.0F, 1.0F));
+        }
+
+        constexpr float RawThumbstickAxis(const size_t axis) const noexcept { return raw_thumbsticks_[axis]; }
+
+        inline void ResetRawThumbsticks() noexcept
+        {
+            std::fill(std::begin(raw_thumbsticks_), std::end(raw_thumbsticks_), 0.0F);
+        }
+
+    private:
+        static constexpr void SetActiveBit(uint32_t &bits, const int i, const bool active) noexcept
+        {
+            bits = active ? (bits | (1U << i)) : (bits & ~(1U << i));
+        }
+    };
+
+
+    // implements the profile methods to be non-functional
+    // (for gamepads whose input has already been processed elsewhere, e.g. by an input server)
+    class GamepadProfileManagerEmpty : public virtual IGamepad
+    {
+    public:
+        void GetRawThumbstick(const uint32_t index, float &x, float &y) const override final { GetThumbstick(index, x, y); }
+        void SetThumbstickProfile(const uint32_t, const AxisProfile &) override final {}
+        AxisProfile GetThumbstickProfile(const uint32_t) const override final { return LINEAR_AXIS_PROFILE; }
+        void SetButtonProfile(const Button, const AxisProfile &) override final {}
+        AxisProfile GetButtonProfile(const Button) const override final { return LINEAR_AXIS_PROFILE; }
+    };
+
+
+    // CAPTURE
+
+    // capture files consist of a CaptureHeader followed by tightly packed fixed-size records,
+    // which allows replaying them straight from a memory-mapped file
+    inline constexpr char CAPTURE_MAGIC[8] = {'C', 'R', 'S', 'P', 'T', 'C', 'A', 'P'};
+    constexpr uint32_t CAPTURE_VERSION = 1;
+
+    enum class CaptureRecordKind : uint8_t
+    {
+        DEVICE = 0, // first appearance of a device, detail holds the DeviceType
+        EVENT,      // change of input
+        STATUS      // detail holds the DeviceStatusChange, only the timestamp of the event is valid
+    };
+
+    struct CaptureHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t record_size;
+    };
+
+    struct CaptureRecord
+    {
+        uint32_t device; // index of device within the capture
+        CaptureRecordKind kind;
+        uint8_t detail;
+        uint16_t reserved;
+        InputEvent event;
+    };
+
+    static_assert(sizeof(CaptureHeader) == 16);
+    static_assert(sizeof(CaptureRecord) == 32);
+
+    class CaptureWriter;
+    extern CaptureWriter *glob_p_capture; // nullptr while not capturing
+
+    // only invoked while capturing
+    void CaptureEvent(const IDevice *const p_device, const InputEvent &ev) noexcept;
+    void CaptureStatus(const IDevice *const p_device, const DeviceStatusChange status) noexcept;
+
+
+    // SHARED MEMORY
+
+    class InputServer;
+    extern InputServer *glob_p_server; // nullptr while no server is running
+
+    // only invoked while a server is running
+    void ServerEvent(const IDevice *const p_device, const InputEvent &ev) noexcept;
+    void PublishServerState();
+
+    // also used by the input thread
+    void CaptureSnapshot(IDevice *const p_device, DeviceSnapshot &snapshot);
+
+
+    // ACTIONS
+
+    class ActionMap;
+    extern std::vector<ActionMap *> glob_action_maps;
+
+    // only invoked if there are any action maps
+    void EvaluateActionMaps();
+
+
+    // DEVICE UPDATES
+
+    // platform-specific, brackets the device updates of UpdateAllDevices() so that work can be batched across devices
+    void BeginDeviceUpdates();
+    void EndDeviceUpdates();
+
+    class DeviceUpdateBatch
+    {
+    public:
+        DeviceUpdateBatch() { BeginDeviceUpdates(); }
+        ~DeviceUpdateBatch() { EndDeviceUpdates(); } // also ends the batch if a device update throws
+        DeviceUpdateBatch(const DeviceUpdateBatch &) = delete;
+        DeviceUpdateBatch &operator=(const DeviceUpdateBatch &) = delete;
+    };
+
+
+    // WAITING
+
+    // longer timeouts of WaitForInput() (roughly 31 years) wait indefinitely, their deadline would overflow the clock
+    constexpr float MAX_WAIT_TIMEOUT = 1.0e9F;
+
+    // true if WaitForInput() waits without a deadline (negative, NaN, or longer than MAX_WAIT_TIMEOUT)
+    constexpr bool IsInfiniteWaitTimeout(const float timeout) noexcept
+    {
+        return !(timeout >= 0.0F && timeout <= MAX_WAIT_TIMEOUT);
+    }
+
+
+    // STATS
+
+    #ifdef CROSSPUT_FEATURE_STATS
+    // counters of destroyed devices and of calls that are not attributable to a single device
+    extern DeviceStats glob_stats;
+
+    void AccumulateStats(DeviceStats &dest, const DeviceStats &src) noexcept;
+
+    // logarithmic buckets with 8 linear sub-buckets each, exact below 8 microseconds
+    constexpr size_t LatencyBucket(const uint64_t us) noexcept
+    {
+        if (us < 8) { return static_cast<size_t>(us); }
+        const size_t e = static_cast<size_t>(std::bit_width(us)) - 1;
+        return std::min(8 * (e - 2) + static_cast<size_t>((us >> (e - 3)) & 7), NUM_LATENCY_BUCKETS - 1);
+    }
+
+    // events without a timestamp are not counted, events from the future count as zero latency
+    inline void RecordLatency(uint64_t (&histogram)[NUM_LATENCY_BUCKETS], const timestamp_t timestamp, const timestamp_t now) noexcept
+    {
+        if (timestamp == 0) [[unlikely]] { return; }
+        histogram[LatencyBucket(now - std::min(timestamp, now))]++;
+    }
+
+    // records the duration of a device update when going out of scope
+    class UpdateTimer
+    {
+    private:
+        DeviceStats &stats_;
+        const std::chrono::steady_clock::time_point start_;
+
+    public:
+        UpdateTimer(DeviceStats &stats) noexcept : stats_(stats), start_(std::chrono::steady_clock::now()) {}
+        UpdateTimer(const UpdateTimer &) = delete;
+        UpdateTimer &operator=(const UpdateTimer &) = delete;
+
+        ~UpdateTimer()
+        {
+            const uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count());
+            stats_.updates++;
+            stats_.update_time_total += ns;
+            stats_.update_time_max = std::max(stats_.update_time_max, ns);
+            stats_.update_time_histogram[std::min(static_cast<size_t>(std::bit_width(ns)), NUM_UPDATE_TIME_BUCKETS - 1)]++;
+        }
+    };
+
+    // only usable within member functions of device interfaces
+    #define CROSSPUT_STATS_ADD(counter, n) (stats_.counter += static_cast<uint64_t>(n))
+    #define CROSSPUT_STATS_TIME_UPDATE() const UpdateTimer update_timer_(stats_)
+    #define CROSSPUT_STATS_ADD_GLOBAL(counter, n) (glob_stats.counter += static_cast<uint64_t>(n))
+    #else
+    #define CROSSPUT_STATS_ADD(counter, n) static_cast<void>(0)
+    #define CROSSPUT_STATS_TIME_UPDATE() static_cast<void>(0)
+    #define CROSSPUT_STATS_ADD_GLOBAL(counter, n) static_cast<void>(0)
+    #endif // CROSSPUT_FEATURE_STATS
+
+
     // implements:
     // IDevice::GetID()
     // IDevice::IsConnected()
-    // and provides basic ID and status functionality
-    class BaseInterface : public virtual IDevice
+    // IDevice::SetReadBatchSize(...)
+    // IDevice::GetReadBatchSize()
+    // IDevice::SetEventHistoryCapacity(...)
+    // IDevice::GetEventHistoryCapacity()
+    // IDevice::ReadEvents(...)
+    // IDevice::GetGeneration()
+    // and provides basic ID, status, change generation, and event history functionality
+    class BaseInterface : public virtual IDevice, public MemoryManaged
     {
     protected:
         const ID id_;
+        std::unique_ptr<InputEvent[]> history_;
+        uint32_t history_capacity_ = 0;
+        uint32_t history_head_ = 0; // index of next write
+        uint32_t history_size_ = 0;
+        uint32_t read_batch_size_ = DEFAULT_READ_BATCH_SIZE;
+        uint32_t aggregate_link_count_ = 0; // number of aggregates this interface is a member of
+        uint64_t generation_ = 0; // global generation of the most recent change of input or status
+        timestamp_t last_serviced_timestamp_ = 0;
+        uint64_t next_update_tick_ = 0; // UpdatePolicy::ADAPTIVE only
+        uint32_t update_interval_ = 1; // UpdatePolicy::ADAPTIVE only
+        uint32_t max_update_interval_ = DEFAULT_MAX_UPDATE_INTERVAL;
+        uint32_t idle_updates_ = 0; // UpdatePolicy::ADAPTIVE only
+        UpdatePolicy update_policy_ = UpdatePolicy::ALWAYS;
         bool is_connected_ = false;
+        #ifdef CROSSPUT_FEATURE_STATS
+        DeviceStats stats_ = {};
+        timestamp_t last_event_timestamp_ = 0; // of the most recently recorded event
+        #endif // CROSSPUT_FEATURE_STATS
 
     public:
         constexpr ID GetID() const noexcept override final { return id_; }
         constexpr bool IsConnected() const override final { return is_connected_; }
-        virtual ~BaseInterface() = default;
+        void SetReadBatchSize(const uint32_t size) override { read_batch_size_ = std::clamp(size, static_cast<uint32_t>(1), MAX_READ_BATCH_SIZE); }
+        constexpr uint32_t GetReadBatchSize() const override final { return read_batch_size_; }
+        void SetEventHistoryCapacity(const uint32_t capacity) override final;
+        constexpr uint32_t GetEventHistoryCapacity() const override final { return history_capacity_; }
+        size_t ReadEvents(const uint64_t since_timestamp, InputEvent *const events, const size_t max_events) const override final;
+        size_t ReadEvents(const uint64_t since_timestamp, std::vector<InputEvent> &events) const override final;
+        constexpr bool IsAggregateMember() const noexcept { return aggregate_link_count_ != 0; }
+        constexpr void AddAggregateLink() noexcept { aggregate_link_count_++; }
+        constexpr void RemoveAggregateLink() noexcept { aggregate_link_count_--; }
+        constexpr uint64_t GetGeneration() const noexcept override final { return generation_; }
+        inline void MarkChanged() noexcept { generation_ = ++glob_generation; }
+        constexpr UpdatePolicy GetUpdatePolicy() const override final { return update_policy_; }
+        constexpr uint32_t GetMaxUpdateInterval() const override final { return max_update_interval_; }
+        constexpr uint64_t GetLastUpdateTimestamp() const override final { return last_serviced_timestamp_; }
+
+        void SetUpdatePolicy(const UpdatePolicy policy, const uint32_t max_interval) override final
+        {
+            update_policy_ = policy;
+            max_update_interval_ = std::clamp(max_interval, static_cast<uint32_t>(1), MAX_UPDATE_INTERVAL);
+            update_interval_ = 1;
+            idle_updates_ = 0;
+            next_update_tick_ = 0;
+        }
+
+        // true if UpdateAllDevices() has to update this device during the given tick
+        constexpr bool IsUpdateDue(const uint64_t tick) const noexcept
+        {
+            return update_policy_ == UpdatePolicy::ALWAYS || (update_policy_ == UpdatePolicy::ADAPTIVE && tick >= next_update_tick_);
+        }
+
+        // adapts the interval of UpdatePolicy::ADAPTIVE after UpdateAllDevices() updated this device
+        constexpr void ScheduleNextUpdate(const uint64_t tick, const uint64_t prev_generation) noexcept
+        {
+            if (generation_ != prev_generation)
+            {
+                // changes of status are changes as well, so reconnecting restores the interval
+                update_interval_ = 1;
+                idle_updates_ = 0;
+            }
+            else if (!is_connected_)
+            {
+                // failed attempt to reconnect
+                update_interval_ = std::min(update_interval_ * 2, MAX_RECONNECT_INTERVAL);
+            }
+            else if (++idle_updates_ >= ADAPTIVE_IDLE_UPDATES)
+            {
+                update_interval_ = std::min(update_interval_ * 2, max_update_interval_);
+                idle_updates_ = 0;
+            }
+
+            next_update_tick_ = tick + update_interval_;
+        }
+        #ifdef CROSSPUT_FEATURE_STATS
+        constexpr DeviceStats &Stats() noexcept { return stats_; }
+        constexpr timestamp_t LastEventTimestamp() const noexcept { return last_event_timestamp_; }
+        #endif // CROSSPUT_FEATURE_STATS
+
+        virtual ~BaseInterface()
+        {
+            #ifdef CROSSPUT_FEATURE_STATS
+            AccumulateStats(glob_stats, stats_); // keep global counters monotonic
+            #endif // CROSSPUT_FEATURE_STATS
+            glob_devices.Release(id_);
+        }
 
     protected:
-        BaseInterface() : id_(ReserveID()) {}
+        BaseInterface() : id_(glob_devices.Reserve(this)) {}
+
+        // invoked at the beginning of every Update()
+        inline void MarkServiced() noexcept { last_serviced_timestamp_ = NowTimestamp(); }
+
+        inline void RecordEvent(const InputEvent &ev) noexcept
+        {
+            MarkChanged();
+            #ifdef CROSSPUT_FEATURE_STATS
+            if (ev.timestamp != 0) [[likely]]
+            {
+                const timestamp_t now = NowTimestamp();
+                stats_.latency_max = std::max(stats_.latency_max, now - std::min(ev.timestamp, now));
+                RecordLatency(stats_.latency_histogram, ev.timestamp, now);
+                last_event_timestamp_ = ev.timestamp;
+            }
+            #endif // CROSSPUT_FEATURE_STATS
+            if (glob_p_capture != nullptr) [[unlikely]] { CaptureEvent(this, ev); }
+            if (glob_p_server != nullptr) [[unlikely]] { ServerEvent(this, ev); }
+            if (history_capacity_ == 0) [[likely]] { return; }
+
+            history_[history_head_] = ev;
+            history_head_ = (history_head_ + 1 < history_capacity_) ? (history_head_ + 1) : 0;
+            if (history_size_ < history_capacity_) { history_size_++; }
+        }
+
+        inline void RecordValueEvent(const InputEventType type, const uint16_t code, const float value, const bool state, const timestamp_t timestamp) noexcept
+        {
+            InputEvent ev = { .timestamp = timestamp, .type = type, .state = state, .code = code };
+            ev.value = value;
+            RecordEvent(ev);
+        }
+
+        inline void RecordAxesEvent(const InputEventType type, const uint16_t code, const float x, const float y, const timestamp_t timestamp) noexcept
+        {
+            InputEvent ev = { .timestamp = timestamp, .type = type, .state = false, .code = code };
+            ev.axes = { x, y };
+            RecordEvent(ev);
+        }
+
+        inline void RecordDeltaEvent(const InputEventType type, const int64_t dx, const int64_t dy, const timestamp_t timestamp) noexcept
+        {
+            constexpr int64_t MIN_DELTA = std::numeric_limits<int32_t>::min();
+            constexpr int64_t MAX_DELTA = std::numeric_limits<int32_t>::max();
+            InputEvent ev = { .timestamp = timestamp, .type = type, .state = false, .code = 0 };
+            ev.delta = { static_cast<int32_t>(std::clamp(dx, MIN_DELTA, MAX_DELTA)), static_cast<int32_t>(std::clamp(dy, MIN_DELTA, MAX_DELTA)) };
+            RecordEvent(ev);
+        }
     };
 
 
+    // status changes are rare, so looking up the interface is acceptable
+    inline void MarkStatusChanged(const IDevice *const p_device) noexcept
+    {
+        BaseInterface *const p_interface = glob_devices.Find(p_device->GetID());
+        if (p_interface != nullptr) { p_interface->MarkChanged(); }
+    }
+
+
     template <typename T>
-    inline size_t GetDevicesOfType(std::vector<T *> &devices, const DeviceType type, const bool ignore_disconnected)
+    inline size_t GetDevicesOfType(std::vector<T *> &devices, const std::vector<T *> &source, const bool ignore_disconnected)
     {
+        if (!ignore_disconnected)
+        {
+            // shortcut
+            devices.insert(devices.end(), source.cbegin(), source.cend());
+            return source.size();
+        }
+
         size_t num = 0;
-        for (const auto &elm : glob_interfaces)
+        for (T *const p_device : source)
         {
-            if (elm.second->GetType() == type && (!ignore_disconnected || elm.second->IsConnected()))
+            if (p_device->IsConnected())
             {
-                devices.push_back(dynamic_cast<T *>(elm.second));
+                devices.push_back(p_device);
                 num++;
             }
         }
@@ -244,170 +989,268 @@ namespace crossput
 
 namespace crossput
 {
-    struct EventCallbackKey
+    using callback_filter_t = uint64_t;
+
+    // type which can be used as a callback filter
+    template <typename T>
+    concept EvcbFilterType = (std::is_integral_v<T> || std::is_enum_v<T>) && sizeof(T) <= sizeof(callback_filter_t);
+
+    // CTYPEID of each callback type is used as an index into arrays of this size
+    constexpr size_t NUM_CALLBACK_TYPES = 8;
+
+    // filters below this value are looked up directly, all others via linear search
+    constexpr callback_filter_t DENSE_FILTER_LIMIT = 256;
+
+
+    class EventCallbackWrapper;
+    class CallbackTable;
+    class DeviceCallbackManagerImpl;
+    class MouseCallbackManagerImpl;
+    class KeyboardCallbackManagerImpl;
+    class GamepadCallbackManagerImpl;
+
+    using DeviceCallbackManager = DeviceCallbackManagerImpl;
+    using MouseCallbackManager = MouseCallbackManagerImpl;
+    using KeyboardCallbackManager = KeyboardCallbackManagerImpl;
+    using GamepadCallbackManager = GamepadCallbackManagerImpl;
+
+
+    struct CallbackRecord
     {
-        using filter_type = uint64_t;
+        EventCallbackWrapper *p_wrapper;
+        CallbackTable *p_table;
+    };
 
-        ID device_id;
-        filter_type filter;
-        unsigned short ctypeid;
-        bool has_filter;
 
-        inline bool operator==(const EventCallbackKey &other) const noexcept
-        {
-            return device_id == other.device_id
-                && filter == other.filter
-                && ctypeid == other.ctypeid
-                && has_filter == other.has_filter;
-        }
+    // change of input queued for deferred delivery, invoked via a dispatcher instantiated for the specific callback type
+    struct PendingCallback
+    {
+        static constexpr size_t MAX_DATA_SIZE = 4 * sizeof(int64_t);
+
+        void (*p_dispatch)(const PendingCallback &);
+        const CallbackTable *p_device_table;
+        const void *p_device;
+        callback_filter_t filter;
+        timestamp_t event_timestamp; // for the callback latency
+        alignas(int64_t) unsigned char data[MAX_DATA_SIZE]; // std::tuple of callback arguments
+    };
 
-        inline bool operator!=(const EventCallbackKey &other) const noexcept
-        {
-            return !(operator==(other));
-        }
+
+    extern bool glob_disable_management_api;
+    extern ManagedMap<ID, CallbackRecord> glob_callbacks;
+    extern CallbackTable glob_callback_tables[NUM_CALLBACK_TYPES];
+    extern CallbackDelivery glob_callback_delivery;
+    extern std::vector<PendingCallback> glob_pending_callbacks;
+
+
+    #ifdef CROSSPUT_COROUTINES
+    // intrusive list of suspended coroutines, in order of suspension
+    struct WaiterList
+    {
+        impl::_InputWaiter *p_head;
+        impl::_InputWaiter *p_tail;
     };
 
+    extern WaiterList glob_waiters[NUM_CALLBACK_TYPES];
+    extern WaiterList glob_ready_waiters;        // matched by input, but not resumed yet
+    extern WaiterList glob_ready_status_waiters; // matched by a status change, resumed immediately
+
+    // move matching waiters to a ready list and resume them, unless delivery of input is deferred
+    void WakeWaiters(const unsigned short ctypeid, const IDevice *const p_device, const uint32_t code, const float value);
+
+    // returns the number of resumed coroutines
+    size_t ResumeReadyWaiters(WaiterList &list);
 
-    // non-filtered callback
+    // clear references to a device which is destroyed before its waiters are resumed
+    void OrphanReadyWaiters(const IDevice *const p_device) noexcept;
+    #endif // CROSSPUT_COROUTINES
+
+
+    // resume coroutines awaiting the input, which costs a single branch while there are none
     template <typename TCallback>
-    constexpr EventCallbackKey ConstructEventCallbackKey(const ID device_id) noexcept
+    inline void NotifyWaiters([[maybe_unused]] const IDevice *const p_device, [[maybe_unused]] const uint32_t code, [[maybe_unused]] const float value, [[maybe_unused]] const bool state)
     {
-        return EventCallbackKey
-        {
-            .device_id = device_id,
-            .filter = 0,
-            .ctypeid = TCallback::CTYPEID,
-            .has_filter = false
-        };
+        #ifdef CROSSPUT_COROUTINES
+        if (state && glob_waiters[TCallback::CTYPEID].p_head != nullptr) [[unlikely]] { WakeWaiters(TCallback::CTYPEID, p_device, code, value); }
+        #endif // CROSSPUT_COROUTINES
     }
 
 
-    // type which can be used as a callback filter
-    template <typename T>
-    concept EvcbFilterType = (std::is_integral_v<T> || std::is_enum_v<T>) && sizeof(T) <= sizeof(EventCallbackKey::filter_type);
+    // resume coroutines matched while delivery was deferred, returns their number
+    inline size_t ResumeDeferredWaiters()
+    {
+        #ifdef CROSSPUT_COROUTINES
+        size_t num = 0;
+        if (glob_ready_status_waiters.p_head != nullptr) [[unlikely]] { num += ResumeReadyWaiters(glob_ready_status_waiters); } // left over by an exception
+        if (glob_ready_waiters.p_head != nullptr) { num += ResumeReadyWaiters(glob_ready_waiters); }
+        return num;
+        #else
+        return 0;
+        #endif // CROSSPUT_COROUTINES
+    }
 
 
-    // filtered callback
-    template <typename TCallback, EvcbFilterType T>
-    constexpr EventCallbackKey ConstructEventCallbackKey(const ID device_id, const T value_filter) noexcept
+    inline void ProtectManagementAPI(const char *const details_str)
     {
-        return EventCallbackKey
+        if (glob_disable_management_api)
         {
-            .device_id = device_id,
-            .filter = static_cast<EventCallbackKey::filter_type>(value_filter),
-            .ctypeid = TCallback::CTYPEID,
-            .has_filter = true
-        };
+            throw std::runtime_error(std::format("Illegal access to crossput management API from within a callback. Details: {}", details_str));
+        }
     }
-}
-
 
-template <>
-struct std::hash<crossput::EventCallbackKey>
-{
-    inline size_t operator()(const crossput::EventCallbackKey &key) const
+    // device-specific version, the message is only formatted when actually throwing
+    inline void ProtectManagementAPI(const char *const details_str, const ID device_id)
     {
-        const size_t h1 = std::hash<crossput::ID>().operator()(key.device_id);
-        const size_t h2 = std::hash<crossput::EventCallbackKey::filter_type>().operator()(key.filter);
-        const size_t h3 = std::hash<unsigned short>().operator()(key.ctypeid);
-        const size_t h4 = std::hash<bool>().operator()(key.has_filter);
-        return ((h1 * 23 + h2) * 17 + h3) * 23 + h4;
+        if (glob_disable_management_api) [[unlikely]]
+        {
+            throw std::runtime_error(std::format("Illegal access to crossput management API from within a callback. Details: {} - Device ID {}", details_str, device_id));
+        }
     }
-};
 
 
-namespace crossput
-{
-    class EventCallbackWrapper;
-    class DeviceCallbackManagerImpl;
-    class MouseCallbackManagerImpl;
-    class KeyboardCallbackManagerImpl;
-    class GamepadCallbackManagerImpl;
+    // block management functions during callback invocation to avoid dangerous errors caused by API user
+    // (e.g. iterator invalidation, infinite loops, etc.)
+    class ManagementAPIBlock
+    {
+    private:
+        const bool prev_;
+
+    public:
+        ManagementAPIBlock() : prev_(glob_disable_management_api) { glob_disable_management_api = true; }
+        ~ManagementAPIBlock() { glob_disable_management_api = prev_; } // also restores state in case user handles exception safely
+        ManagementAPIBlock(const ManagementAPIBlock &) = delete;
+        ManagementAPIBlock &operator=(const ManagementAPIBlock &) = delete;
+    };
 
-    using DeviceCallbackManager = DeviceCallbackManagerImpl;
-    using MouseCallbackManager = MouseCallbackManagerImpl;
-    using KeyboardCallbackManager = KeyboardCallbackManagerImpl;
-    using GamepadCallbackManager = GamepadCallbackManagerImpl;
 
+    // owns a single callback object
+    class EventCallbackWrapper : public MemoryManaged
+    {
+    public:
+        virtual const void *GetCallback() const = 0;
+        virtual ~EventCallbackWrapper() = default;
+    };
+
+
+    template <typename TCallback>
+    class EventCallbackWrapperImpl final : public EventCallbackWrapper
+    {
+    private:
+        const typename TCallback::FuncT callback_;
+
+    public:
+        EventCallbackWrapperImpl(const typename TCallback::FuncT &&callback) : callback_(std::move(callback)) {}
+        ~EventCallbackWrapperImpl() = default;
 
-    extern bool glob_disable_management_api;
-    extern std::unordered_map<ID, EventCallbackWrapper *> glob_callbacks;
-    extern std::unordered_multimap<EventCallbackKey, ID> glob_callback_mapping;
+        const void *GetCallback() const override { return &callback_; }
+    };
 
 
-    inline void ProtectManagementAPI(const char *const details_str)
+    template <typename TCallback, typename... TData>
+    inline size_t InvokeCallbackRange(const void *const *it, const void *const *const end, const typename TCallback::DevT *const p_device, const TData... data)
     {
-        if (glob_disable_management_api)
+        const size_t num = static_cast<size_t>(end - it);
+        for (; it != end; it++)
         {
-            throw std::runtime_error(std::format("Illegal access to crossput management API from within a callback. Details: {}", details_str));
+            reinterpret_cast<const typename TCallback::FuncT *>(*it)->operator()(p_device, data...);
         }
-    }
 
-    inline void ProtectManagementAPI(const std::string details_str) { ProtectManagementAPI(details_str.c_str()); }
+        return num;
+    }
 
 
-    class EventCallbackWrapper
+    // all callbacks of a single type attached to the same device (or to no device at all, i.e. global callbacks)
+    // entries are flattened into contiguous ranges per filter whenever a callback is inserted or erased,
+    // which means that dispatch never needs to look up or allocate anything
+    class CallbackTable
     {
+    private:
+        struct Entry
+        {
+            ID id;
+            callback_filter_t filter;
+            const void *p_callback;
+            bool has_filter;
+        };
+
+        std::vector<Entry> entries_; // in order of registration
+        std::vector<const void *> callbacks_; // unfiltered, followed by dense filtered ranges
+        std::vector<uint32_t> filter_offsets_; // range of filter f is [filter_offsets_[f], filter_offsets_[f + 1])
+        std::vector<std::pair<callback_filter_t, const void *>> sparse_; // filters >= DENSE_FILTER_LIMIT
+        uint32_t num_unfiltered_ = 0;
+
     public:
+        constexpr bool IsEmpty() const noexcept { return entries_.empty(); }
+
+        void Insert(const ID id, const void *const p_callback);
+        void Insert(const ID id, const void *const p_callback, const callback_filter_t filter);
+        void Erase(const ID id);
+        void Clear();
+
+        template <typename TCallback, typename... TData>
+        inline size_t InvokeUnfiltered(const typename TCallback::DevT *const p_device, const TData... data) const
+        {
+            return InvokeCallbackRange<TCallback, TData...>(callbacks_.data(), callbacks_.data() + num_unfiltered_, p_device, data...);
+        }
+
         template <typename TCallback, typename... TData>
-        inline void Invoke(const typename TCallback::DevT *const p_device, const TData... data)
+        inline size_t InvokeFiltered(const callback_filter_t filter, const typename TCallback::DevT *const p_device, const TData... data) const
         {
-            // block management functions during callback invocation to avoid dangerous errors caused by API user
-            // (e.g. iterator invalidation, infinite loops, etc.)
-            glob_disable_management_api = true;
-            try
+            size_t num = 0;
+            if (filter + 1 < filter_offsets_.size())
             {
-                reinterpret_cast<const typename TCallback::FuncT *>(GetCallback())->operator()(p_device, data...);
+                const void *const *const p_callbacks = callbacks_.data();
+                num = InvokeCallbackRange<TCallback, TData...>(p_callbacks + filter_offsets_[filter], p_callbacks + filter_offsets_[filter + 1], p_device, data...);
             }
-            catch (...)
+            else if (!sparse_.empty()) [[unlikely]]
             {
-                // disable block in case user handles exception safely
-                glob_disable_management_api = false;
-                throw;
+                for (const auto &[f, p_callback] : sparse_)
+                {
+                    if (f == filter) { num += InvokeCallbackRange<TCallback, TData...>(&p_callback, &p_callback + 1, p_device, data...); }
+                }
             }
 
-            glob_disable_management_api = false;
+            return num;
         }
 
-        virtual ~EventCallbackWrapper() = default;
-
-    protected:
-        virtual const void *GetCallback() const = 0;
+    private:
+        void Rebuild();
     };
 
 
     template <typename TCallback>
-    class EventCallbackWrapperImpl final : public EventCallbackWrapper
+    inline ID InsertCallback(const typename TCallback::FuncT &&callback, CallbackTable &table)
     {
-    private:
-        const typename TCallback::FuncT callback_;
+        const ID id = ReserveID();
+        EventCallbackWrapper *const p_wrapper = new EventCallbackWrapperImpl<TCallback>(std::move(callback));
+        glob_callbacks.insert({id, {p_wrapper, &table}});
+        table.Insert(id, p_wrapper->GetCallback());
+        return id;
+    }
 
-    public:
-        EventCallbackWrapperImpl(const typename TCallback::FuncT &&callback) : callback_(std::move(callback)) {}
-        ~EventCallbackWrapperImpl() = default;
 
-    private:
-        const void *GetCallback() const override { return &callback_; }
-    };
+    template <typename TCallback, EvcbFilterType TValueFilter>
+    inline ID InsertCallback(const typename TCallback::FuncT &&callback, CallbackTable &table, const TValueFilter value_filter)
+    {
+        const ID id = ReserveID();
+        EventCallbackWrapper *const p_wrapper = new EventCallbackWrapperImpl<TCallback>(std::move(callback));
+        glob_callbacks.insert({id, {p_wrapper, &table}});
+        table.Insert(id, p_wrapper->GetCallback(), static_cast<callback_filter_t>(value_filter));
+        return id;
+    }
 
 
     template <typename TCallback>
-    inline ID InsertCallback(const typename TCallback::FuncT &&callback, const ID device_id)
+    inline ID InsertGlobalCallback(const typename TCallback::FuncT &&callback)
     {
-        const ID id = ReserveID();
-        glob_callbacks.insert({id, new EventCallbackWrapperImpl<TCallback>(std::move(callback))});
-        glob_callback_mapping.insert({ConstructEventCallbackKey<TCallback>(device_id), id});
-        return id;
+        return InsertCallback<TCallback>(std::move(callback), glob_callback_tables[TCallback::CTYPEID]);
     }
 
 
     template <typename TCallback, EvcbFilterType TValueFilter>
-    inline ID InsertCallback(const typename TCallback::FuncT &&callback, const ID device_id, const TValueFilter value_filter)
+    inline ID InsertGlobalCallback(const typename TCallback::FuncT &&callback, const TValueFilter value_filter)
     {
-        const ID id = ReserveID();
-        glob_callbacks.insert({id, new EventCallbackWrapperImpl<TCallback>(std::move(callback))});
-        glob_callback_mapping.insert({ConstructEventCallbackKey<TCallback, TValueFilter>(device_id, value_filter), id});
-        return id;
+        return InsertCallback<TCallback>(std::move(callback), glob_callback_tables[TCallback::CTYPEID], value_filter);
     }
 
 
@@ -416,72 +1259,146 @@ namespace crossput
         const auto it = glob_callbacks.find(id);
         if (it != glob_callbacks.end())
         {
-            delete it->second;
+            it->second.p_table->Erase(id);
+            delete it->second.p_wrapper;
             glob_callbacks.erase(it);
         }
     }
 
 
-    template <typename TCallback, typename... TData>
-    void ExecuteCallbacks_Impl(const EventCallbackKey &&key, const typename TCallback::DevT *const p_device, const TData... data)
+    // the event timestamp is zero if the callbacks were invoked immediately, the latest event of the device applies then
+    template <typename TCallback>
+    inline void CountInvokedCallbacks([[maybe_unused]] const IDevice *const p_device, [[maybe_unused]] const size_t num, [[maybe_unused]] const timestamp_t event_timestamp) noexcept
     {
-        // find all callbacks linked to the specific device and value filter
-        auto [it, end] = glob_callback_mapping.equal_range(key);
-        if (it == glob_callback_mapping.end()) { return; }
+        #ifdef CROSSPUT_FEATURE_STATS
+        BaseInterface *const p_interface = glob_devices.Find(p_device->GetID());
+        if (p_interface == nullptr) { return; }
 
-        do
+        DeviceStats &stats = p_interface->Stats();
+        stats.callbacks_invoked += num;
+        if (TCallback::CTYPEID != impl::_StatusCallback::CTYPEID && num != 0)
         {
-            const auto current = it++;
-            if (const auto cbit = glob_callbacks.find(current->second); cbit != glob_callbacks.end())
-            {
-                // valid mapping, callback can be invoked
-                cbit->second->template Invoke<TCallback, TData...>(p_device, data...);
-            }
-            else
-            {
-                // clean up dead mapping
-                glob_callback_mapping.erase(current);
-            }
+            RecordLatency(stats.callback_latency_histogram, event_timestamp != 0 ? event_timestamp : p_interface->LastEventTimestamp(), NowTimestamp());
         }
-        while (it != end);
+        #endif // CROSSPUT_FEATURE_STATS
     }
 
 
-    // execute global and device-specific callbacks using a valuefilter
-    template <typename TCallback, EvcbFilterType TValueFilter, typename... TData>
-    inline void ExecuteCallbacksWithFilter(const typename TCallback::DevT *const p_device, const TValueFilter value_filter, const TData... data)
+    // invoke device-specific and global callbacks, filtered before unfiltered
+    template <typename TCallback, typename... TData>
+    inline void InvokeCallbacksWithFilter(const CallbackTable &device_table, const typename TCallback::DevT *const p_device, const callback_filter_t filter, const timestamp_t event_timestamp, const TData... data)
     {
+        const CallbackTable &global_table = glob_callback_tables[TCallback::CTYPEID];
+        const ManagementAPIBlock block;
+
         // prioritize callbacks that are attached to the device
-        ExecuteCallbacks_Impl<TCallback, TData...>(ConstructEventCallbackKey<TCallback, TValueFilter>(p_device->GetID(), value_filter), p_device, data...);
-        ExecuteCallbacks_Impl<TCallback, TData...>(ConstructEventCallbackKey<TCallback, TValueFilter>({0}, value_filter), p_device, data...);
+        size_t num = device_table.InvokeFiltered<TCallback, TData...>(filter, p_device, data...);
+        num += global_table.InvokeFiltered<TCallback, TData...>(filter, p_device, data...);
+        num += device_table.InvokeUnfiltered<TCallback, TData...>(p_device, data...);
+        num += global_table.InvokeUnfiltered<TCallback, TData...>(p_device, data...);
+        CountInvokedCallbacks<TCallback>(p_device, num, event_timestamp);
     }
 
 
-    // execute global and device-specific callbacks
+    // invoke device-specific and global callbacks
     template <typename TCallback, typename... TData>
-    inline void ExecuteCallbacks(const typename TCallback::DevT *const p_device, const TData... data)
+    inline void InvokeCallbacks(const CallbackTable &device_table, const typename TCallback::DevT *const p_device, const timestamp_t event_timestamp, const TData... data)
     {
+        const CallbackTable &global_table = glob_callback_tables[TCallback::CTYPEID];
+        const ManagementAPIBlock block;
+
         // prioritize callbacks that are attached to the device
-        ExecuteCallbacks_Impl<TCallback, TData...>(ConstructEventCallbackKey<TCallback>(p_device->GetID()), p_device, data...);
-        ExecuteCallbacks_Impl<TCallback, TData...>(ConstructEventCallbackKey<TCallback>({0}), p_device, data...);
+        size_t num = device_table.InvokeUnfiltered<TCallback, TData...>(p_device, data...);
+        num += global_table.InvokeUnfiltered<TCallback, TData...>(p_device, data...);
+        CountInvokedCallbacks<TCallback>(p_device, num, event_timestamp);
     }
 
 
-    inline void DeviceStatusChanged(const IDevice *const p_device, const DeviceStatusChange status)
+    template <typename TCallback, bool FILTERED, typename... TData>
+    void DispatchPendingCallback(const PendingCallback &pc)
     {
-        // prioritize callbacks with a filter
-        ExecuteCallbacksWithFilter<impl::_StatusCallback>(p_device, status, status);
-        ExecuteCallbacks<impl::_StatusCallback>(p_device, status);
+        const auto *const p_device = static_cast<const typename TCallback::DevT *>(pc.p_device);
+        const auto &data = *std::launder(reinterpret_cast<const std::tuple<TData...> *>(pc.data));
+        std::apply([&pc, p_device](const TData... args)
+        {
+            if constexpr (FILTERED) { InvokeCallbacksWithFilter<TCallback, TData...>(*pc.p_device_table, p_device, pc.filter, pc.event_timestamp, args...); }
+            else { InvokeCallbacks<TCallback, TData...>(*pc.p_device_table, p_device, pc.event_timestamp, args...); }
+        }, data);
+    }
+
+
+    template <typename TCallback, bool FILTERED, typename... TData>
+    inline void QueueCallbacks(const CallbackTable &device_table, const typename TCallback::DevT *const p_device, const callback_filter_t filter, const TData... data)
+    {
+        using data_tuple = std::tuple<TData...>;
+        static_assert(sizeof(data_tuple) <= PendingCallback::MAX_DATA_SIZE && alignof(data_tuple) <= alignof(int64_t));
+        static_assert(std::is_trivially_destructible_v<data_tuple>);
+
+        PendingCallback &pc = glob_pending_callbacks.emplace_back();
+        pc.p_dispatch = &DispatchPendingCallback<TCallback, FILTERED, TData...>;
+        pc.p_device_table = &device_table;
+        pc.p_device = p_device;
+        pc.filter = filter;
+        #ifdef CROSSPUT_FEATURE_STATS
+        const BaseInterface *const p_interface = glob_devices.Find(p_device->GetID());
+        pc.event_timestamp = (p_interface != nullptr) ? p_interface->LastEventTimestamp() : 0;
+        #else
+        pc.event_timestamp = 0;
+        #endif // CROSSPUT_FEATURE_STATS
+        new (pc.data) data_tuple(data...);
+    }
+
+
+    // status callbacks are never deferred, they concern the lifetime of devices
+    template <typename TCallback>
+    constexpr bool IsDeferrable() noexcept { return TCallback::CTYPEID != impl::_StatusCallback::CTYPEID; }
+
+
+    // execute (or queue) device-specific and global callbacks, filtered before unfiltered
+    template <typename TCallback, EvcbFilterType TValueFilter, typename... TData>
+    inline void ExecuteCallbacksWithFilter(const CallbackTable &device_table, const typename TCallback::DevT *const p_device, const TValueFilter value_filter, const TData... data)
+    {
+        if (device_table.IsEmpty() & glob_callback_tables[TCallback::CTYPEID].IsEmpty()) [[likely]] { return; } // no short-circuit, single branch
+
+        const callback_filter_t filter = static_cast<callback_filter_t>(value_filter);
+        if (IsDeferrable<TCallback>() && glob_callback_delivery == CallbackDelivery::DEFERRED)
+        {
+            QueueCallbacks<TCallback, true, TData...>(device_table, p_device, filter, data...);
+        }
+        else
+        {
+            InvokeCallbacksWithFilter<TCallback, TData...>(device_table, p_device, filter, 0, data...);
+        }
+    }
+
+
+    // execute (or queue) device-specific and global callbacks
+    template <typename TCallback, typename... TData>
+    inline void ExecuteCallbacks(const CallbackTable &device_table, const typename TCallback::DevT *const p_device, const TData... data)
+    {
+        if (device_table.IsEmpty() & glob_callback_tables[TCallback::CTYPEID].IsEmpty()) [[likely]] { return; } // no short-circuit, single branch
+
+        if (IsDeferrable<TCallback>() && glob_callback_delivery == CallbackDelivery::DEFERRED)
+        {
+            QueueCallbacks<TCallback, false, TData...>(device_table, p_device, 0, data...);
+        }
+        else
+        {
+            InvokeCallbacks<TCallback, TData...>(device_table, p_device, 0, data...);
+        }
     }
 
 
     // implements:
     // IDevice::RegisterStatusCallback(...)
     // and provides basic callback management
-    class DeviceCallbackManagerImpl : public virtual IDevice
+    class DeviceCallbackManagerImpl : public virtual BaseInterface
     {
+        friend void DeviceStatusChanged(const IDevice *const p_device, const DeviceStatusChange status);
+
     protected:
         std::vector<ID> attached_callbacks_;
+        CallbackTable callback_tables_[NUM_CALLBACK_TYPES];
 
     public:
         ID RegisterStatusCallback(const StatusCallback &&callback) override final
@@ -502,6 +1419,20 @@ namespace crossput
             {
                 EraseCallback(cbid);
             }
+
+            // discard queued changes of this device
+            if (!glob_pending_callbacks.empty())
+            {
+                const std::less<const CallbackTable *> less;
+                std::erase_if(glob_pending_callbacks, [this, &less](const PendingCallback &pc)
+                {
+                    return !less(pc.p_device_table, callback_tables_) && less(pc.p_device_table, callback_tables_ + NUM_CALLBACK_TYPES);
+                });
+            }
+
+            #ifdef CROSSPUT_COROUTINES
+            if (glob_ready_waiters.p_head != nullptr || glob_ready_status_waiters.p_head != nullptr) { OrphanReadyWaiters(this); }
+            #endif // CROSSPUT_COROUTINES
         }
 
     protected:
@@ -513,7 +1444,7 @@ namespace crossput
         template <typename TCallback>
         inline ID AttachCallback(const typename TCallback::FuncT &&callback)
         {
-            const ID cbid = InsertCallback<TCallback>(std::move(callback), GetID());
+            const ID cbid = InsertCallback<TCallback>(std::move(callback), callback_tables_[TCallback::CTYPEID]);
             attached_callbacks_.push_back(cbid);
             return cbid;
         }
@@ -521,20 +1452,44 @@ namespace crossput
         template <typename TCallback, EvcbFilterType TValueFilter>
         inline ID AttachCallback(const typename TCallback::FuncT &&callback, const TValueFilter value_filter)
         {
-            const ID cbid = InsertCallback<TCallback>(std::move(callback), GetID(), value_filter);
+            const ID cbid = InsertCallback<TCallback>(std::move(callback), callback_tables_[TCallback::CTYPEID], value_filter);
             attached_callbacks_.push_back(cbid);
             return cbid;
         }
+
+        template <typename TCallback>
+        constexpr const CallbackTable &GetCallbackTable() const noexcept { return callback_tables_[TCallback::CTYPEID]; }
     };
 
 
+    inline void DeviceStatusChanged(const IDevice *const p_device, const DeviceStatusChange status)
+    {
+        MarkStatusChanged(p_device);
+        if (glob_p_capture != nullptr) [[unlikely]] { CaptureStatus(p_device, status); }
+
+        // status changes are rare, so the cross-cast is acceptable
+        const DeviceCallbackManagerImpl *const p_manager = dynamic_cast<const DeviceCallbackManagerImpl *>(p_device);
+        ExecuteCallbacksWithFilter<impl::_StatusCallback>(p_manager->GetCallbackTable<impl::_StatusCallback>(), p_device, status, status);
+        NotifyWaiters<impl::_StatusCallback>(p_device, static_cast<uint32_t>(status), 0.0F, true);
+    }
+
+
     // implements:
     // IMouse::RegisterMoveCallback(...)
     // IMouse::RegisterScrollCallback(...)
     // IMouse::RegisterButtonCallback(...)
+    // IMouse::GetChangedButtons(...)
     class MouseCallbackManagerImpl : public virtual DeviceCallbackManagerImpl, public virtual IMouse
     {
+    private:
+        ChangeGenerations<MAX_TRACKED_MOUSE_BUTTONS> button_generations_;
+
     public:
+        void GetChangedButtons(const uint64_t since_generation, uint64_t *const changed, const size_t num_words) const override final
+        {
+            button_generations_.Collect(since_generation, changed, num_words);
+        }
+
         ID RegisterMoveCallback(const MouseMoveCallback &&callback) override final
         {
             ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
@@ -562,30 +1517,43 @@ namespace crossput
         virtual ~MouseCallbackManagerImpl() = default;
 
     protected:
-        inline void MouseMoved(const int64_t x, const int64_t y, const int64_t dx, const int64_t dy)
+        inline void MouseMoved(const int64_t x, const int64_t y, const int64_t dx, const int64_t dy, const timestamp_t timestamp)
         {
-            ExecuteCallbacks<impl::_MouseMoveCallback>(this, x, y, dx, dy);
+            RecordDeltaEvent(InputEventType::MOUSE_MOVE, dx, dy, timestamp);
+            ExecuteCallbacks<impl::_MouseMoveCallback>(GetCallbackTable<impl::_MouseMoveCallback>(), this, x, y, dx, dy);
         }
 
-        inline void MouseScrolled(const int64_t x, const int64_t y, const int64_t dx, const int64_t dy)
+        inline void MouseScrolled(const int64_t x, const int64_t y, const int64_t dx, const int64_t dy, const timestamp_t timestamp)
         {
-            ExecuteCallbacks<impl::_MouseScrollCallback>(this, x, y, dx, dy);
+            RecordDeltaEvent(InputEventType::MOUSE_SCROLL, dx, dy, timestamp);
+            ExecuteCallbacks<impl::_MouseScrollCallback>(GetCallbackTable<impl::_MouseScrollCallback>(), this, x, y, dx, dy);
         }
 
-        inline void ButtonChanged(const uint32_t index, const float value, const bool state)
+        inline void ButtonChanged(const uint32_t index, const float value, const bool state, const timestamp_t timestamp)
         {
-            // prioritize callbacks with a filter
-            ExecuteCallbacksWithFilter<impl::_MouseButtonCallback>(this, index, index, value, state);
-            ExecuteCallbacks<impl::_MouseButtonCallback>(this, index, value, state);
+            RecordValueEvent(InputEventType::MOUSE_BUTTON, static_cast<uint16_t>(index), value, state, timestamp);
+            button_generations_.Mark(index, generation_);
+
+            ExecuteCallbacksWithFilter<impl::_MouseButtonCallback>(GetCallbackTable<impl::_MouseButtonCallback>(), this, index, index, value, state);
+            NotifyWaiters<impl::_MouseButtonCallback>(this, index, value, state);
         }
     };
 
 
     // implements:
     // IKeyboard::RegisterKeyCallback(...)
+    // IKeyboard::GetChangedKeys(...)
     class KeyboardCallbackManagerImpl : public virtual DeviceCallbackManagerImpl, public virtual IKeyboard
     {
+    private:
+        ChangeGenerations<NUM_KEY_CODES> key_generations_;
+
     public:
+        void GetChangedKeys(const uint64_t since_generation, uint64_t *const changed) const override final
+        {
+            key_generations_.Collect(since_generation, changed, NUM_KEY_STATE_WORDS);
+        }
+
         ID RegisterKeyCallback(const KeyboardKeyCallback &&callback) override final
         {
             ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
@@ -601,11 +1569,13 @@ namespace crossput
         virtual ~KeyboardCallbackManagerImpl() = default;
 
     protected:
-        inline void KeyChanged(const Key key, const float value, const bool state)
+        inline void KeyChanged(const Key key, const float value, const bool state, const timestamp_t timestamp)
         {
-            // prioritize callbacks with a filter
-            ExecuteCallbacksWithFilter<impl::_KeyboardKeyCallback>(this, key, key, value, state);
-            ExecuteCallbacks<impl::_KeyboardKeyCallback>(this, key, value, state);
+            RecordValueEvent(InputEventType::KEYBOARD_KEY, static_cast<uint16_t>(key), value, state, timestamp);
+            key_generations_.Mark(static_cast<size_t>(key), generation_);
+
+            ExecuteCallbacksWithFilter<impl::_KeyboardKeyCallback>(GetCallbackTable<impl::_KeyboardKeyCallback>(), this, key, key, value, state);
+            NotifyWaiters<impl::_KeyboardKeyCallback>(this, static_cast<uint32_t>(key), value, state);
         }
     };
 
@@ -613,9 +1583,18 @@ namespace crossput
     // implements:
     // IGamepad::RegisterButtonCallback(...)
     // IGamepad::RegisterThumbstickCallback(...)
+    // IGamepad::GetChangedButtons(...)
     class GamepadCallbackManagerImpl : public virtual DeviceCallbackManagerImpl, public virtual IGamepad
     {
+    private:
+        ChangeGenerations<NUM_BUTTON_CODES> button_generations_;
+
     public:
+        void GetChangedButtons(const uint64_t since_generation, uint64_t *const changed) const override final
+        {
+            button_generations_.Collect(since_generation, changed, NUM_BUTTON_STATE_WORDS);
+        }
+
         ID RegisterButtonCallback(const GamepadButtonCallback &&callback) override final
         {
             ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
@@ -643,18 +1622,20 @@ namespace crossput
         virtual ~GamepadCallbackManagerImpl() = default;
 
     protected:
-        inline void ButtonChanged(const Button button, const float value, const bool state)
+        inline void ButtonChanged(const Button button, const float value, const bool state, const timestamp_t timestamp)
         {
-            // prioritize callbacks with a filter
-            ExecuteCallbacksWithFilter<impl::_GamepadButtonCallback>(this, button, button, value, state);
-            ExecuteCallbacks<impl::_GamepadButtonCallback>(this, button, value, state);
+            RecordValueEvent(InputEventType::GAMEPAD_BUTTON, static_cast<uint16_t>(button), value, state, timestamp);
+            button_generations_.Mark(static_cast<size_t>(button), generation_);
+
+            ExecuteCallbacksWithFilter<impl::_GamepadButtonCallback>(GetCallbackTable<impl::_GamepadButtonCallback>(), this, button, button, value, state);
+            NotifyWaiters<impl::_GamepadButtonCallback>(this, static_cast<uint32_t>(button), value, state);
         }
 
-        inline void ThumbstickChanged(const uint32_t index, const float x, const float y)
+        inline void ThumbstickChanged(const uint32_t index, const float x, const float y, const timestamp_t timestamp)
         {
-            // prioritize callbacks with a filter
-            ExecuteCallbacksWithFilter<impl::_GamepadThumbstickCallback>(this, index, index, x, y);
-            ExecuteCallbacks<impl::_GamepadThumbstickCallback>(this, index, x, y);
+            RecordAxesEvent(InputEventType::GAMEPAD_THUMBSTICK, static_cast<uint16_t>(index), x, y, timestamp);
+
+            ExecuteCallbacksWithFilter<impl::_GamepadThumbstickCallback>(GetCallbackTable<impl::_GamepadThumbstickCallback>(), this, index, index, x, y);
         }
     };
 }
@@ -664,13 +1645,90 @@ namespace crossput
 
 namespace crossput
 {
-    class DeviceCallbackManager {};
-    class MouseCallbackManager {};
-    class KeyboardCallbackManager {};
-    class GamepadCallbackManager {};
+    // without callbacks, changes of input are only recorded in the event history
+
+    class DeviceCallbackManager : public virtual BaseInterface {};
+
+    class MouseCallbackManager : public virtual DeviceCallbackManager, public virtual IMouse
+    {
+    private:
+        ChangeGenerations<MAX_TRACKED_MOUSE_BUTTONS> button_generations_;
+
+    public:
+        void GetChangedButtons(const uint64_t since_generation, uint64_t *const changed, const size_t num_words) const override final
+        {
+            button_generations_.Collect(since_generation, changed, num_words);
+        }
+
+    protected:
+        inline void MouseMoved(const int64_t, const int64_t, const int64_t dx, const int64_t dy, const timestamp_t timestamp) noexcept
+        {
+            RecordDeltaEvent(InputEventType::MOUSE_MOVE, dx, dy, timestamp);
+        }
+
+        inline void MouseScrolled(const int64_t, const int64_t, const int64_t dx, const int64_t dy, const timestamp_t timestamp) noexcept
+        {
+            RecordDeltaEvent(InputEventType::MOUSE_SCROLL, dx, dy, timestamp);
+        }
+
+        inline void ButtonChanged(const uint32_t index, const float value, const bool state, const timestamp_t timestamp) noexcept
+        {
+            RecordValueEvent(InputEventType::MOUSE_BUTTON, static_cast<uint16_t>(index), value, state, timestamp);
+            button_generations_.Mark(index, generation_);
+        }
+    };
+
+    class KeyboardCallbackManager : public virtual DeviceCallbackManager, public virtual IKeyboard
+    {
+    private:
+        ChangeGenerations<NUM_KEY_CODES> key_generations_;
+
+    public:
+        void GetChangedKeys(const uint64_t since_generation, uint64_t *const changed) const override final
+        {
+            key_generations_.Collect(since_generation, changed, NUM_KEY_STATE_WORDS);
+        }
+
+    protected:
+        inline void KeyChanged(const Key key, const float value, const bool state, const timestamp_t timestamp) noexcept
+        {
+            RecordValueEvent(InputEventType::KEYBOARD_KEY, static_cast<uint16_t>(key), value, state, timestamp);
+            key_generations_.Mark(static_cast<size_t>(key), generation_);
+        }
+    };
+
+    class GamepadCallbackManager : public virtual DeviceCallbackManager, public virtual IGamepad
+    {
+    private:
+        ChangeGenerations<NUM_BUTTON_CODES> button_generations_;
+
+    public:
+        void GetChangedButtons(const uint64_t since_generation, uint64_t *const changed) const override final
+        {
+            button_generations_.Collect(since_generation, changed, NUM_BUTTON_STATE_WORDS);
+        }
+
+    protected:
+        inline void ButtonChanged(const Button button, const float value, const bool state, const timestamp_t timestamp) noexcept
+        {
+            RecordValueEvent(InputEventType::GAMEPAD_BUTTON, static_cast<uint16_t>(button), value, state, timestamp);
+            button_generations_.Mark(static_cast<size_t>(button), generation_);
+        }
+
+        inline void ThumbstickChanged(const uint32_t index, const float x, const float y, const timestamp_t timestamp) noexcept
+        {
+            RecordAxesEvent(InputEventType::GAMEPAD_THUMBSTICK, static_cast<uint16_t>(index), x, y, timestamp);
+        }
+    };
+
+    inline void DeviceStatusChanged(const IDevice *const p_device, const DeviceStatusChange status) noexcept
+    {
+        MarkStatusChanged(p_device);
+        if (glob_p_capture != nullptr) [[unlikely]] { CaptureStatus(p_device, status); }
+    }
 
-    constexpr void ProtectManagementAPI(const char *const details_str) noexcept {}
-    constexpr void ProtectManagementAPI(const std::string details_str) noexcept {}
+    constexpr void ProtectManagementAPI([[maybe_unused]] const char *const details_str) noexcept {}
+    constexpr void ProtectManagementAPI([[maybe_unused]] const char *const details_str, [[maybe_unused]] const ID device_id) noexcept {}
 }
 
 #endif // CROSSPUT_FEATURE_CALLBACK
@@ -707,7 +1765,7 @@ namespace crossput
     // IForce::GetMotorIndex()
     // IForce::Params()
     template <typename TDevice>
-    class BaseForce : public virtual IForce
+    class BaseForce : public virtual IForce, public MemoryManaged
     {
         friend DeviceForceManagerImpl<TDevice>;
 
@@ -718,6 +1776,8 @@ namespace crossput
         const bool is_condition_effect_;
         TDevice *p_device_;
         ForceParams params_ = {};
+        ForceParams written_params_ = {}; // parameters of the most recent successful upload
+        bool is_written_ = false;
 
     public:
         BaseForce(TDevice *const p_device, const uint32_t motor_index, const ForceType type) :
@@ -737,7 +1797,54 @@ namespace crossput
         constexpr uint32_t GetMotorIndex() const override final { return motor_index_; }
         constexpr ForceParams &Params() noexcept override final { return params_; }
 
+        // true if the parameters were modified since they were last uploaded
+        inline bool IsDirty() const noexcept { return !is_written_ || std::memcmp(&params_, &written_params_, sizeof(ForceParams)) != 0; }
+
         virtual ~BaseForce() = default;
+
+    protected:
+        inline void MarkWritten() noexcept
+        {
+            std::memcpy(&written_params_, &params_, sizeof(ForceParams));
+            is_written_ = true;
+        }
+    };
+
+
+    // FORCE STREAMING
+
+    struct ForceStreamUpdate
+    {
+        ID force_id;
+        ForceParams params;
+    };
+
+
+    // owns the worker thread of a force stream, which uploads the newest queued parameters of each force at a fixed rate
+    // (the device mutex is held while uploading, the management thread holds it while creating, destroying, or orphaning forces)
+    class ForceStream final : public IForceStream
+    {
+    private:
+        IDevice *const p_device_;
+        std::mutex &force_mutex_;
+        SpscQueue<ForceStreamUpdate, QUEUE_CAPACITY> queue_;
+        std::vector<ForceStreamUpdate> coalesced_; // only accessed by the worker
+        std::atomic<uint64_t> upload_count_ = 0;
+        std::atomic<bool> stop_ = false;
+        std::thread worker_; // started last
+
+    public:
+        ForceStream(IDevice *const p_device, std::mutex &force_mutex, const float interval);
+        ForceStream(const ForceStream &) = delete;
+        ForceStream &operator=(const ForceStream &) = delete;
+        ~ForceStream();
+
+        ID GetDeviceID() const noexcept override { return p_device_->GetID(); }
+        bool Push(const ID force_id, const ForceParams &params) override { return queue_.TryPush({force_id, params}); }
+        uint64_t GetUploadCount() const noexcept override { return upload_count_.load(std::memory_order_relaxed); }
+
+    private:
+        void WorkerMain(const std::chrono::steady_clock::duration interval);
     };
 
 
@@ -745,12 +1852,17 @@ namespace crossput
     // IDevice::TryGetForce(...)
     // IDevice::DestroyForce(...)
     // IDevice::DestroyAllForces()
+    // IDevice::CommitForces()
+    // IDevice::TryStartForceStream(...)
+    // IDevice::StopForceStream()
     // and provides basic force management
     template <typename TDevice>
     class DeviceForceManagerImpl : public virtual IDevice
     {
     protected:
-        std::unordered_map<ID, BaseForce<TDevice> *> forces_;
+        ManagedMap<ID, BaseForce<TDevice> *> forces_;
+        std::mutex force_mutex_; // synchronizes changes of forces_ and orphaning of forces with the force stream
+        std::unique_ptr<ForceStream> force_stream_;
 
     public:
         bool TryGetForce(const ID id, IForce *&p_force) const override final
@@ -763,6 +1875,7 @@ namespace crossput
 
         void DestroyForce(const ID id) override final
         {
+            const std::lock_guard<std::mutex> lock(force_mutex_);
             const auto it = forces_.find(id);
             if (it != forces_.end())
             {
@@ -773,6 +1886,7 @@ namespace crossput
 
         void DestroyAllForces() override final
         {
+            const std::lock_guard<std::mutex> lock(force_mutex_);
             for (const auto f : forces_)
             {
                 delete f.second;
@@ -781,8 +1895,31 @@ namespace crossput
             forces_.clear();
         }
 
+        void CommitForces() override final
+        {
+            for (const auto &[id, p_force] : forces_)
+            {
+                if (p_force->IsDirty()) { (void)p_force->WriteParams(); }
+            }
+        }
+
+        bool TryStartForceStream(const float interval, IForceStream *&p_stream) override final
+        {
+            ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+            if (force_stream_ == nullptr) { force_stream_ = std::make_unique<ForceStream>(this, force_mutex_, interval); }
+            p_stream = force_stream_.get();
+            return true;
+        }
+
+        void StopForceStream() override final
+        {
+            ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+            force_stream_.reset();
+        }
+
         virtual ~DeviceForceManagerImpl()
         {
+            force_stream_.reset(); // already joined by the device, see JoinForceStream()
             for (const auto f : forces_)
             {
                 delete f.second;
@@ -795,8 +1932,21 @@ namespace crossput
             forces_.reserve(16);
         }
 
+        // must be invoked first by the destructor of the concrete device, otherwise the worker may access parts of it which were already destroyed
+        inline void JoinForceStream() noexcept
+        {
+            force_stream_.reset();
+        }
+
+        inline void InsertForce(BaseForce<TDevice> *const p_force)
+        {
+            const std::lock_guard<std::mutex> lock(force_mutex_);
+            forces_.insert({p_force->GetID(), p_force});
+        }
+
         inline void OrphanAllForces()
         {
+            const std::lock_guard<std::mutex> lock(force_mutex_);
             for (const auto f : forces_)
             {
                 f.second->p_device_ = nullptr;
@@ -816,6 +1966,15 @@ namespace crossput
         constexpr bool SupportsForce([[maybe_unused]] const uint32_t motor_index, [[maybe_unused]] const ForceType type) const override final { return false; }
         constexpr bool TryGetForce([[maybe_unused]] const ID id, [[maybe_unused]] IForce *&p_force) const override final { return false; }
         constexpr void DestroyForce([[maybe_unused]] const ID id) override final {}
+        constexpr void DestroyAllForces() override final {}
+        constexpr void CommitForces() override final {}
+        constexpr void StopForceStream() override final {}
+
+        constexpr bool TryStartForceStream([[maybe_unused]] const float interval, IForceStream *&p_stream) override final
+        {
+            p_stream = nullptr;
+            return false;
+        }
 
         constexpr bool TryCreateForce(
             [[maybe_unused]] const uint32_t motor_index,
@@ -847,13 +2006,14 @@ namespace crossput
 namespace crossput
 {
     // mapping between devices and aggregates they are a member of
-    extern std::unordered_multimap<ID, ID> glob_dev_to_aggr;
+    extern ManagedMultimap<ID, ID> glob_dev_to_aggr;
 
 
     inline void LinkAggregate(const ID aggregate, const ID other)
     {
         // link aggregate with other device
         glob_dev_to_aggr.insert({other, aggregate});
+        if (BaseInterface *const p_other = glob_devices.Find(other); p_other != nullptr) { p_other->AddAggregateLink(); }
     }
 
 
@@ -863,7 +2023,15 @@ namespace crossput
         auto [it, end] = glob_dev_to_aggr.equal_range(other);
         if (it != glob_dev_to_aggr.end())
         {
-            do { if (it->second == aggregate) { glob_dev_to_aggr.erase(it); break; } }
+            do
+            {
+                if (it->second == aggregate)
+                {
+                    glob_dev_to_aggr.erase(it);
+                    if (BaseInterface *const p_other = glob_devices.Find(other); p_other != nullptr) { p_other->RemoveAggregateLink(); }
+                    break;
+                }
+            }
             while (++it != end);
         }
     }
@@ -881,15 +2049,12 @@ namespace crossput
             {
                 if (!glob_dev_to_aggr.contains(id))
                 {
-                    const auto kv_linked = glob_interfaces.find(id);
-                    if (kv_linked == glob_interfaces.end()) [[unlikely]] { continue; } // failsafe
+                    BaseInterface *const p_linked = glob_devices.Find(id);
+                    if (p_linked == nullptr) [[unlikely]] { continue; } // failsafe
 
-                    #ifdef CROSSPUT_FEATURE_CALLBACK
-                    DeviceStatusChanged(kv_linked->second, DeviceStatusChange::DESTROYED);
-                    #endif // CROSSPUT_FEATURE_CALLBACK
+                    DeviceStatusChanged(p_linked, DeviceStatusChange::DESTROYED);
 
-                    delete kv_linked->second;
-                    glob_interfaces.erase(kv_linked);
+                    delete p_linked; // unregisters itself
                 }
                 else
                 {
@@ -910,12 +2075,6 @@ namespace crossput
     }
 
 
-    inline timestamp_t GenericTimestampNow() noexcept
-    {
-        return static_cast<timestamp_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count());
-    }
-
-
     // implements:
     // IDevice::IsAggregate()
     // IDevice::GetDisplayName()
@@ -929,23 +2088,29 @@ namespace crossput
     protected:
         const std::unique_ptr<TDevice *[]> members_;
         const size_t member_count_;
+        std::unique_ptr<const BaseInterface *[]> member_interfaces_;
+        std::unique_ptr<uint64_t[]> member_generations_; // input generation of each member when it was last merged
         timestamp_t last_update_timestamp_ = 0;
         #ifdef CROSSPUT_FEATURE_FORCE
-        std::unordered_map<ID, TDevice *> force_to_member_;
+        ManagedMap<ID, TDevice *> force_to_member_;
         std::vector<std::pair<TDevice *, uint32_t>> motor_to_member_;
         #endif // CROSSPUT_FEATURE_FORCE
 
     public:
         AggregateImpl(std::unique_ptr<TDevice *[]> &&members, const size_t member_count) :
             members_(std::move(members)),
-            member_count_(member_count)
+            member_count_(member_count),
+            member_interfaces_(std::make_unique<const BaseInterface *[]>(member_count)),
+            member_generations_(std::make_unique<uint64_t[]>(member_count))
         {
             assert(member_count > 0);
 
             // create association between aggregate and members
             for (size_t i = 0; i < member_count; i++)
             {
-                LinkAggregate(id_, members[i]->GetID());
+                LinkAggregate(id_, members_[i]->GetID());
+                member_interfaces_[i] = glob_devices.Find(members_[i]->GetID());
+                assert(member_interfaces_[i] != nullptr);
             }
         }
 
@@ -965,9 +2130,15 @@ namespace crossput
             return name.str();
         }
 
+        void SetReadBatchSize(const uint32_t size) override final
+        {
+            BaseInterface::SetReadBatchSize(size);
+            for (size_t i = 0; i < member_count_; i++) { members_[i]->SetReadBatchSize(size); }
+        }
+
         virtual void Update() override
         {
-            ProtectManagementAPI(std::format("crossput::IDevice::Update() - Device ID {}", id_));
+            ProtectManagementAPI("crossput::IDevice::Update()", id_);
 
             bool connected = true;
             for (size_t i = 0; i < member_count_; i++)
@@ -983,7 +2154,23 @@ namespace crossput
             if (connected != is_connected_)
             {
                 is_connected_ = connected;
-                if (!connected) // -> disconnected
+                if (connected) // -> connected
+                {
+                    // capabilities of members can only change while they are disconnected
+                    #ifdef CROSSPUT_FEATURE_FORCE
+                    motor_to_member_.clear();
+                    for (size_t i = 0; i < member_count_; i++)
+                    {
+                        const uint32_t c = members_[i]->GetMotorCount();
+                        for (uint32_t j = 0; j < c; j++) { motor_to_member_.push_back({members_[i], j}); }
+                    }
+                    #endif // CROSSPUT_FEATURE_FORCE
+
+                    // merge all members during the first update
+                    std::fill_n(member_generations_.get(), member_count_, std::numeric_limits<uint64_t>::max());
+                    OnConnected();
+                }
+                else // -> disconnected
                 {
                     last_update_timestamp_ = 0;
                     #ifdef CROSSPUT_FEATURE_FORCE
@@ -994,20 +2181,7 @@ namespace crossput
                 }
             }
 
-            if (connected)
-            {
-                #ifdef CROSSPUT_FEATURE_FORCE
-                // update motor mapping
-                motor_to_member_.clear();
-                for (size_t i = 0; i < member_count_; i++)
-                {
-                    const uint32_t c = members_[i]->GetMotorCount();
-                    for (uint32_t j = 0; j < c; j++) { motor_to_member_.push_back({members_[i], j}); }
-                }
-                #endif // CROSSPUT_FEATURE_FORCE
-
-                last_update_timestamp_ = GenericTimestampNow();
-            }
+            if (connected) { last_update_timestamp_ = NowTimestamp(); }
         }
 
         #ifdef CROSSPUT_FEATURE_FORCE
@@ -1080,6 +2254,20 @@ namespace crossput
             for (auto &[id, p_member] : force_to_member_) { p_member->DestroyForce(id); }
             force_to_member_.clear();
         }
+
+        void CommitForces() override final
+        {
+            for (size_t i = 0; i < member_count_; i++) { members_[i]->CommitForces(); }
+        }
+
+        // members are driven by different locks, so aggregates cannot stream
+        bool TryStartForceStream([[maybe_unused]] const float interval, IForceStream *&p_stream) override final
+        {
+            p_stream = nullptr;
+            return false;
+        }
+
+        void StopForceStream() override final {}
         #endif // CROSSPUT_FEATURE_FORCE
 
         virtual ~AggregateImpl()
@@ -1092,6 +2280,16 @@ namespace crossput
         }
 
     protected:
+        // returns true if a member produced input since it was last merged
+        inline bool ConsumeMemberChange(const size_t index) noexcept
+        {
+            const uint64_t generation = member_interfaces_[index]->GetGeneration();
+            const bool changed = generation != member_generations_[index];
+            member_generations_[index] = generation;
+            return changed;
+        }
+
+        virtual void OnConnected() {}
         virtual void OnDisconnected() = 0;
     };
 
@@ -1112,18 +2310,22 @@ namespace crossput
             bool is_available;
         };
 
+    public:
+        static constexpr uint32_t MAX_BUTTONS = 32; // additional buttons of members are ignored
+
     private:
         MouseData data_ = {};
         std::unique_ptr<MouseAccu[]> prev_data_;
-        std::vector<TSTV> button_data_;
+        std::unique_ptr<float[]> member_values_; // button values of each member (MAX_BUTTONS per member)
+        StateArray<MAX_BUTTONS> button_data_ = {};
         uint32_t button_count_ = 0;
 
     public:
         AggregateMouse(std::unique_ptr<IMouse *[]> &&members, const size_t member_count) :
-            AggregateImpl<IMouse>(std::move(members), member_count)
-        {
-            prev_data_ = std::make_unique<MouseAccu[]>(member_count);
-        }
+            AggregateImpl<IMouse>(std::move(members), member_count),
+            prev_data_(std::make_unique<MouseAccu[]>(member_count)),
+            member_values_(std::make_unique<float[]>(member_count * MAX_BUTTONS))
+            {}
 
         void Update() override;
 
@@ -1137,8 +2339,13 @@ namespace crossput
         float GetButtonThreshold(const uint32_t index) const override;
         float GetButtonValue(const uint32_t index) const override;
         bool GetButtonState(const uint32_t index, float &time) const override;
+        StateView GetButtonView() const override { return button_data_.View(is_connected_); }
+        void GetButtonStates(uint64_t *const states, const size_t num_words) const override;
+        uint32_t GetButtonValues(float *const values, const uint32_t max_count) const override;
+        uint32_t GetButtonTimestamps(uint64_t *const timestamps, const uint32_t max_count) const override;
 
     private:
+        void OnConnected() override;
         void OnDisconnected() override;
     };
 
@@ -1150,12 +2357,14 @@ namespace crossput
         public virtual KeyboardCallbackManager
     {
     private:
-        TSTV key_data_[NUM_KEY_CODES] = {};
+        std::unique_ptr<float[]> member_values_; // key values of each member (NUM_KEY_CODES per member)
+        StateArray<NUM_KEY_CODES> key_data_ = {};
         uint32_t num_keys_pressed_ = 0;
 
     public:
         AggregateKeyboard(std::unique_ptr<IKeyboard *[]> &&members, const size_t member_count) :
-            AggregateImpl<IKeyboard>(std::move(members), member_count)
+            AggregateImpl<IKeyboard>(std::move(members), member_count),
+            member_values_(std::make_unique<float[]>(member_count * NUM_KEY_CODES))
             {}
 
         void Update() override;
@@ -1166,6 +2375,10 @@ namespace crossput
         float GetKeyThreshold(const Key key) const override;
         float GetKeyValue(const Key key) const override;
         bool GetKeyState(const Key key, float &time) const override;
+        StateView GetKeyView() const override { return key_data_.View(is_connected_); }
+        void GetKeyStates(uint64_t *const states) const override;
+        void GetKeyValues(float *const values) const override;
+        void GetKeyTimestamps(uint64_t *const timestamps) const override;
 
     private:
         void OnDisconnected() override;
@@ -1176,16 +2389,22 @@ namespace crossput
         public virtual IGamepad,
         public virtual AggregateImpl<IGamepad>,
         public virtual TypedInterface<DeviceType::GAMEPAD>,
-        public virtual GamepadCallbackManager
+        public virtual GamepadCallbackManager,
+        public virtual GamepadProfileManager
     {
     private:
-        TSTV button_data_[NUM_BUTTON_CODES] = {};
+        std::unique_ptr<float[]> member_values_; // button values of each member (NUM_BUTTON_CODES per member)
+        std::unique_ptr<uint32_t[]> thumbstick_offsets_; // index of the first thumbstick of each member
+        StateArray<NUM_BUTTON_CODES> button_data_ = {};
         std::vector<std::pair<float, float>> thumbstick_values_;
         uint32_t thumbstick_count_ = 0;
+        bool thumbsticks_reset_ = false; // report all thumbsticks during the next update
 
     public:
         AggregateGamepad(std::unique_ptr<IGamepad *[]> &&members, const size_t member_count) :
-            AggregateImpl<IGamepad>(std::move(members), member_count)
+            AggregateImpl<IGamepad>(std::move(members), member_count),
+            member_values_(std::make_unique<float[]>(member_count * NUM_BUTTON_CODES)),
+            thumbstick_offsets_(std::make_unique<uint32_t[]>(member_count))
             {}
 
         void Update() override;
@@ -1195,10 +2414,16 @@ namespace crossput
         float GetButtonThreshold(const Button button) const override;
         float GetButtonValue(const Button button) const override;
         bool GetButtonState(const Button button, float &time) const override;
+        StateView GetButtonView() const override { return button_data_.View(is_connected_); }
+        void GetButtonStates(uint64_t *const states) const override;
+        void GetButtonValues(float *const values) const override;
+        void GetButtonTimestamps(uint64_t *const timestamps) const override;
         uint32_t GetThumbstickCount() const override;
         void GetThumbstick(const uint32_t index, float &x, float &y) const override;
+        uint32_t GetThumbsticks(float *const xy, const uint32_t max_count) const override;
 
     private:
+        void OnConnected() override;
         void OnDisconnected() override;
     };
 }
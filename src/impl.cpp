@@ -10,11 +10,14 @@
 
 #include "common.hpp"
 
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <concepts>
 #include <cstring>
+#include <exception>
 #include <numeric>
+#include <thread>
 #include <unordered_set>
 
 
@@ -86,41 +89,235 @@ size_t fnv1a_bytehash(const void *const p_data, const size_t len)
 namespace crossput
 {
     ID::value_type glob_id_counter = 1;
-    std::unordered_map<ID, BaseInterface *> glob_interfaces;
+    uint64_t glob_generation = 0;
+    uint64_t glob_update_tick = 0;
+    DeviceRegistry glob_devices;
 
     #ifdef CROSSPUT_FEATURE_CALLBACK
     bool glob_disable_management_api = false;
-    std::unordered_map<ID, EventCallbackWrapper *> glob_callbacks;
-    std::unordered_multimap<EventCallbackKey, ID> glob_callback_mapping;
+    ManagedMap<ID, CallbackRecord> glob_callbacks;
+    CallbackTable glob_callback_tables[NUM_CALLBACK_TYPES];
+    CallbackDelivery glob_callback_delivery = CallbackDelivery::IMMEDIATE;
+    std::vector<PendingCallback> glob_pending_callbacks;
     #endif // CROSSPUT_FEATURE_CALLBACK
 
     #ifdef CROSSPUT_FEATURE_AGGREGATE
-    std::unordered_multimap<ID, ID> glob_dev_to_aggr;
+    ManagedMultimap<ID, ID> glob_dev_to_aggr;
     #endif // CROSSPUT_FEATURE_AGGREGATE
 
+    #ifdef CROSSPUT_FEATURE_STATS
+    DeviceStats glob_stats = {};
+    #endif // CROSSPUT_FEATURE_STATS
+
+
+    // snapshot of a single device, published via seqlock
+    // (odd sequence -> write in progress, zero -> nothing published yet)
+    struct SnapshotSlot
+    {
+        std::atomic<uint64_t> sequence = 0;
+        DeviceSnapshot data = {};
+        IDevice *p_device = nullptr;
+    };
+
+    // input thread state
+    std::thread glob_input_thread;
+    std::atomic<bool> glob_input_thread_stop = false;
+    std::atomic<bool> glob_input_thread_running = false; // cleared by the thread itself, also when it ends via an exception
+    std::exception_ptr glob_input_thread_exception;
+    std::unordered_map<ID, std::unique_ptr<SnapshotSlot>> glob_snapshots;
+
+
+    // DEVICE REGISTRY
+
+    ID DeviceRegistry::Reserve(BaseInterface *const p_interface)
+    {
+        uint32_t slot;
+        if (free_slots_.size() > 0)
+        {
+            slot = free_slots_.back();
+            free_slots_.pop_back();
+        }
+        else
+        {
+            if (slots_.size() >= SLOT_MASK) [[unlikely]] { throw std::runtime_error("Maximum number of crossput devices exceeded"); }
+
+            slot = static_cast<uint32_t>(slots_.size());
+            slots_.push_back({nullptr, 0, UNREGISTERED, UNREGISTERED, DeviceType::UNKNOWN});
+        }
+
+        Slot &s = slots_[slot];
+        s.p_interface = p_interface;
+        return { DEVICE_ID_BIT | static_cast<ID::value_type>(s.generation) << GENERATION_SHIFT | slot };
+    }
+
+
+    void DeviceRegistry::Register(BaseInterface *const p_interface)
+    {
+        const ID id = p_interface->GetID();
+        const uint32_t slot = static_cast<uint32_t>(id.value & SLOT_MASK);
+        Slot &s = slots_[slot];
+
+        s.index = static_cast<uint32_t>(interfaces_.size());
+        s.type = p_interface->GetType();
+        interfaces_.push_back(p_interface);
+        devices_.push_back(p_interface);
+        interface_slots_.push_back(slot);
+
+        // resolve typed interface once so getters never need to cast
+        switch (s.type)
+        {
+        case DeviceType::MOUSE:
+            s.typed_index = static_cast<uint32_t>(mice_.size());
+            mice_.push_back(dynamic_cast<IMouse *>(p_interface));
+            mouse_slots_.push_back(slot);
+            break;
+
+        case DeviceType::KEYBOARD:
+            s.typed_index = static_cast<uint32_t>(keyboards_.size());
+            keyboards_.push_back(dynamic_cast<IKeyboard *>(p_interface));
+            keyboard_slots_.push_back(slot);
+            break;
+
+        case DeviceType::GAMEPAD:
+            s.typed_index = static_cast<uint32_t>(gamepads_.size());
+            gamepads_.push_back(dynamic_cast<IGamepad *>(p_interface));
+            gamepad_slots_.push_back(slot);
+            break;
+
+        default:
+            s.typed_index = UNREGISTERED;
+            break;
+        }
+    }
+
+
+    void DeviceRegistry::Release(const ID id)
+    {
+        const uint32_t slot = static_cast<uint32_t>(id.value & SLOT_MASK);
+        if ((id.value & DEVICE_ID_BIT) == 0 || slot >= slots_.size()) [[unlikely]] { return; }
+
+        Slot &s = slots_[slot];
+        if (s.generation != static_cast<uint32_t>(id.value >> GENERATION_SHIFT & GENERATION_MASK)) [[unlikely]] { return; }
+
+        if (s.index != UNREGISTERED)
+        {
+            // interfaces_ and devices_ share their slot indices
+            const uint32_t last = static_cast<uint32_t>(interfaces_.size() - 1);
+            if (s.index != last)
+            {
+                interfaces_[s.index] = interfaces_[last];
+                devices_[s.index] = devices_[last];
+                interface_slots_[s.index] = interface_slots_[last];
+                slots_[interface_slots_[s.index]].index = s.index;
+            }
+
+            interfaces_.pop_back();
+            devices_.pop_back();
+            interface_slots_.pop_back();
+
+            switch (s.type)
+            {
+            case DeviceType::MOUSE: SwapRemove(mice_, mouse_slots_, s.typed_index, slots_, &Slot::typed_index); break;
+            case DeviceType::KEYBOARD: SwapRemove(keyboards_, keyboard_slots_, s.typed_index, slots_, &Slot::typed_index); break;
+            case DeviceType::GAMEPAD: SwapRemove(gamepads_, gamepad_slots_, s.typed_index, slots_, &Slot::typed_index); break;
+            default: break;
+            }
+        }
+
+        // invalidate all IDs referring to this slot
+        s.p_interface = nullptr;
+        s.generation = (s.generation + 1) & GENERATION_MASK;
+        s.index = UNREGISTERED;
+        s.typed_index = UNREGISTERED;
+        s.type = DeviceType::UNKNOWN;
+        free_slots_.push_back(slot);
+    }
+
+
+    // BASE INTERFACE
+
+    void BaseInterface::SetEventHistoryCapacity(const uint32_t capacity)
+    {
+        ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+        history_ = capacity != 0 ? std::make_unique<InputEvent[]>(capacity) : nullptr;
+        history_capacity_ = capacity;
+        history_head_ = 0;
+        history_size_ = 0;
+    }
+
+
+    size_t BaseInterface::ReadEvents(const uint64_t since_timestamp, InputEvent *const events, const size_t max_events) const
+    {
+        // count events newer than the timestamp, starting at the newest
+        const size_t limit = std::min(static_cast<size_t>(history_size_), max_events);
+        size_t num = 0;
+        while (num < limit)
+        {
+            const size_t index = (static_cast<size_t>(history_head_) + history_capacity_ - 1 - num) % history_capacity_;
+            if (history_[index].timestamp <= since_timestamp) { break; }
+            num++;
+        }
+
+        if (num == 0) { return 0; }
+
+        // copy from oldest to newest, which may wrap around the end of the ring
+        const size_t start = (static_cast<size_t>(history_head_) + history_capacity_ - num) % history_capacity_;
+        const size_t first = std::min(num, static_cast<size_t>(history_capacity_) - start);
+        std::memcpy(events, &history_[start], first * sizeof(InputEvent));
+        std::memcpy(events + first, &history_[0], (num - first) * sizeof(InputEvent));
+        return num;
+    }
+
+
+    size_t BaseInterface::ReadEvents(const uint64_t since_timestamp, std::vector<InputEvent> &events) const
+    {
+        const size_t offset = events.size();
+        events.resize(offset + history_size_);
+        const size_t num = ReadEvents(since_timestamp, events.data() + offset, history_size_);
+        events.resize(offset + num);
+        return num;
+    }
+
 
     // GLOBAL DEVICE MANAGEMENT
 
+    inline void UpdateScheduled(BaseInterface &interface, const uint64_t tick)
+    {
+        const uint64_t generation = interface.GetGeneration();
+        interface.Update();
+        if (interface.GetUpdatePolicy() == UpdatePolicy::ADAPTIVE) { interface.ScheduleNextUpdate(tick, generation); }
+    }
+
+
     void UpdateAllDevices()
     {
         ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
 
-        #ifdef CROSSPUT_FEATURE_AGGREGATE
-        for (auto &elm : glob_interfaces)
         {
-            // only update devices which are not members of any aggregate to reduce overall Update() calls
-            // (aggregates update their members anyway)
-            if (!glob_dev_to_aggr.contains(elm.second->GetID()))
+            const DeviceUpdateBatch batch;
+            const uint64_t tick = ++glob_update_tick;
+
+            #ifdef CROSSPUT_FEATURE_AGGREGATE
+            for (BaseInterface *const p_interface : glob_devices.Interfaces())
             {
-                elm.second->Update();
+                // only update devices which are not members of any aggregate to reduce overall Update() calls
+                // (aggregates update their members anyway)
+                if (!p_interface->IsAggregateMember() && p_interface->IsUpdateDue(tick))
+                {
+                    UpdateScheduled(*p_interface, tick);
+                }
             }
+            #else
+            for (BaseInterface *const p_interface : glob_devices.Interfaces())
+            {
+                if (p_interface->IsUpdateDue(tick)) { UpdateScheduled(*p_interface, tick); }
+            }
+            #endif // CROSSPUT_FEATURE_AGGREGATE
         }
-        #else
-        for (auto &elm : glob_interfaces)
-        {
-            elm.second->Update();
-        }
-        #endif // CROSSPUT_FEATURE_AGGREGATE
+
+        if (!glob_action_maps.empty()) { EvaluateActionMaps(); }
+        if (glob_p_server != nullptr) [[unlikely]] { PublishServerState(); }
     }
 
 
@@ -128,29 +325,31 @@ namespace crossput
     {
         ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
 
-        if (glob_interfaces.size() == 0) { return; }
-
         #ifdef CROSSPUT_FEATURE_AGGREGATE
-        std::vector<ID> targets;
-        targets.reserve(glob_interfaces.size());
-        for (auto &elm : glob_interfaces) { targets.push_back(elm.second->GetID()); }
+        if (glob_devices.Size() != 0)
+        {
+            std::vector<ID> targets;
+            targets.reserve(glob_devices.Size());
+            for (BaseInterface *const p_interface : glob_devices.Interfaces()) { targets.push_back(p_interface->GetID()); }
 
-        DestroyHierarchy(std::move(targets));
+            DestroyHierarchy(std::move(targets));
 
-        glob_interfaces.clear();
-        glob_dev_to_aggr.clear();
+            glob_dev_to_aggr.clear();
+        }
         #else
-        for (auto &elm : glob_interfaces)
+        while (glob_devices.Size() > 0)
         {
-            #ifdef CROSSPUT_FEATURE_CALLBACK
-            DeviceStatusChanged(elm.second, DeviceStatusChange::DESTROYED);
-            #endif // CROSSPUT_FEATURE_CALLBACK
+            // destroyed interfaces unregister themselves, so always take the last one
+            BaseInterface *const p_interface = glob_devices.Interfaces().back();
 
-            delete elm.second;
-        }
+            DeviceStatusChanged(p_interface, DeviceStatusChange::DESTROYED);
 
-        glob_interfaces.clear();
+            delete p_interface;
+        }
         #endif // CROSSPUT_FEATURE_AGGREGATE
+
+        // usually invoked during shutdown, pools keep a chunk otherwise
+        glob_p_memory->ReleaseIdlePools();
     }
 
 
@@ -158,13 +357,13 @@ namespace crossput
     {
         if (!ignore_disconnected)
         {
-            return glob_interfaces.size();
+            return glob_devices.Size();
         }
 
         size_t num = 0;
-        for (auto &elm : glob_interfaces)
+        for (BaseInterface *const p_interface : glob_devices.Interfaces())
         {
-            if (elm.second->IsConnected()) { num++; }
+            if (p_interface->IsConnected()) { num++; }
         }
         return num;
     }
@@ -172,55 +371,76 @@ namespace crossput
 
     size_t GetDevices(std::vector<IDevice *> &devices, const bool ignore_disconnected)
     {
-        if (!ignore_disconnected)
-        {
-            // shortcut
-            devices.reserve(devices.size() + glob_interfaces.size());
-            for (auto &elm : glob_interfaces) { devices.push_back(dynamic_cast<IDevice *>(elm.second)); }
-            return glob_interfaces.size();
-        }
+        return GetDevicesOfType<IDevice>(devices, glob_devices.Devices(), ignore_disconnected);
+    }
+
+
+    size_t GetMice(std::vector<IMouse *> &mice, const bool ignore_disconnected)
+    {
+        return GetDevicesOfType<IMouse>(mice, glob_devices.Mice(), ignore_disconnected);
+    }
+
 
+    size_t GetKeyboards(std::vector<IKeyboard *> &keyboards, const bool ignore_disconnected)
+    {
+        return GetDevicesOfType<IKeyboard>(keyboards, glob_devices.Keyboards(), ignore_disconnected);
+    }
+
+
+    size_t GetGamepads(std::vector<IGamepad *> &gamepads, const bool ignore_disconnected)
+    {
+        return GetDevicesOfType<IGamepad>(gamepads, glob_devices.Gamepads(), ignore_disconnected);
+    }
+
+
+    uint64_t GetGlobalGeneration()
+    {
+        return glob_generation;
+    }
+
+
+    size_t GetChangedDevices(const uint64_t since_generation, std::vector<IDevice *> &devices)
+    {
         size_t num = 0;
-        for (auto &elm : glob_interfaces)
+        for (BaseInterface *const p_interface : glob_devices.Interfaces())
         {
-            if (elm.second->IsConnected())
+            if (p_interface->GetGeneration() > since_generation)
             {
-                devices.push_back(dynamic_cast<IDevice *>(elm.second));
+                devices.push_back(p_interface);
                 num++;
             }
         }
-
         return num;
     }
 
 
-    size_t GetMice(std::vector<IMouse *> &mice, const bool ignore_disconnected)
+    DeviceSpan<IDevice> GetDeviceSpan()
     {
-        return GetDevicesOfType<IMouse>(mice, DeviceType::MOUSE, ignore_disconnected);
+        return { glob_devices.Devices().data(), glob_devices.Devices().size() };
     }
 
 
-    size_t GetKeyboards(std::vector<IKeyboard *> &keyboards, const bool ignore_disconnected)
+    DeviceSpan<IMouse> GetMouseSpan()
     {
-        return GetDevicesOfType<IKeyboard>(keyboards, DeviceType::KEYBOARD, ignore_disconnected);
+        return { glob_devices.Mice().data(), glob_devices.Mice().size() };
     }
 
 
-    size_t GetGamepads(std::vector<IGamepad *> &gamepads, const bool ignore_disconnected)
+    DeviceSpan<IKeyboard> GetKeyboardSpan()
+    {
+        return { glob_devices.Keyboards().data(), glob_devices.Keyboards().size() };
+    }
+
+
+    DeviceSpan<IGamepad> GetGamepadSpan()
     {
-        return GetDevicesOfType<IGamepad>(gamepads, DeviceType::GAMEPAD, ignore_disconnected);
+        return { glob_devices.Gamepads().data(), glob_devices.Gamepads().size() };
     }
 
 
     IDevice *GetDevice(const ID id)
     {
-        if (id.value != 0)
-        {
-            const auto kv = glob_interfaces.find(id);
-            if (kv != glob_interfaces.end()) { return kv->second; }
-        }
-        
-        return nullptr;
+        return glob_devices.Find(id);
     }
 
 
@@ -231,18 +451,15 @@ namespace crossput
         if (id.value == 0) { return; }
 
         // try to find main target
-        const auto kv_main = glob_interfaces.find(id);
-        if (kv_main == glob_interfaces.end()) { return; }
+        BaseInterface *const p_main = glob_devices.Find(id);
+        if (p_main == nullptr) { return; }
 
         #ifdef CROSSPUT_FEATURE_AGGREGATE
-        if (!glob_dev_to_aggr.contains(kv_main->second->GetID())) // shortcut
+        if (!p_main->IsAggregateMember()) // shortcut
         {
-            #ifdef CROSSPUT_FEATURE_CALLBACK
-            DeviceStatusChanged(kv_main->second, DeviceStatusChange::DESTROYED);
-            #endif // CROSSPUT_FEATURE_CALLBACK
+            DeviceStatusChanged(p_main, DeviceStatusChange::DESTROYED);
 
-            delete kv_main->second;
-            glob_interfaces.erase(kv_main);
+            delete p_main;
             return;
         }
 
@@ -276,17 +493,103 @@ namespace crossput
 
         DestroyHierarchy(std::move(targets));
         #else
-        #ifdef CROSSPUT_FEATURE_CALLBACK
-        DeviceStatusChanged(kv_main->second, DeviceStatusChange::DESTROYED);
-        #endif // CROSSPUT_FEATURE_CALLBACK
+        DeviceStatusChanged(p_main, DeviceStatusChange::DESTROYED);
 
-        delete kv_main->second;
-        glob_interfaces.erase(kv_main);
+        delete p_main;
         #endif // CROSSPUT_FEATURE_AGGREGATE
     }
 
 
     #ifdef CROSSPUT_FEATURE_CALLBACK
+    // CALLBACK TABLE
+
+    void CallbackTable::Insert(const ID id, const void *const p_callback)
+    {
+        entries_.push_back({.id = id, .filter = 0, .p_callback = p_callback, .has_filter = false});
+        Rebuild();
+    }
+
+
+    void CallbackTable::Insert(const ID id, const void *const p_callback, const callback_filter_t filter)
+    {
+        entries_.push_back({.id = id, .filter = filter, .p_callback = p_callback, .has_filter = true});
+        Rebuild();
+    }
+
+
+    void CallbackTable::Erase(const ID id)
+    {
+        const auto it = std::find_if(entries_.begin(), entries_.end(), [id](const Entry &e) { return e.id == id; });
+        if (it != entries_.end())
+        {
+            entries_.erase(it);
+            Rebuild();
+        }
+    }
+
+
+    void CallbackTable::Clear()
+    {
+        entries_.clear();
+        Rebuild();
+    }
+
+
+    void CallbackTable::Rebuild()
+    {
+        callbacks_.clear();
+        filter_offsets_.clear();
+        sparse_.clear();
+        num_unfiltered_ = 0;
+
+        // unfiltered callbacks come first, also find range of dense filters
+        size_t num_dense = 0;
+        callback_filter_t dense_end = 0;
+        for (const Entry &e : entries_)
+        {
+            if (!e.has_filter)
+            {
+                callbacks_.push_back(e.p_callback);
+                num_unfiltered_++;
+            }
+            else if (e.filter < DENSE_FILTER_LIMIT)
+            {
+                dense_end = std::max(dense_end, e.filter + 1);
+                num_dense++;
+            }
+            else
+            {
+                sparse_.push_back({e.filter, e.p_callback});
+            }
+        }
+
+        if (num_dense == 0) { return; }
+
+        // count callbacks per filter, then convert counts to offsets
+        filter_offsets_.resize(static_cast<size_t>(dense_end) + 1, 0);
+        for (const Entry &e : entries_)
+        {
+            if (e.has_filter && e.filter < DENSE_FILTER_LIMIT) { filter_offsets_[e.filter + 1]++; }
+        }
+
+        filter_offsets_[0] = num_unfiltered_;
+        for (size_t f = 1; f < filter_offsets_.size(); f++)
+        {
+            filter_offsets_[f] += filter_offsets_[f - 1];
+        }
+
+        // place callbacks in their ranges, preserving order of registration
+        callbacks_.resize(num_unfiltered_ + num_dense);
+        std::vector<uint32_t> cursors(filter_offsets_.begin(), filter_offsets_.end() - 1);
+        for (const Entry &e : entries_)
+        {
+            if (e.has_filter && e.filter < DENSE_FILTER_LIMIT) { callbacks_[cursors[e.filter]++] = e.p_callback; }
+        }
+    }
+
+
+    // GLOBAL CALLBACK MANAGEMENT
+
     void UnregisterCallback(const ID id)
     {
         ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
@@ -296,83 +599,455 @@ namespace crossput
     void UnregisterAllCallbacks()
     {
         ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+        for (const auto &elm : glob_callbacks)
+        {
+            elm.second.p_table->Clear();
+            delete elm.second.p_wrapper;
+        }
+
         glob_callbacks.clear();
     }
 
+    void SetCallbackDelivery(const CallbackDelivery delivery)
+    {
+        ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+        glob_callback_delivery = delivery;
+    }
+
+    CallbackDelivery GetCallbackDelivery()
+    {
+        return glob_callback_delivery;
+    }
+
+    size_t DispatchPendingCallbacks()
+    {
+        ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+        const size_t num = glob_pending_callbacks.size();
+        if (num == 0) { return ResumeDeferredWaiters(); }
+
+        // single block for the entire pass (see ManagementAPIBlock)
+        const ManagementAPIBlock block;
+        size_t i = 0;
+        try
+        {
+            for (; i < num; i++)
+            {
+                const PendingCallback &pc = glob_pending_callbacks[i];
+                pc.p_dispatch(pc);
+            }
+        }
+        catch (...)
+        {
+            // keep changes which have not been dispatched yet
+            glob_pending_callbacks.erase(glob_pending_callbacks.begin(), glob_pending_callbacks.begin() + static_cast<ptrdiff_t>(i + 1));
+            throw;
+        }
+
+        // capacity is kept, so steady-state queueing does not allocate
+        glob_pending_callbacks.clear();
+
+        // coroutines are resumed after all callbacks
+        return num + ResumeDeferredWaiters();
+    }
+
     ID RegisterGlobalStatusCallback(const StatusCallback &&callback)
     {
         ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
-        return InsertCallback<impl::_StatusCallback>(std::move(callback), {0});
+        return InsertGlobalCallback<impl::_StatusCallback>(std::move(callback));
     }
 
     ID RegisterGlobalStatusCallback(const StatusCallback &&callback, const DeviceStatusChange type)
     {
         ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
-        return InsertCallback<impl::_StatusCallback>(std::move(callback), {0}, type);
+        return InsertGlobalCallback<impl::_StatusCallback>(std::move(callback), type);
     }
 
     ID RegisterGlobalMouseMoveCallback(const MouseMoveCallback &&callback)
     {
         ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
-        return InsertCallback<impl::_MouseMoveCallback>(std::move(callback), {0});
+        return InsertGlobalCallback<impl::_MouseMoveCallback>(std::move(callback));
     }
 
     ID RegisterGlobalMouseScrollCallback(const MouseScrollCallback &&callback)
     {
         ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
-        return InsertCallback<impl::_MouseScrollCallback>(std::move(callback), {0});
+        return InsertGlobalCallback<impl::_MouseScrollCallback>(std::move(callback));
     }
 
     ID RegisterGlobalMouseButtonCallback(const MouseButtonCallback &&callback)
     {
         ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
-        return InsertCallback<impl::_MouseButtonCallback>(std::move(callback), {0});
+        return InsertGlobalCallback<impl::_MouseButtonCallback>(std::move(callback));
     }
 
     ID RegisterGlobalMouseButtonCallback(const MouseButtonCallback &&callback, const uint32_t index)
     {
         ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
-        return InsertCallback<impl::_MouseButtonCallback>(std::move(callback), {0}, index);
+        return InsertGlobalCallback<impl::_MouseButtonCallback>(std::move(callback), index);
     }
 
     ID RegisterGlobalKeyboardKeyCallback(const KeyboardKeyCallback &&callback)
     {
         ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
-        return InsertCallback<impl::_KeyboardKeyCallback>(std::move(callback), {0});
+        return InsertGlobalCallback<impl::_KeyboardKeyCallback>(std::move(callback));
     }
 
     ID RegisterGlobalKeyboardKeyCallback(const KeyboardKeyCallback &&callback, const Key key)
     {
         ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
-        return InsertCallback<impl::_KeyboardKeyCallback>(std::move(callback), {0}, key);
+        return InsertGlobalCallback<impl::_KeyboardKeyCallback>(std::move(callback), key);
     }
 
     ID RegisterGlobalGamepadButtonCallback(const GamepadButtonCallback &&callback)
     {
         ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
-        return InsertCallback<impl::_GamepadButtonCallback>(std::move(callback), {0});
+        return InsertGlobalCallback<impl::_GamepadButtonCallback>(std::move(callback));
     }
 
     ID RegisterGlobalGamepadButtonCallback(const GamepadButtonCallback &&callback, const Button button)
     {
         ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
-        return InsertCallback<impl::_GamepadButtonCallback>(std::move(callback), {0}, button);
+        return InsertGlobalCallback<impl::_GamepadButtonCallback>(std::move(callback), button);
     }
 
     ID RegisterGlobalGamepadThumbstickCallback(const GamepadThumbstickCallback &&callback)
     {
         ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
-        return InsertCallback<impl::_GamepadThumbstickCallback>(std::move(callback), {0});
+        return InsertGlobalCallback<impl::_GamepadThumbstickCallback>(std::move(callback));
     }
 
     ID RegisterGlobalGamepadThumbstickCallback(const GamepadThumbstickCallback &&callback, const uint32_t index)
     {
         ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
-        return InsertCallback<impl::_GamepadThumbstickCallback>(std::move(callback), {0}, index);
+        return InsertGlobalCallback<impl::_GamepadThumbstickCallback>(std::move(callback), index);
     }
     #endif // CROSSPUT_FEATURE_CALLBACK
 
 
+    // INPUT THREAD
+
+    void CaptureSnapshot(IDevice *const p_device, DeviceSnapshot &snapshot)
+    {
+        snapshot = {};
+        snapshot.device_id = p_device->GetID();
+        snapshot.type = p_device->GetType();
+        snapshot.is_connected = p_device->IsConnected();
+        if (!snapshot.is_connected) { return; }
+
+        switch (snapshot.type)
+        {
+        case DeviceType::MOUSE:
+            {
+                const IMouse *const p_mouse = dynamic_cast<const IMouse *>(p_device);
+                p_mouse->GetPosition(snapshot.position[0], snapshot.position[1]);
+                p_mouse->GetDelta(snapshot.delta[0], snapshot.delta[1]);
+                p_mouse->GetScroll(snapshot.scroll[0], snapshot.scroll[1]);
+                p_mouse->GetScrollDelta(snapshot.scroll_delta[0], snapshot.scroll_delta[1]);
+                snapshot.button_count = std::min(p_mouse->GetButtonCount(), DeviceSnapshot::MAX_BUTTONS);
+                for (uint32_t i = 0; i < snapshot.button_count; i++)
+                {
+                    snapshot.button_values[i] = p_mouse->GetButtonValue(i);
+                    snapshot.button_states[i] = p_mouse->GetButtonState(i, snapshot.button_times[i]);
+                }
+            }
+            break;
+
+        case DeviceType::KEYBOARD:
+            {
+                const IKeyboard *const p_keyboard = dynamic_cast<const IKeyboard *>(p_device);
+                snapshot.num_keys_pressed = p_keyboard->GetNumKeysPressed();
+                snapshot.button_count = static_cast<uint32_t>(NUM_KEY_CODES);
+                for (uint32_t i = 0; i < NUM_KEY_CODES; i++)
+                {
+                    const Key k = static_cast<Key>(i);
+                    snapshot.button_values[i] = p_keyboard->GetKeyValue(k);
+                    snapshot.button_states[i] = p_keyboard->GetKeyState(k, snapshot.button_times[i]);
+                }
+            }
+            break;
+
+        case DeviceType::GAMEPAD:
+            {
+                const IGamepad *const p_gamepad = dynamic_cast<const IGamepad *>(p_device);
+                snapshot.button_count = static_cast<uint32_t>(NUM_BUTTON_CODES);
+                for (uint32_t i = 0; i < NUM_BUTTON_CODES; i++)
+                {
+                    const Button b = static_cast<Button>(i);
+                    snapshot.button_values[i] = p_gamepad->GetButtonValue(b);
+                    snapshot.button_states[i] = p_gamepad->GetButtonState(b, snapshot.button_times[i]);
+                }
+
+                snapshot.thumbstick_count = std::min(p_gamepad->GetThumbstickCount(), DeviceSnapshot::MAX_THUMBSTICKS);
+                for (uint32_t i = 0; i < snapshot.thumbstick_count; i++)
+                {
+                    p_gamepad->GetThumbstick(i, snapshot.thumbsticks[i][0], snapshot.thumbsticks[i][1]);
+                }
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+
+    inline void PublishSnapshot(SnapshotSlot &slot, DeviceSnapshot &snapshot)
+    {
+        // single writer, so relaxed loads of the own sequence are sufficient
+        const uint64_t seq = slot.sequence.load(std::memory_order_relaxed);
+        snapshot.sequence = (seq / 2) + 1;
+
+        slot.sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&slot.data, &snapshot, sizeof(DeviceSnapshot));
+        slot.sequence.store(seq + 2, std::memory_order_release);
+    }
+
+
+    void InputThreadMain(const std::chrono::steady_clock::duration interval)
+    {
+        DeviceSnapshot snapshot;
+        auto next_update = std::chrono::steady_clock::now();
+
+        try
+        {
+            while (!glob_input_thread_stop.load(std::memory_order_relaxed))
+            {
+                UpdateAllDevices();
+
+                for (auto &[id, p_slot] : glob_snapshots)
+                {
+                    CaptureSnapshot(p_slot->p_device, snapshot);
+                    PublishSnapshot(*p_slot, snapshot);
+                }
+
+                next_update += interval;
+                const auto now = std::chrono::steady_clock::now();
+                if (next_update < now) { next_update = now; } // do not try to catch up after a stall
+                std::this_thread::sleep_until(next_update);
+            }
+        }
+        catch (...)
+        {
+            // rethrown by StopInputThread()
+            glob_input_thread_exception = std::current_exception();
+        }
+
+        glob_input_thread_running.store(false, std::memory_order_release);
+    }
+
+
+    bool StartInputThread(const float interval)
+    {
+        ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+        if (glob_input_thread.joinable()) { return false; }
+
+        // allocate snapshot slots of all current devices
+        glob_snapshots.clear();
+        glob_snapshots.reserve(glob_devices.Size());
+        for (IDevice *const p_device : glob_devices.Devices())
+        {
+            auto p_slot = std::make_unique<SnapshotSlot>();
+            p_slot->p_device = p_device;
+            glob_snapshots.insert({p_device->GetID(), std::move(p_slot)});
+        }
+
+        glob_input_thread_stop = false;
+        glob_input_thread_exception = nullptr;
+        glob_input_thread_running = true;
+        glob_input_thread = std::thread(InputThreadMain, std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(std::max(0.0F, interval))));
+        return true;
+    }
+
+
+    void StopInputThread()
+    {
+        if (!glob_input_thread.joinable()) { return; }
+
+        // callbacks run on the input thread, which cannot join itself
+        if (glob_input_thread.get_id() == std::this_thread::get_id())
+        {
+            ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+            throw std::runtime_error(std::format("{}: invoked from the input thread", CROSSPUT_FUNCTION_STR));
+        }
+
+        glob_input_thread_stop = true;
+        glob_input_thread.join();
+
+        if (glob_input_thread_exception)
+        {
+            std::exception_ptr exception = nullptr;
+            std::swap(exception, glob_input_thread_exception);
+            std::rethrow_exception(exception);
+        }
+    }
+
+
+    bool IsInputThreadRunning()
+    {
+        return glob_input_thread_running.load(std::memory_order_acquire);
+    }
+
+
+    bool AcquireSnapshot(const ID device_id, DeviceSnapshot &snapshot)
+    {
+        const auto it = glob_snapshots.find(device_id);
+        if (it == glob_snapshots.end()) { return false; }
+
+        const SnapshotSlot &slot = *(it->second);
+        uint64_t seq1, seq2;
+        do
+        {
+            seq1 = slot.sequence.load(std::memory_order_acquire);
+            if (seq1 == 0) { return false; } // nothing published yet
+            if (seq1 & 1) { continue; } // write in progress
+
+            std::memcpy(&snapshot, &slot.data, sizeof(DeviceSnapshot));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            seq2 = slot.sequence.load(std::memory_order_relaxed);
+        }
+        while ((seq1 & 1) || seq1 != seq2);
+
+        return true;
+    }
+
+
+    // FORCE STREAMING
+
+    #ifdef CROSSPUT_FEATURE_FORCE
+    ForceStream::ForceStream(IDevice *const p_device, std::mutex &force_mutex, const float interval) :
+        p_device_(p_device),
+        force_mutex_(force_mutex)
+    {
+        coalesced_.reserve(16);
+        worker_ = std::thread(&ForceStream::WorkerMain, this, std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(std::max(MIN_FORCE_STREAM_INTERVAL, interval))));
+    }
+
+
+    ForceStream::~ForceStream()
+    {
+        stop_.store(true, std::memory_order_relaxed);
+        worker_.join();
+    }
+
+
+    void ForceStream::WorkerMain(const std::chrono::steady_clock::duration interval)
+    {
+        ForceStreamUpdate update;
+        auto next_iteration = std::chrono::steady_clock::now();
+
+        while (!stop_.load(std::memory_order_relaxed))
+        {
+            // keep only the newest parameters of each force
+            while (queue_.TryPop(update))
+            {
+                const auto it = std::find_if(coalesced_.begin(), coalesced_.end(), [&update](const ForceStreamUpdate &u) { return u.force_id == update.force_id; });
+                if (it != coalesced_.end()) { it->params = update.params; }
+                else { coalesced_.push_back(update); }
+            }
+
+            if (!coalesced_.empty())
+            {
+                const std::lock_guard<std::mutex> lock(force_mutex_);
+                for (const ForceStreamUpdate &u : coalesced_)
+                {
+                    IForce *p_force;
+                    if (p_device_->TryGetForce(u.force_id, p_force) && !p_force->IsOrphaned())
+                    {
+                        p_force->Params() = u.params;
+                        if (p_force->WriteParams()) { upload_count_.fetch_add(1, std::memory_order_relaxed); }
+                    }
+                }
+
+                coalesced_.clear();
+            }
+
+            next_iteration += interval;
+            const auto now = std::chrono::steady_clock::now();
+            if (next_iteration < now) { next_iteration = now; } // do not try to catch up after a stall
+            std::this_thread::sleep_until(next_iteration);
+        }
+    }
+    #endif // CROSSPUT_FEATURE_FORCE
+
+
+    // STATS
+
+    #ifdef CROSSPUT_FEATURE_STATS
+    void AccumulateStats(DeviceStats &dest, const DeviceStats &src) noexcept
+    {
+        dest.events_read += src.events_read;
+        dest.event_groups += src.event_groups;
+        dest.syscalls += src.syscalls;
+        dest.overruns += src.overruns;
+        dest.reconnect_attempts += src.reconnect_attempts;
+        dest.callbacks_invoked += src.callbacks_invoked;
+        dest.updates += src.updates;
+        dest.update_time_total += src.update_time_total;
+        dest.update_time_max = std::max(dest.update_time_max, src.update_time_max);
+        for (size_t i = 0; i < NUM_UPDATE_TIME_BUCKETS; i++) { dest.update_time_histogram[i] += src.update_time_histogram[i]; }
+        dest.latency_max = std::max(dest.latency_max, src.latency_max);
+        for (size_t i = 0; i < NUM_LATENCY_BUCKETS; i++)
+        {
+            dest.latency_histogram[i] += src.latency_histogram[i];
+            dest.callback_latency_histogram[i] += src.callback_latency_histogram[i];
+        }
+    }
+
+
+    bool GetDeviceStats(const ID id, DeviceStats &stats)
+    {
+        BaseInterface *const p_interface = glob_devices.Find(id);
+        if (p_interface == nullptr) { return false; }
+
+        stats = p_interface->Stats();
+        return true;
+    }
+
+
+    void GetGlobalStats(DeviceStats &stats)
+    {
+        stats = glob_stats;
+        for (BaseInterface *const p_interface : glob_devices.Interfaces()) { AccumulateStats(stats, p_interface->Stats()); }
+    }
+
+
+    void ResetStats()
+    {
+        ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+        glob_stats = {};
+        for (BaseInterface *const p_interface : glob_devices.Interfaces()) { p_interface->Stats() = {}; }
+    }
+
+
+    uint64_t GetLatencyPercentile(const uint64_t (&histogram)[NUM_LATENCY_BUCKETS], const float percentile)
+    {
+        uint64_t total = 0;
+        for (size_t i = 0; i < NUM_LATENCY_BUCKETS; i++) { total += histogram[i]; }
+        if (total == 0) { return 0; }
+
+        const double rank = std::ceil(static_cast<double>(std::clamp(percentile, 0.0f, 1.0f)) * static_cast<double>(total));
+        const uint64_t target = std::max(static_cast<uint64_t>(rank), uint64_t{1});
+        uint64_t count = 0;
+        size_t i = 0;
+        for (; i < NUM_LATENCY_BUCKETS - 1; i++)
+        {
+            count += histogram[i];
+            if (count >= target) { break; }
+        }
+
+        // largest latency within the bucket
+        if (i < 8) { return i; }
+        const size_t e = i / 8 + 2;
+        return ((8 + (i % 8)) << (e - 3)) + (uint64_t{1} << (e - 3)) - 1;
+    }
+    #endif // CROSSPUT_FEATURE_STATS
+
+
     #ifdef CROSSPUT_FEATURE_AGGREGATE
     IDevice *Aggregate(const std::vector<ID> &ids, const DeviceType hint_type)
     {
@@ -482,8 +1157,7 @@ namespace crossput
         }
 
         // register
-        const ID id = p_aggregate->GetID();
-        glob_interfaces.insert({id, p_aggregate});
+        glob_devices.Register(p_aggregate);
 
         return p_aggregate;
     }
@@ -493,28 +1167,21 @@ namespace crossput
 
     void AggregateMouse::Update()
     {
+        CROSSPUT_STATS_TIME_UPDATE();
+        MarkServiced();
         AggregateImpl<IMouse>::Update();
         if (!is_connected_) { return; }
 
-        // get maximum number of addressable buttons
-        uint32_t bc = 0;
-        for (size_t i = 0; i < member_count_; i++)
-        {
-            bc = std::max(bc, members_[i]->GetButtonCount());
-        }
-
-        if (bc != button_count_) [[unlikely]] // button count rarely changes
-        {
-            button_count_ = bc;
-            button_data_.clear();
-            button_data_.resize(bc);
-        }
-
-        std::unique_ptr<float[]> new_values = std::make_unique<float[]>(bc);
-
+        const uint32_t bc = button_count_;
+        bool any_changed = false;
         int64_t dx = 0, dy = 0, sdx = 0, sdy = 0;
+
+        // only members which produced input since the last update have to be merged
         for (size_t i = 0; i < member_count_; i++)
         {
+            if (!ConsumeMemberChange(i)) [[likely]] { continue; }
+            any_changed = true;
+
             IMouse *p_member = members_[i];
             MouseAccu &accu = prev_data_[i];
 
@@ -540,12 +1207,9 @@ namespace crossput
             accu.sx = sx;
             accu.sy = sy;
 
-            // find max analog button values
-            const uint32_t maxb = std::min(bc, p_member->GetButtonCount());
-            for (uint32_t b = 0; b < maxb; b++)
-            {
-                new_values[b] = std::max(p_member->GetButtonValue(b), button_data_[b].Value());
-            }
+            float *const values = member_values_.get() + (i * MAX_BUTTONS);
+            const uint32_t n = p_member->GetButtonValues(values, bc);
+            std::fill(values + n, values + bc, 0.0F);
         }
 
         // update mouse data
@@ -558,29 +1222,47 @@ namespace crossput
         data_.sdx = sdx;
         data_.sdy = sdy;
 
-        #ifdef CROSSPUT_FEATURE_CALLBACK
-        if (dx != 0 || dy != 0) { MouseMoved(data_.x, data_.y, dx, dy); }
-        if (sdx != 0 || sdy != 0) { MouseScrolled(data_.sx, data_.sy, sdx, sdy); }
-        #endif // CROSSPUT_FEATURE_CALLBACK
+        if (!any_changed) { return; }
+
+        if (dx != 0 || dy != 0) { MouseMoved(data_.x, data_.y, dx, dy, last_update_timestamp_); }
+        if (sdx != 0 || sdy != 0) { MouseScrolled(data_.sx, data_.sy, sdx, sdy, last_update_timestamp_); }
+
+        // find max analog button values
+        float new_values[MAX_BUTTONS];
+        std::copy_n(member_values_.get(), bc, new_values);
+        for (size_t i = 1; i < member_count_; i++)
+        {
+            const float *const values = member_values_.get() + (i * MAX_BUTTONS);
+            for (uint32_t b = 0; b < bc; b++) { new_values[b] = std::max(new_values[b], values[b]); }
+        }
 
         // update button data
         for (uint32_t b = 0; b < bc; b++)
         {
             const float value = new_values[b];
-            #ifdef CROSSPUT_FEATURE_CALLBACK
             bool state;
-            if (button_data_[b].Modify(value, last_update_timestamp_, state)) { ButtonChanged(b, value, state); }
-            #else
-            button_data_[b].Modify(value, last_update_timestamp_);
-            #endif // CROSSPUT_FEATURE_CALLBACK
+            if (button_data_.Modify(b, value, last_update_timestamp_, state)) { ButtonChanged(b, value, state, last_update_timestamp_); }
+        }
+    }
+
+
+    void AggregateMouse::OnConnected()
+    {
+        // get maximum number of addressable buttons
+        uint32_t bc = 0;
+        for (size_t i = 0; i < member_count_; i++)
+        {
+            bc = std::max(bc, members_[i]->GetButtonCount());
         }
+
+        button_count_ = std::min(bc, MAX_BUTTONS);
     }
 
 
     void AggregateMouse::OnDisconnected()
     {
         std::memset(prev_data_.get(), 0, sizeof(MouseAccu) * member_count_);
-        button_data_.clear();
+        button_data_.Reset();
         button_count_ = 0;
     }
 
@@ -622,27 +1304,27 @@ namespace crossput
     {
         if (index < button_count_)
         {
-            button_data_[index].SetThreshold(std::clamp(threshold, 0.0F, 1.0F));
+            button_data_.SetThreshold(index, std::clamp(threshold, 0.0F, 1.0F));
         }
     }
 
     void AggregateMouse::SetGlobalThreshold(float threshold)
     {
         threshold = std::clamp(threshold, 0.0F, 1.0F);
-        for (unsigned int i = 0; i < button_count_; i++) { button_data_[i].SetThreshold(threshold); }
+        for (unsigned int i = 0; i < button_count_; i++) { button_data_.SetThreshold(i, threshold); }
     }
 
     float AggregateMouse::GetButtonThreshold(const uint32_t index) const
     {
         return index < button_count_
-            ? button_data_[index].Threshold()
+            ? button_data_.Threshold(index)
             : 0.0F;
     }
 
     float AggregateMouse::GetButtonValue(const uint32_t index) const
     {
         return (is_connected_ && index < button_count_)
-            ? button_data_[index].Value()
+            ? button_data_.Value(index)
             : 0.0F;
     }
 
@@ -650,9 +1332,8 @@ namespace crossput
     {
         if (is_connected_ && index < button_count_)
         {
-            const TSTV &d = button_data_[index];
-            time = TimestampDeltaSeconds(d.Timestamp(), last_update_timestamp_);
-            return d.State();
+            time = TimestampDeltaSeconds(button_data_.Timestamp(index), last_update_timestamp_);
+            return button_data_.State(index);
         }
         else
         {
@@ -661,44 +1342,68 @@ namespace crossput
         }
     }
 
+    void AggregateMouse::GetButtonStates(uint64_t *const states, const size_t num_words) const
+    {
+        button_data_.CopyStates(states, num_words, is_connected_);
+    }
+
+    uint32_t AggregateMouse::GetButtonValues(float *const values, const uint32_t max_count) const
+    {
+        const uint32_t n = std::min(max_count, AggregateMouse::GetButtonCount());
+        button_data_.CopyValues(values, n, is_connected_);
+        return n;
+    }
+
+    uint32_t AggregateMouse::GetButtonTimestamps(uint64_t *const timestamps, const uint32_t max_count) const
+    {
+        const uint32_t n = std::min(max_count, AggregateMouse::GetButtonCount());
+        button_data_.CopyTimestamps(timestamps, n, is_connected_);
+        return n;
+    }
+
 
     // AGGREGATE KEYBOARD
 
     void AggregateKeyboard::Update()
     {
+        CROSSPUT_STATS_TIME_UPDATE();
+        MarkServiced();
         AggregateImpl<IKeyboard>::Update();
         if (!is_connected_) { return; }
 
-        float new_values[NUM_KEY_CODES] = {};
-
+        // only members which produced input since the last update have to be read
+        bool any_changed = false;
         for (size_t i = 0; i < member_count_; i++)
         {
-            const IKeyboard *const p_member = members_[i];
+            if (!ConsumeMemberChange(i)) [[likely]] { continue; }
+            any_changed = true;
+            members_[i]->GetKeyValues(member_values_.get() + (i * NUM_KEY_CODES));
+        }
 
-            // find maximum analog values of each key
-            for (unsigned int k = 0; k < NUM_KEY_CODES; k++)
-            {
-                new_values[k] = std::max(new_values[k], p_member->GetKeyValue(static_cast<Key>(k)));
-            }
+        if (!any_changed) { return; }
+
+        // find maximum analog values of each key
+        float new_values[NUM_KEY_CODES];
+        std::copy_n(member_values_.get(), NUM_KEY_CODES, new_values);
+        for (size_t i = 1; i < member_count_; i++)
+        {
+            const float *const values = member_values_.get() + (i * NUM_KEY_CODES);
+            for (unsigned int k = 0; k < NUM_KEY_CODES; k++) { new_values[k] = std::max(new_values[k], values[k]); }
         }
 
         // update key data
         for (unsigned int k = 0; k < NUM_KEY_CODES; k++)
         {
             const float value = new_values[k];
-            #ifdef CROSSPUT_FEATURE_CALLBACK
             bool state;
-            if (key_data_[k].Modify(value, last_update_timestamp_, state, num_keys_pressed_)) { KeyChanged(static_cast<Key>(k), value, state); }
-            #else
-            key_data_[k].Modify(value, last_update_timestamp_, num_keys_pressed_);
-            #endif // CROSSPUT_FEATURE_CALLBACK
+            if (key_data_.Modify(k, value, last_update_timestamp_, state, num_keys_pressed_)) { KeyChanged(static_cast<Key>(k), value, state, last_update_timestamp_); }
         }
     }
 
 
     void AggregateKeyboard::OnDisconnected()
     {
-        std::memset(key_data_, 0, sizeof(key_data_));
+        key_data_.Reset();
         num_keys_pressed_ = 0;
     }
 
@@ -712,27 +1417,27 @@ namespace crossput
     {
         if (IsValidKey(key))
         {
-            key_data_[static_cast<int>(key)].SetThreshold(std::clamp(threshold, 0.0F, 1.0F));
+            key_data_.SetThreshold(static_cast<int>(key), std::clamp(threshold, 0.0F, 1.0F));
         }
     }
 
     void AggregateKeyboard::SetGlobalThreshold(float threshold)
     {
         threshold = std::clamp(threshold, 0.0F, 1.0F);
-        for (unsigned int i = 0; i < NUM_KEY_CODES; i++) { key_data_[i].SetThreshold(threshold); }
+        for (unsigned int i = 0; i < NUM_KEY_CODES; i++) { key_data_.SetThreshold(i, threshold); }
     }
 
     float AggregateKeyboard::GetKeyThreshold(const Key key) const
     {
         return IsValidKey(key)
-            ? key_data_[static_cast<int>(key)].Threshold()
+            ? key_data_.Threshold(static_cast<int>(key))
             : 0.0F;
     }
 
     float AggregateKeyboard::GetKeyValue(const Key key) const
     {
         return (is_connected_ && IsValidKey(key))
-            ? key_data_[static_cast<int>(key)].Value()
+            ? key_data_.Value(static_cast<int>(key))
             : 0.0F;
     }
 
@@ -740,9 +1445,8 @@ namespace crossput
     {
         if (is_connected_ && IsValidKey(key))
         {
-            const TSTV &d = key_data_[static_cast<int>(key)];
-            time = TimestampDeltaSeconds(d.Timestamp(), last_update_timestamp_);
-            return d.State();
+            time = TimestampDeltaSeconds(key_data_.Timestamp(static_cast<int>(key)), last_update_timestamp_);
+            return key_data_.State(static_cast<int>(key));
         }
         else
         {
@@ -751,78 +1455,105 @@ namespace crossput
         }
     }
 
+    void AggregateKeyboard::GetKeyStates(uint64_t *const states) const
+    {
+        key_data_.CopyStates(states, NUM_KEY_STATE_WORDS, is_connected_);
+    }
+
+    void AggregateKeyboard::GetKeyValues(float *const values) const
+    {
+        key_data_.CopyValues(values, NUM_KEY_CODES, is_connected_);
+    }
+
+    void AggregateKeyboard::GetKeyTimestamps(uint64_t *const timestamps) const
+    {
+        key_data_.CopyTimestamps(timestamps, NUM_KEY_CODES, is_connected_);
+    }
+
 
     // AGGREGATE GAMEPAD
 
     void AggregateGamepad::Update()
     {
+        CROSSPUT_STATS_TIME_UPDATE();
+        MarkServiced();
         AggregateImpl<IGamepad>::Update();
         if (!is_connected_) { return; }
 
-        uint32_t tc = 0;
+        // only members which produced input since the last update have to be read
+        bool any_changed = false;
         for (size_t i = 0; i < member_count_; i++)
         {
-            tc += members_[i]->GetThumbstickCount();
-        }
-
-        // reset when number of thumbsticks changes
-        const bool th_reset = tc != thumbstick_count_;
-        if (th_reset) [[unlikely]]
-        {
-            thumbstick_count_ = tc;
-            thumbstick_values_.clear();
-            thumbstick_values_.resize(tc);
-        }
-
-        float new_values[NUM_BUTTON_CODES] = {};
+            if (!ConsumeMemberChange(i)) [[likely]] { continue; }
+            any_changed = true;
 
-        uint32_t th_index = 0;
-        for (size_t i = 0; i < member_count_; i++)
-        {
             const IGamepad *const p_member = members_[i];
+            p_member->GetButtonValues(member_values_.get() + (i * NUM_BUTTON_CODES));
 
             // update thumbstick data
-            const uint32_t th_count = p_member->GetThumbstickCount();
+            const uint32_t th_offset = thumbstick_offsets_[i];
+            const uint32_t th_count = std::min(p_member->GetThumbstickCount(), thumbstick_count_ - th_offset);
             for (uint32_t t = 0; t < th_count; t++)
             {
                 float x, y;
                 p_member->GetThumbstick(t, x, y);
-                auto &tval = thumbstick_values_[th_index];
+                ProcessThumbstick(th_offset + t, x, y); // on top of the profile of the member
+                auto &tval = thumbstick_values_[th_offset + t];
 
-                #ifdef CROSSPUT_FEATURE_CALLBACK
-                if (x != tval.first || y != tval.second || th_reset) { ThumbstickChanged(th_index, x, y); }
-                #endif // CROSSPUT_FEATURE_CALLBACK
+                if (x != tval.first || y != tval.second || thumbsticks_reset_) { ThumbstickChanged(th_offset + t, x, y, last_update_timestamp_); }
 
                 tval = {x, y};
-                th_index++;
             }
+        }
 
-            // find maximum analog values of each button
-            for (unsigned int b = 0; b < NUM_BUTTON_CODES; b++)
-            {
-                new_values[b] = std::max(new_values[b], p_member->GetButtonValue(static_cast<Button>(b)));
-            }
+        thumbsticks_reset_ = false;
+        if (!any_changed) { return; }
+
+        // find maximum analog values of each button
+        float new_values[NUM_BUTTON_CODES];
+        std::copy_n(member_values_.get(), NUM_BUTTON_CODES, new_values);
+        for (size_t i = 1; i < member_count_; i++)
+        {
+            const float *const values = member_values_.get() + (i * NUM_BUTTON_CODES);
+            for (unsigned int b = 0; b < NUM_BUTTON_CODES; b++) { new_values[b] = std::max(new_values[b], values[b]); }
         }
 
         // update button data
         for (unsigned int b = 0; b < NUM_BUTTON_CODES; b++)
         {
-            const float value = new_values[b];
-            #ifdef CROSSPUT_FEATURE_CALLBACK
+            const float value = ProcessButton(static_cast<Button>(b), new_values[b]);
             bool state;
-            if (button_data_[b].Modify(value, last_update_timestamp_, state)) { ButtonChanged(static_cast<Button>(b), value, state); }
-            #else
-            button_data_[b].Modify(value, last_update_timestamp_);
-            #endif // CROSSPUT_FEATURE_CALLBACK
+            if (button_data_.Modify(b, value, last_update_timestamp_, state)) { ButtonChanged(static_cast<Button>(b), value, state, last_update_timestamp_); }
+        }
+    }
+
+
+    void AggregateGamepad::OnConnected()
+    {
+        // thumbsticks of all members are concatenated
+        uint32_t tc = 0;
+        for (size_t i = 0; i < member_count_; i++)
+        {
+            thumbstick_offsets_[i] = tc;
+            tc += members_[i]->GetThumbstickCount();
+        }
+
+        // reset when number of thumbsticks changes
+        if (tc != thumbstick_count_)
+        {
+            thumbstick_count_ = tc;
+            thumbstick_values_.assign(tc, {0.0F, 0.0F});
+            thumbsticks_reset_ = true;
         }
     }
 
 
     void AggregateGamepad::OnDisconnected()
     {
-        std::memset(button_data_, 0, sizeof(button_data_));
+        button_data_.Reset();
         thumbstick_values_.clear();
         thumbstick_count_ = 0;
+        ResetRawThumbsticks();
     }
 
 
@@ -830,27 +1561,27 @@ namespace crossput
     {
         if (IsValidButton(button))
         {
-            button_data_[static_cast<int>(button)].SetThreshold(std::clamp(threshold, 0.0F, 1.0F));
+            button_data_.SetThreshold(static_cast<int>(button), std::clamp(threshold, 0.0F, 1.0F));
         }
     }
 
     void AggregateGamepad::SetGlobalThreshold(float threshold)
     {
         threshold = std::clamp(threshold, 0.0F, 1.0F);
-        for (unsigned int i = 0; i < NUM_BUTTON_CODES; i++) { button_data_[i].SetThreshold(threshold); }
+        for (unsigned int i = 0; i < NUM_BUTTON_CODES; i++) { button_data_.SetThreshold(i, threshold); }
     }
 
     float AggregateGamepad::GetButtonThreshold(const Button button) const
     {
         return IsValidButton(button)
-            ? button_data_[static_cast<int>(button)].Threshold()
+            ? button_data_.Threshold(static_cast<int>(button))
             : 0.0F;
     }
 
     float AggregateGamepad::GetButtonValue(const Button button) const
     {
         return (is_connected_ && IsValidButton(button))
-            ? button_data_[static_cast<int>(button)].Value()
+            ? button_data_.Value(static_cast<int>(button))
             : 0.0F;
     }
 
@@ -858,9 +1589,8 @@ namespace crossput
     {
         if (is_connected_ && IsValidButton(button))
         {
-            const TSTV &d = button_data_[static_cast<int>(button)];
-            time = TimestampDeltaSeconds(d.Timestamp(), last_update_timestamp_);
-            return d.State();
+            time = TimestampDeltaSeconds(button_data_.Timestamp(static_cast<int>(button)), last_update_timestamp_);
+            return button_data_.State(static_cast<int>(button));
         }
         else
         {
@@ -869,6 +1599,21 @@ namespace crossput
         }
     }
 
+    void AggregateGamepad::GetButtonStates(uint64_t *const states) const
+    {
+        button_data_.CopyStates(states, NUM_BUTTON_STATE_WORDS, is_connected_);
+    }
+
+    void AggregateGamepad::GetButtonValues(float *const values) const
+    {
+        button_data_.CopyValues(values, NUM_BUTTON_CODES, is_connected_);
+    }
+
+    void AggregateGamepad::GetButtonTimestamps(uint64_t *const timestamps) const
+    {
+        button_data_.CopyTimestamps(timestamps, NUM_BUTTON_CODES, is_connected_);
+    }
+
     uint32_t AggregateGamepad::GetThumbstickCount() const
     {
         return is_connected_ ? thumbstick_count_ : 0;
@@ -880,5 +1625,16 @@ namespace crossput
             ? thumbstick_values_[index]
             : std::make_pair(0.0F, 0.0F);
     }
+
+    uint32_t AggregateGamepad::GetThumbsticks(float *const xy, const uint32_t max_count) const
+    {
+        const uint32_t n = std::min(max_count, AggregateGamepad::GetThumbstickCount());
+        for (uint32_t i = 0; i < n; i++)
+        {
+            xy[i * 2] = thumbstick_values_[i].first;
+            xy[i * 2 + 1] = thumbstick_values_[i].second;
+        }
+        return n;
+    }
    #endif // CROSSPUT_FEATURE_AGGREGATE
 }
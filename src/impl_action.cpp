@@ -0,0 +1,308 @@
+/*================================================================================= *
+*                                   +----------+                                    *
+*                                   | crossput |                                    *
+*                                   +----------+                                    *
+*                            Copyright 2024 Trice Helix                             *
+*                                                                                   *
+* This file is part of crossput and is distributed under the BSD-3-Clause License.  *
+* Please refer to LICENSE.txt for additional information.                           *
+* =================================================================================*/
+
+#include "common.hpp"
+
+#include <cmath>
+
+
+namespace crossput
+{
+    // ACTION MAP
+
+    constexpr uint32_t MaxActionCode(const ActionSource source) noexcept
+    {
+        switch (source)
+        {
+        case ActionSource::KEY: return static_cast<uint32_t>(NUM_KEY_CODES);
+        case ActionSource::MOUSE_BUTTON: return static_cast<uint32_t>(MAX_TRACKED_MOUSE_BUTTONS);
+        case ActionSource::GAMEPAD_BUTTON: return static_cast<uint32_t>(NUM_BUTTON_CODES);
+        case ActionSource::THUMBSTICK_X:
+        case ActionSource::THUMBSTICK_Y: return DeviceSnapshot::MAX_THUMBSTICKS;
+        default: return 0;
+        }
+    }
+
+
+    class ActionMap final : public IActionMap, public MemoryManaged
+    {
+    private:
+        struct Binding
+        {
+            uint32_t action;
+            ID device_id;
+            ActionSource source;
+            uint32_t code;
+            float scale;
+        };
+
+        // bindings of a group only differ in action, offset and scale
+        struct CompiledBinding
+        {
+            uint32_t action;
+            uint32_t offset; // into the scratch values of the source
+            float scale;
+        };
+
+        // consecutive range of compiled bindings reading the same source of the same device
+        struct BindingGroup
+        {
+            ID device_id;
+            ActionSource source;
+            uint32_t begin;
+            uint32_t end;
+        };
+
+        static constexpr uint8_t FLAG_STATE = 1;
+        static constexpr uint8_t FLAG_PRESSED = 2;
+        static constexpr uint8_t FLAG_RELEASED = 4;
+
+        std::vector<std::string> names_;
+        std::vector<float> thresholds_;
+        std::vector<float> values_;
+        std::vector<uint8_t> flags_;
+        #ifdef CROSSPUT_FEATURE_CALLBACK
+        std::vector<ActionCallback> callbacks_;
+        #endif // CROSSPUT_FEATURE_CALLBACK
+
+        std::vector<Binding> bindings_;
+        std::vector<CompiledBinding> table_;
+        std::vector<BindingGroup> groups_;
+        bool is_compiled_ = true;
+
+        // values of the source of the current group, read via a single bulk getter
+        float scratch_[std::max(NUM_KEY_CODES, MAX_TRACKED_MOUSE_BUTTONS)];
+
+    public:
+        uint32_t AddAction(const std::string &name, const float threshold) override
+        {
+            ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+            names_.push_back(name);
+            thresholds_.push_back(std::clamp(threshold, 0.0F, 1.0F));
+            values_.push_back(0.0F);
+            flags_.push_back(0);
+            #ifdef CROSSPUT_FEATURE_CALLBACK
+            callbacks_.emplace_back();
+            #endif // CROSSPUT_FEATURE_CALLBACK
+            return static_cast<uint32_t>(names_.size() - 1);
+        }
+
+        uint32_t GetActionCount() const override { return static_cast<uint32_t>(names_.size()); }
+
+        bool FindAction(const std::string &name, uint32_t &action) const override
+        {
+            const auto it = std::find(names_.begin(), names_.end(), name);
+            if (it == names_.end()) { return false; }
+
+            action = static_cast<uint32_t>(it - names_.begin());
+            return true;
+        }
+
+        std::string GetActionName(const uint32_t action) const override
+        {
+            return action < names_.size() ? names_[action] : std::string();
+        }
+
+        bool Bind(const uint32_t action, const ID device_id, const ActionSource source, const uint32_t code, const float scale) override
+        {
+            ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+            if (action >= names_.size() || code >= MaxActionCode(source)) { return false; }
+
+            bindings_.push_back({.action = action, .device_id = device_id, .source = source, .code = code, .scale = scale});
+            is_compiled_ = false;
+            return true;
+        }
+
+        void ClearBindings(const uint32_t action) override
+        {
+            ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+            std::erase_if(bindings_, [action](const Binding &binding) { return binding.action == action; });
+            is_compiled_ = false;
+        }
+
+        void Evaluate() override
+        {
+            ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+            if (!is_compiled_) [[unlikely]] { Compile(); }
+
+            std::fill(values_.begin(), values_.end(), 0.0F);
+            for (const BindingGroup &group : groups_)
+            {
+                if (!ReadSource(group.device_id, group.source)) { continue; }
+
+                for (uint32_t i = group.begin; i < group.end; i++)
+                {
+                    const CompiledBinding &binding = table_[i];
+                    const float v = scratch_[binding.offset] * binding.scale;
+                    if (std::abs(v) > std::abs(values_[binding.action])) { values_[binding.action] = v; }
+                }
+            }
+
+            for (uint32_t action = 0; action < values_.size(); action++)
+            {
+                const bool old_state = (flags_[action] & FLAG_STATE) != 0;
+                const bool new_state = values_[action] != 0.0F && std::abs(values_[action]) >= thresholds_[action];
+                flags_[action] = (new_state ? FLAG_STATE : 0)
+                    | ((new_state && !old_state) ? FLAG_PRESSED : 0)
+                    | ((!new_state && old_state) ? FLAG_RELEASED : 0);
+
+                #ifdef CROSSPUT_FEATURE_CALLBACK
+                if (new_state != old_state && callbacks_[action]) [[unlikely]]
+                {
+                    const ManagementAPIBlock block;
+                    callbacks_[action](this, action, values_[action], new_state);
+                }
+                #endif // CROSSPUT_FEATURE_CALLBACK
+            }
+        }
+
+        float GetActionValue(const uint32_t action) const override { return action < values_.size() ? values_[action] : 0.0F; }
+        bool GetActionState(const uint32_t action) const override { return HasFlag(action, FLAG_STATE); }
+        bool WasActionPressed(const uint32_t action) const override { return HasFlag(action, FLAG_PRESSED); }
+        bool WasActionReleased(const uint32_t action) const override { return HasFlag(action, FLAG_RELEASED); }
+
+        #ifdef CROSSPUT_FEATURE_CALLBACK
+        bool SetActionCallback(const uint32_t action, ActionCallback &&callback) override
+        {
+            ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+            if (action >= callbacks_.size()) { return false; }
+
+            callbacks_[action] = std::move(callback);
+            return true;
+        }
+        #endif // CROSSPUT_FEATURE_CALLBACK
+
+        ~ActionMap() = default;
+
+    private:
+        constexpr bool HasFlag(const uint32_t action, const uint8_t flag) const noexcept
+        {
+            return action < flags_.size() && (flags_[action] & flag) != 0;
+        }
+
+        void Compile()
+        {
+            // order by device and source, so each group maps to a single bulk read
+            std::vector<Binding> sorted = bindings_;
+            std::stable_sort(sorted.begin(), sorted.end(), [](const Binding &a, const Binding &b)
+            {
+                return a.device_id.value != b.device_id.value ? a.device_id.value < b.device_id.value : a.source < b.source;
+            });
+
+            table_.clear();
+            groups_.clear();
+            table_.reserve(sorted.size());
+            for (const Binding &binding : sorted)
+            {
+                if (groups_.empty() || groups_.back().device_id != binding.device_id || groups_.back().source != binding.source)
+                {
+                    const uint32_t begin = static_cast<uint32_t>(table_.size());
+                    groups_.push_back({.device_id = binding.device_id, .source = binding.source, .begin = begin, .end = begin});
+                }
+
+                // thumbsticks are read as interleaved X/Y pairs
+                const uint32_t offset = binding.source == ActionSource::THUMBSTICK_X ? binding.code * 2
+                    : binding.source == ActionSource::THUMBSTICK_Y ? binding.code * 2 + 1
+                    : binding.code;
+
+                table_.push_back({.action = binding.action, .offset = offset, .scale = binding.scale});
+                groups_.back().end++;
+            }
+
+            is_compiled_ = true;
+        }
+
+        // returns false if the values of the source are unavailable
+        bool ReadSource(const ID device_id, const ActionSource source)
+        {
+            IDevice *const p_device = glob_devices.Find(device_id);
+            if (p_device == nullptr || !p_device->IsConnected()) { return false; }
+
+            switch (source)
+            {
+            case ActionSource::KEY:
+                {
+                    const IKeyboard *const p_keyboard = dynamic_cast<const IKeyboard *>(p_device);
+                    if (p_keyboard == nullptr) { return false; }
+                    p_keyboard->GetKeyValues(scratch_);
+                }
+                return true;
+
+            case ActionSource::MOUSE_BUTTON:
+                {
+                    const IMouse *const p_mouse = dynamic_cast<const IMouse *>(p_device);
+                    if (p_mouse == nullptr) { return false; }
+                    const uint32_t n = p_mouse->GetButtonValues(scratch_, static_cast<uint32_t>(MAX_TRACKED_MOUSE_BUTTONS));
+                    std::fill(scratch_ + n, scratch_ + MAX_TRACKED_MOUSE_BUTTONS, 0.0F);
+                }
+                return true;
+
+            case ActionSource::GAMEPAD_BUTTON:
+                {
+                    const IGamepad *const p_gamepad = dynamic_cast<const IGamepad *>(p_device);
+                    if (p_gamepad == nullptr) { return false; }
+                    p_gamepad->GetButtonValues(scratch_);
+                }
+                return true;
+
+            case ActionSource::THUMBSTICK_X:
+            case ActionSource::THUMBSTICK_Y:
+                {
+                    const IGamepad *const p_gamepad = dynamic_cast<const IGamepad *>(p_device);
+                    if (p_gamepad == nullptr) { return false; }
+                    const uint32_t n = p_gamepad->GetThumbsticks(scratch_, DeviceSnapshot::MAX_THUMBSTICKS);
+                    std::fill(scratch_ + n * 2, scratch_ + DeviceSnapshot::MAX_THUMBSTICKS * 2, 0.0F);
+                }
+                return true;
+
+            default:
+                return false;
+            }
+        }
+    };
+
+
+    std::vector<ActionMap *> glob_action_maps;
+
+
+    void EvaluateActionMaps()
+    {
+        for (ActionMap *const p_map : glob_action_maps) { p_map->Evaluate(); }
+    }
+
+
+    // GLOBAL ACTION API
+
+    IActionMap *CreateActionMap()
+    {
+        ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+        ActionMap *const p_map = new ActionMap();
+        glob_action_maps.push_back(p_map);
+        return p_map;
+    }
+
+
+    void DestroyActionMap(IActionMap *const p_map)
+    {
+        ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+        const auto it = std::find(glob_action_maps.begin(), glob_action_maps.end(), p_map);
+        if (it == glob_action_maps.end()) { return; }
+
+        delete *it;
+        glob_action_maps.erase(it);
+    }
+}
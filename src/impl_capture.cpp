@@ -0,0 +1,792 @@
+/*================================================================================= *
+*                                   +----------+                                    *
+*                                   | crossput |                                    *
+*                                   +----------+                                    *
+*                            Copyright 2024 Trice Helix                             *
+*                                                                                   *
+* This file is part of crossput and is distributed under the BSD-3-Clause License.  *
+* Please refer to LICENSE.txt for additional information.                           *
+* =================================================================================*/
+
+#include "common.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+
+namespace crossput
+{
+    // CAPTURE WRITER
+
+    class CaptureWriter
+    {
+    private:
+        static constexpr size_t BUFFER_SIZE = 1 << 16;
+
+        std::FILE *p_file_ = nullptr;
+        std::unique_ptr<char[]> buffer_;
+        std::unordered_map<ID, uint32_t> device_indices_;
+
+    public:
+        CaptureWriter(const std::string &path) : buffer_(std::make_unique<char[]>(BUFFER_SIZE))
+        {
+            p_file_ = std::fopen(path.c_str(), "wb");
+            if (p_file_ == nullptr)
+            {
+                throw std::runtime_error(std::format("Failed to open capture file \"{}\" (errno {}).", path, errno));
+            }
+
+            std::setvbuf(p_file_, buffer_.get(), _IOFBF, BUFFER_SIZE);
+
+            CaptureHeader header = {};
+            std::memcpy(header.magic, CAPTURE_MAGIC, sizeof(header.magic));
+            header.version = CAPTURE_VERSION;
+            header.record_size = sizeof(CaptureRecord);
+            std::fwrite(&header, sizeof(header), 1, p_file_);
+        }
+
+        CaptureWriter(const CaptureWriter &) = delete;
+        CaptureWriter &operator=(const CaptureWriter &) = delete;
+
+        ~CaptureWriter()
+        {
+            if (p_file_ != nullptr) { std::fclose(p_file_); }
+        }
+
+        void Write(const IDevice *const p_device, const CaptureRecordKind kind, const uint8_t detail, const InputEvent &ev)
+        {
+            CaptureRecord record = {.device = DeviceIndex(p_device, ev.timestamp), .kind = kind, .detail = detail, .reserved = 0, .event = ev};
+            std::fwrite(&record, sizeof(record), 1, p_file_);
+        }
+
+        // returns false if any data could not be written
+        bool Close()
+        {
+            const bool ok = std::ferror(p_file_) == 0;
+            const bool closed = std::fclose(p_file_) == 0;
+            p_file_ = nullptr;
+            return ok && closed;
+        }
+
+    private:
+        uint32_t DeviceIndex(const IDevice *const p_device, const timestamp_t timestamp)
+        {
+            const auto [it, inserted] = device_indices_.try_emplace(p_device->GetID(), static_cast<uint32_t>(device_indices_.size()));
+            if (inserted) [[unlikely]]
+            {
+                // announce device before its first record
+                CaptureRecord record = {.device = it->second, .kind = CaptureRecordKind::DEVICE, .detail = static_cast<uint8_t>(p_device->GetType())};
+                record.event.timestamp = timestamp;
+                std::fwrite(&record, sizeof(record), 1, p_file_);
+            }
+            return it->second;
+        }
+    };
+
+
+    CaptureWriter *glob_p_capture = nullptr;
+
+
+    void CaptureEvent(const IDevice *const p_device, const InputEvent &ev) noexcept
+    {
+        try { glob_p_capture->Write(p_device, CaptureRecordKind::EVENT, 0, ev); }
+        catch (...) {} // record is lost, which is reported by StopCapture()
+    }
+
+
+    void CaptureStatus(const IDevice *const p_device, const DeviceStatusChange status) noexcept
+    {
+        InputEvent ev = {};
+        ev.timestamp = NowTimestamp();
+
+        try { glob_p_capture->Write(p_device, CaptureRecordKind::STATUS, static_cast<uint8_t>(status), ev); }
+        catch (...) {}
+    }
+
+
+    bool StartCapture(const std::string &path)
+    {
+        ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+        if (glob_p_capture != nullptr) { return false; }
+
+        glob_p_capture = new CaptureWriter(path);
+        return true;
+    }
+
+
+    void StopCapture()
+    {
+        ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+        if (glob_p_capture == nullptr) { return; }
+
+        CaptureWriter *const p_capture = glob_p_capture;
+        glob_p_capture = nullptr;
+
+        const bool ok = p_capture->Close();
+        delete p_capture;
+
+        if (!ok) { throw std::runtime_error("Failed to write capture file completely."); }
+    }
+
+
+    bool IsCapturing()
+    {
+        return glob_p_capture != nullptr;
+    }
+
+
+    // MAPPED CAPTURE
+
+    // read-only view of a capture file, shared by all of its replay devices
+    class MappedCapture
+    {
+    private:
+        const void *p_data_ = nullptr;
+        size_t size_ = 0;
+        const CaptureRecord *p_records_ = nullptr;
+        size_t record_count_ = 0;
+        #ifdef _WIN32
+        HANDLE file_ = INVALID_HANDLE_VALUE;
+        HANDLE mapping_ = nullptr;
+        #endif // _WIN32
+
+    public:
+        MappedCapture(const std::string &path)
+        {
+            #ifdef _WIN32
+            file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file_ == INVALID_HANDLE_VALUE)
+            {
+                throw std::runtime_error(std::format("Failed to open capture file \"{}\" (error {}).", path, GetLastError()));
+            }
+
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(file_, &size)) { Fail(path, GetLastError()); }
+            size_ = static_cast<size_t>(size.QuadPart);
+
+            if (size_ > 0)
+            {
+                mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (mapping_ == nullptr) { Fail(path, GetLastError()); }
+
+                p_data_ = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+                if (p_data_ == nullptr) { Fail(path, GetLastError()); }
+            }
+            #else
+            const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+            {
+                throw std::runtime_error(std::format("Failed to open capture file \"{}\" (errno {}).", path, errno));
+            }
+
+            struct stat st;
+            if (fstat(fd, &st) < 0)
+            {
+                const int e = errno;
+                close(fd);
+                Fail(path, e);
+            }
+            size_ = static_cast<size_t>(st.st_size);
+
+            if (size_ > 0)
+            {
+                void *const p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                const int e = errno;
+                close(fd); // mapping stays valid
+                if (p == MAP_FAILED) { Fail(path, e); }
+                p_data_ = p;
+            }
+            else
+            {
+                close(fd);
+            }
+            #endif // _WIN32
+
+            // validate
+            CaptureHeader header;
+            if (size_ < sizeof(header)) { Fail(path, 0); }
+            std::memcpy(&header, p_data_, sizeof(header));
+            if (std::memcmp(header.magic, CAPTURE_MAGIC, sizeof(header.magic)) != 0
+                || header.version != CAPTURE_VERSION
+                || header.record_size != sizeof(CaptureRecord))
+            {
+                Fail(path, 0);
+            }
+
+            // the header keeps records aligned, a truncated last record is ignored
+            p_records_ = reinterpret_cast<const CaptureRecord *>(static_cast<const unsigned char *>(p_data_) + sizeof(CaptureHeader));
+            record_count_ = (size_ - sizeof(CaptureHeader)) / sizeof(CaptureRecord);
+        }
+
+        MappedCapture(const MappedCapture &) = delete;
+        MappedCapture &operator=(const MappedCapture &) = delete;
+
+        ~MappedCapture() { Unmap(); }
+
+        constexpr const CaptureRecord *Records() const noexcept { return p_records_; }
+        constexpr size_t RecordCount() const noexcept { return record_count_; }
+
+    private:
+        void Unmap() noexcept
+        {
+            #ifdef _WIN32
+            if (p_data_ != nullptr) { UnmapViewOfFile(p_data_); }
+            if (mapping_ != nullptr) { CloseHandle(mapping_); }
+            if (file_ != INVALID_HANDLE_VALUE) { CloseHandle(file_); }
+            mapping_ = nullptr;
+            file_ = INVALID_HANDLE_VALUE;
+            #else
+            if (p_data_ != nullptr) { munmap(const_cast<void *>(p_data_), size_); }
+            #endif // _WIN32
+            p_data_ = nullptr;
+        }
+
+        [[noreturn]] void Fail(const std::string &path, const unsigned long error)
+        {
+            Unmap();
+            throw error != 0
+                ? std::runtime_error(std::format("Failed to map capture file \"{}\" (error {}).", path, error))
+                : std::runtime_error(std::format("File \"{}\" is not a valid crossput capture.", path));
+        }
+    };
+
+
+    // REPLAY DEVICE
+
+    // implements:
+    // IDevice::GetDisplayName()
+    // IDevice::Update()
+    // and streams the captured records of a single device
+    class ReplayDevice :
+        public virtual BaseInterface,
+        public virtual DeviceCallbackManager,
+        public virtual DeviceForceManagerEmpty
+    {
+    protected:
+        const std::shared_ptr<const MappedCapture> p_capture_;
+        const std::vector<uint32_t> records_; // indices of records belonging to this device
+        size_t cursor_ = 0;
+        const uint32_t source_index_;
+        const ReplayMode mode_;
+        timestamp_t first_timestamp_ = 0;
+        timestamp_t start_timestamp_ = 0;
+        timestamp_t last_update_timestamp_ = 0;
+
+    public:
+        ReplayDevice(std::shared_ptr<const MappedCapture> p_capture, std::vector<uint32_t> &&records, const uint32_t source_index, const ReplayMode mode) :
+            p_capture_(std::move(p_capture)),
+            records_(std::move(records)),
+            source_index_(source_index),
+            mode_(mode)
+        {
+            if (!records_.empty()) { first_timestamp_ = p_capture_->Records()[records_.front()].event.timestamp; }
+        }
+
+        #ifdef CROSSPUT_FEATURE_AGGREGATE
+        constexpr bool IsAggregate() const noexcept override final { return false; }
+        #endif // CROSSPUT_FEATURE_AGGREGATE
+
+        std::string GetDisplayName() const override
+        {
+            return std::format("Replay #{}", source_index_);
+        }
+
+        void Update() override final
+        {
+            ProtectManagementAPI("crossput::IDevice::Update()", id_);
+            CROSSPUT_STATS_TIME_UPDATE();
+            MarkServiced();
+
+            const timestamp_t now = NowTimestamp();
+            if (start_timestamp_ == 0) [[unlikely]]
+            {
+                // first update starts the replay
+                start_timestamp_ = now;
+                last_update_timestamp_ = now;
+                SetConnected(true);
+            }
+
+            if (cursor_ >= records_.size())
+            {
+                // everything has been replayed
+                SetConnected(false);
+                return;
+            }
+
+            PreReplay();
+
+            const CaptureRecord *const p_records = p_capture_->Records();
+            const bool real_time = mode_ == ReplayMode::REAL_TIME;
+            const timestamp_t deadline = first_timestamp_ + (now - start_timestamp_);
+            uint32_t budget = read_batch_size_;
+
+            while (cursor_ < records_.size())
+            {
+                const CaptureRecord &record = p_records[records_[cursor_]];
+                if (real_time ? (record.event.timestamp > deadline) : (budget-- == 0)) { break; }
+                cursor_++;
+
+                // move captured time span to the start of the replay
+                const timestamp_t timestamp = record.event.timestamp - first_timestamp_ + start_timestamp_;
+                if (record.kind == CaptureRecordKind::STATUS)
+                {
+                    const DeviceStatusChange status = static_cast<DeviceStatusChange>(record.detail);
+                    if (status == DeviceStatusChange::CONNECTED) { SetConnected(true); }
+                    else if (status == DeviceStatusChange::DISCONNECTED) { SetConnected(false); }
+                }
+                else if (record.kind == CaptureRecordKind::EVENT && is_connected_)
+                {
+                    CROSSPUT_STATS_ADD(events_read, 1);
+                    ReplayEvent(record.event, timestamp);
+                }
+
+                if (!real_time) { last_update_timestamp_ = std::max(last_update_timestamp_, timestamp); }
+            }
+
+            if (real_time) { last_update_timestamp_ = now; }
+        }
+
+    protected:
+        // invoked before replaying the records of a single update
+        virtual void PreReplay() = 0;
+        virtual void ReplayEvent(const InputEvent &ev, const timestamp_t timestamp) = 0;
+        virtual void OnDisconnected() = 0;
+
+    private:
+        void SetConnected(const bool connected)
+        {
+            if (connected == is_connected_) { return; }
+
+            is_connected_ = connected;
+            if (!connected) { OnDisconnected(); }
+            DeviceStatusChanged(this, connected ? DeviceStatusChange::CONNECTED : DeviceStatusChange::DISCONNECTED);
+        }
+    };
+
+
+    class ReplayMouse final :
+        public virtual IMouse,
+        public virtual ReplayDevice,
+        public virtual TypedInterface<DeviceType::MOUSE>,
+        public virtual MouseCallbackManager
+    {
+    public:
+        static constexpr uint32_t MAX_BUTTONS = 32;
+
+    private:
+        MouseData data_ = {};
+        StateArray<MAX_BUTTONS> button_data_ = {};
+        const uint32_t button_count_;
+
+    public:
+        ReplayMouse(std::shared_ptr<const MappedCapture> p_capture, std::vector<uint32_t> &&records, const uint32_t source_index, const ReplayMode mode, const uint32_t button_count) :
+            ReplayDevice(std::move(p_capture), std::move(records), source_index, mode),
+            button_count_(std::min(button_count, MAX_BUTTONS))
+            {}
+
+        void GetPosition(int64_t &x, int64_t &y) const override
+        {
+            if (!is_connected_) { return; }
+            x = data_.x;
+            y = data_.y;
+        }
+
+        void GetDelta(int64_t &x, int64_t &y) const override
+        {
+            if (!is_connected_) { return; }
+            x = data_.dx;
+            y = data_.dy;
+        }
+
+        void GetScroll(int64_t &x, int64_t &y) const override
+        {
+            if (!is_connected_) { return; }
+            x = data_.sx;
+            y = data_.sy;
+        }
+
+        void GetScrollDelta(int64_t &x, int64_t &y) const override
+        {
+            if (!is_connected_) { return; }
+            x = data_.sdx;
+            y = data_.sdy;
+        }
+
+        uint32_t GetButtonCount() const override { return is_connected_ ? button_count_ : 0; }
+
+        void SetButtonThreshold(const uint32_t index, float threshold) override
+        {
+            if (index < button_count_) { button_data_.SetThreshold(index, std::clamp(threshold, 0.0F, 1.0F)); }
+        }
+
+        void SetGlobalThreshold(float threshold) override
+        {
+            threshold = std::clamp(threshold, 0.0F, 1.0F);
+            for (uint32_t i = 0; i < button_count_; i++) { button_data_.SetThreshold(i, threshold); }
+        }
+
+        float GetButtonThreshold(const uint32_t index) const override
+        {
+            return index < button_count_ ? button_data_.Threshold(index) : 0.0F;
+        }
+
+        float GetButtonValue(const uint32_t index) const override
+        {
+            return (is_connected_ && index < button_count_) ? button_data_.Value(index) : 0.0F;
+        }
+
+        bool GetButtonState(const uint32_t index, float &time) const override
+        {
+            if (is_connected_ && index < button_count_)
+            {
+                time = TimestampDeltaSeconds(button_data_.Timestamp(index), last_update_timestamp_);
+                return button_data_.State(index);
+            }
+            else
+            {
+                time = std::numeric_limits<float>::infinity();
+                return false;
+            }
+        }
+
+        StateView GetButtonView() const override { return button_data_.View(is_connected_); }
+        void GetButtonStates(uint64_t *const states, const size_t num_words) const override
+        {
+            button_data_.CopyStates(states, num_words, is_connected_);
+        }
+
+        uint32_t GetButtonValues(float *const values, const uint32_t max_count) const override
+        {
+            const uint32_t n = std::min(max_count, ReplayMouse::GetButtonCount());
+            button_data_.CopyValues(values, n, is_connected_);
+            return n;
+        }
+
+        uint32_t GetButtonTimestamps(uint64_t *const timestamps, const uint32_t max_count) const override
+        {
+            const uint32_t n = std::min(max_count, ReplayMouse::GetButtonCount());
+            button_data_.CopyTimestamps(timestamps, n, is_connected_);
+            return n;
+        }
+
+    private:
+        void PreReplay() override
+        {
+            data_.dx = 0;
+            data_.dy = 0;
+            data_.sdx = 0;
+            data_.sdy = 0;
+        }
+
+        void ReplayEvent(const InputEvent &ev, const timestamp_t timestamp) override
+        {
+            switch (ev.type)
+            {
+            case InputEventType::MOUSE_MOVE:
+                data_.x += ev.delta.dx;
+                data_.y += ev.delta.dy;
+                data_.dx += ev.delta.dx;
+                data_.dy += ev.delta.dy;
+                MouseMoved(data_.x, data_.y, ev.delta.dx, ev.delta.dy, timestamp);
+                break;
+
+            case InputEventType::MOUSE_SCROLL:
+                data_.sx += ev.delta.dx;
+                data_.sy += ev.delta.dy;
+                data_.sdx += ev.delta.dx;
+                data_.sdy += ev.delta.dy;
+                MouseScrolled(data_.sx, data_.sy, ev.delta.dx, ev.delta.dy, timestamp);
+                break;
+
+            case InputEventType::MOUSE_BUTTON:
+                if (ev.code < button_count_)
+                {
+                    bool state;
+                    if (button_data_.Modify(ev.code, ev.value, timestamp, state)) { ButtonChanged(ev.code, ev.value, state, timestamp); }
+                }
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        void OnDisconnected() override
+        {
+            data_ = {};
+            button_data_.Reset();
+        }
+    };
+
+
+    class ReplayKeyboard final :
+        public virtual IKeyboard,
+        public virtual ReplayDevice,
+        public virtual TypedInterface<DeviceType::KEYBOARD>,
+        public virtual KeyboardCallbackManager
+    {
+    private:
+        StateArray<NUM_KEY_CODES> key_data_ = {};
+        uint32_t num_keys_pressed_ = 0;
+
+    public:
+        ReplayKeyboard(std::shared_ptr<const MappedCapture> p_capture, std::vector<uint32_t> &&records, const uint32_t source_index, const ReplayMode mode) :
+            ReplayDevice(std::move(p_capture), std::move(records), source_index, mode)
+            {}
+
+        uint32_t GetNumKeysPressed() const override { return is_connected_ ? num_keys_pressed_ : 0; }
+
+        void SetKeyThreshold(const Key key, float threshold) override
+        {
+            if (IsValidKey(key)) { key_data_.SetThreshold(static_cast<int>(key), std::clamp(threshold, 0.0F, 1.0F)); }
+        }
+
+        void SetGlobalThreshold(float threshold) override
+        {
+            threshold = std::clamp(threshold, 0.0F, 1.0F);
+            for (unsigned int i = 0; i < NUM_KEY_CODES; i++) { key_data_.SetThreshold(i, threshold); }
+        }
+
+        float GetKeyThreshold(const Key key) const override
+        {
+            return IsValidKey(key) ? key_data_.Threshold(static_cast<int>(key)) : 0.0F;
+        }
+
+        float GetKeyValue(const Key key) const override
+        {
+            return (is_connected_ && IsValidKey(key)) ? key_data_.Value(static_cast<int>(key)) : 0.0F;
+        }
+
+        bool GetKeyState(const Key key, float &time) const override
+        {
+            if (is_connected_ && IsValidKey(key))
+            {
+                time = TimestampDeltaSeconds(key_data_.Timestamp(static_cast<int>(key)), last_update_timestamp_);
+                return key_data_.State(static_cast<int>(key));
+            }
+            else
+            {
+                time = std::numeric_limits<float>::infinity();
+                return false;
+            }
+        }
+
+        StateView GetKeyView() const override { return key_data_.View(is_connected_); }
+        void GetKeyStates(uint64_t *const states) const override { key_data_.CopyStates(states, NUM_KEY_STATE_WORDS, is_connected_); }
+        void GetKeyValues(float *const values) const override { key_data_.CopyValues(values, NUM_KEY_CODES, is_connected_); }
+        void GetKeyTimestamps(uint64_t *const timestamps) const override { key_data_.CopyTimestamps(timestamps, NUM_KEY_CODES, is_connected_); }
+
+    private:
+        void PreReplay() override {}
+
+        void ReplayEvent(const InputEvent &ev, const timestamp_t timestamp) override
+        {
+            if (ev.type != InputEventType::KEYBOARD_KEY || !IsValidKey(static_cast<Key>(ev.code))) { return; }
+
+            bool state;
+            if (key_data_.Modify(ev.code, ev.value, timestamp, state, num_keys_pressed_)) { KeyChanged(static_cast<Key>(ev.code), ev.value, state, timestamp); }
+        }
+
+        void OnDisconnected() override
+        {
+            key_data_.Reset();
+            num_keys_pressed_ = 0;
+        }
+    };
+
+
+    class ReplayGamepad final :
+        public virtual IGamepad,
+        public virtual ReplayDevice,
+        public virtual TypedInterface<DeviceType::GAMEPAD>,
+        public virtual GamepadCallbackManager,
+        public virtual GamepadProfileManager
+    {
+    public:
+        static constexpr uint32_t MAX_THUMBSTICKS = 8;
+
+    private:
+        StateArray<NUM_BUTTON_CODES> button_data_ = {};
+        std::pair<float, float> thumbstick_values_[MAX_THUMBSTICKS] = {};
+        const uint32_t thumbstick_count_;
+
+    public:
+        ReplayGamepad(std::shared_ptr<const MappedCapture> p_capture, std::vector<uint32_t> &&records, const uint32_t source_index, const ReplayMode mode, const uint32_t thumbstick_count) :
+            ReplayDevice(std::move(p_capture), std::move(records), source_index, mode),
+            thumbstick_count_(std::min(thumbstick_count, MAX_THUMBSTICKS))
+            {}
+
+        void SetButtonThreshold(const Button button, float threshold) override
+        {
+            if (IsValidButton(button)) { button_data_.SetThreshold(static_cast<int>(button), std::clamp(threshold, 0.0F, 1.0F)); }
+        }
+
+        void SetGlobalThreshold(float threshold) override
+        {
+            threshold = std::clamp(threshold, 0.0F, 1.0F);
+            for (unsigned int i = 0; i < NUM_BUTTON_CODES; i++) { button_data_.SetThreshold(i, threshold); }
+        }
+
+        float GetButtonThreshold(const Button button) const override
+        {
+            return IsValidButton(button) ? button_data_.Threshold(static_cast<int>(button)) : 0.0F;
+        }
+
+        float GetButtonValue(const Button button) const override
+        {
+            return (is_connected_ && IsValidButton(button)) ? button_data_.Value(static_cast<int>(button)) : 0.0F;
+        }
+
+        bool GetButtonState(const Button button, float &time) const override
+        {
+            if (is_connected_ && IsValidButton(button))
+            {
+                time = TimestampDeltaSeconds(button_data_.Timestamp(static_cast<int>(button)), last_update_timestamp_);
+                return button_data_.State(static_cast<int>(button));
+            }
+            else
+            {
+                time = std::numeric_limits<float>::infinity();
+                return false;
+            }
+        }
+
+        StateView GetButtonView() const override { return button_data_.View(is_connected_); }
+        void GetButtonStates(uint64_t *const states) const override { button_data_.CopyStates(states, NUM_BUTTON_STATE_WORDS, is_connected_); }
+        void GetButtonValues(float *const values) const override { button_data_.CopyValues(values, NUM_BUTTON_CODES, is_connected_); }
+        void GetButtonTimestamps(uint64_t *const timestamps) const override { button_data_.CopyTimestamps(timestamps, NUM_BUTTON_CODES, is_connected_); }
+
+        uint32_t GetThumbstickCount() const override { return is_connected_ ? thumbstick_count_ : 0; }
+
+        void GetThumbstick(const uint32_t index, float &x, float &y) const override
+        {
+            std::tie(x, y) = (is_connected_ && index < thumbstick_count_)
+                ? thumbstick_values_[index]
+                : std::make_pair(0.0F, 0.0F);
+        }
+
+        uint32_t GetThumbsticks(float *const xy, const uint32_t max_count) const override
+        {
+            const uint32_t n = std::min(max_count, ReplayGamepad::GetThumbstickCount());
+            for (uint32_t i = 0; i < n; i++)
+            {
+                xy[i * 2] = thumbstick_values_[i].first;
+                xy[i * 2 + 1] = thumbstick_values_[i].second;
+            }
+            return n;
+        }
+
+    private:
+        void PreReplay() override {}
+
+        void ReplayEvent(const InputEvent &ev, const timestamp_t timestamp) override
+        {
+            if (ev.type == InputEventType::GAMEPAD_BUTTON && IsValidButton(static_cast<Button>(ev.code)))
+            {
+                const float value = ProcessButton(static_cast<Button>(ev.code), ev.value);
+                bool state;
+                if (button_data_.Modify(ev.code, value, timestamp, state)) { ButtonChanged(static_cast<Button>(ev.code), value, state, timestamp); }
+            }
+            else if (ev.type == InputEventType::GAMEPAD_THUMBSTICK && ev.code < thumbstick_count_)
+            {
+                float x = ev.axes.x;
+                float y = ev.axes.y;
+                ProcessThumbstick(ev.code, x, y);
+                if (std::make_pair(x, y) == thumbstick_values_[ev.code]) { return; }
+
+                thumbstick_values_[ev.code] = {x, y};
+                ThumbstickChanged(ev.code, x, y, timestamp);
+            }
+        }
+
+        void OnDisconnected() override
+        {
+            button_data_.Reset();
+            std::fill(std::begin(thumbstick_values_), std::end(thumbstick_values_), std::make_pair(0.0F, 0.0F));
+            ResetRawThumbsticks();
+        }
+    };
+
+
+    // GLOBAL CAPTURE API
+
+    size_t CreateReplayDevices(const std::string &path, const ReplayMode mode, std::vector<IDevice *> &devices)
+    {
+        ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+        const auto p_capture = std::make_shared<const MappedCapture>(path);
+        const CaptureRecord *const p_records = p_capture->Records();
+
+        // split records by source device
+        struct Source
+        {
+            DeviceType type = DeviceType::UNKNOWN;
+            uint32_t num_buttons = 0;
+            uint32_t num_thumbsticks = 0;
+            std::vector<uint32_t> records;
+        };
+
+        std::vector<Source> sources;
+        for (size_t i = 0; i < p_capture->RecordCount(); i++)
+        {
+            const CaptureRecord &record = p_records[i];
+
+            // devices are numbered in order of their announcement, which precedes all of their records
+            if (record.device > sources.size() || (record.device == sources.size() && record.kind != CaptureRecordKind::DEVICE))
+            {
+                throw std::runtime_error(std::format("File \"{}\" is not a valid crossput capture.", path));
+            }
+            if (record.device == sources.size()) { sources.emplace_back(); }
+
+            Source &source = sources[record.device];
+            if (record.kind == CaptureRecordKind::DEVICE)
+            {
+                source.type = static_cast<DeviceType>(record.detail);
+                continue;
+            }
+
+            source.records.push_back(static_cast<uint32_t>(i));
+            if (record.kind != CaptureRecordKind::EVENT) { continue; }
+
+            // capabilities are deduced from the captured input
+            if (record.event.type == InputEventType::MOUSE_BUTTON) { source.num_buttons = std::max(source.num_buttons, record.event.code + 1U); }
+            else if (record.event.type == InputEventType::GAMEPAD_THUMBSTICK) { source.num_thumbsticks = std::max(source.num_thumbsticks, record.event.code + 1U); }
+        }
+
+        size_t num = 0;
+        for (uint32_t i = 0; i < sources.size(); i++)
+        {
+            Source &source = sources[i];
+
+            BaseInterface *p_vdev;
+            switch (source.type)
+            {
+            case DeviceType::MOUSE: p_vdev = new ReplayMouse(p_capture, std::move(source.records), i, mode, source.num_buttons); break;
+            case DeviceType::KEYBOARD: p_vdev = new ReplayKeyboard(p_capture, std::move(source.records), i, mode); break;
+            case DeviceType::GAMEPAD: p_vdev = new ReplayGamepad(p_capture, std::move(source.records), i, mode, source.num_thumbsticks); break;
+            default: continue; // unknown or missing device record
+            }
+
+            glob_devices.Register(p_vdev);
+            DeviceStatusChanged(p_vdev, DeviceStatusChange::DISCOVERED);
+
+            devices.push_back(p_vdev);
+            num++;
+        }
+
+        return num;
+    }
+}
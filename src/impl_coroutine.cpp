@@ -0,0 +1,150 @@
+/*================================================================================= *
+*                                   +----------+                                    *
+*                                   | crossput |                                    *
+*                                   +----------+                                    *
+*                            Copyright 2024 Trice Helix                             *
+*                                                                                   *
+* This file is part of crossput and is distributed under the BSD-3-Clause License.  *
+* Please refer to LICENSE.txt for additional information.                           *
+* =================================================================================*/
+
+#include "common.hpp"
+
+
+#ifdef CROSSPUT_COROUTINES
+namespace crossput
+{
+    WaiterList glob_waiters[NUM_CALLBACK_TYPES] = {};
+    WaiterList glob_ready_waiters = {};
+    WaiterList glob_ready_status_waiters = {};
+
+
+    // WAITER LISTS
+
+    inline void PushBack(WaiterList &list, impl::_InputWaiter &waiter) noexcept
+    {
+        waiter.p_prev = list.p_tail;
+        waiter.p_next = nullptr;
+        waiter.p_list = &list;
+        if (list.p_tail != nullptr) { list.p_tail->p_next = &waiter; }
+        else { list.p_head = &waiter; }
+        list.p_tail = &waiter;
+    }
+
+
+    inline void Remove(impl::_InputWaiter &waiter) noexcept
+    {
+        WaiterList &list = *static_cast<WaiterList *>(waiter.p_list);
+        if (waiter.p_prev != nullptr) { waiter.p_prev->p_next = waiter.p_next; }
+        else { list.p_head = waiter.p_next; }
+        if (waiter.p_next != nullptr) { waiter.p_next->p_prev = waiter.p_prev; }
+        else { list.p_tail = waiter.p_prev; }
+
+        waiter.p_prev = nullptr;
+        waiter.p_next = nullptr;
+        waiter.p_list = nullptr;
+    }
+
+
+    void WakeWaiters(const unsigned short ctypeid, const IDevice *const p_device, const uint32_t code, const float value)
+    {
+        // status changes are never deferred, like status callbacks, and must not resume waiters of deferred input
+        const bool is_status = ctypeid == impl::_StatusCallback::CTYPEID;
+        WaiterList &ready = is_status ? glob_ready_status_waiters : glob_ready_waiters;
+
+        const ID device_id = p_device->GetID();
+        impl::_InputWaiter *p_waiter = glob_waiters[ctypeid].p_head;
+        while (p_waiter != nullptr)
+        {
+            impl::_InputWaiter *const p_next = p_waiter->p_next;
+            if ((p_waiter->device_id.value == 0 || p_waiter->device_id == device_id) && (p_waiter->code == impl::_ANY_CODE || p_waiter->code == code))
+            {
+                p_waiter->wakeup = {.p_device = p_device, .code = code, .value = value};
+                Remove(*p_waiter);
+                PushBack(ready, *p_waiter);
+            }
+            p_waiter = p_next;
+        }
+
+        if (is_status || glob_callback_delivery == CallbackDelivery::IMMEDIATE) { ResumeReadyWaiters(ready); }
+    }
+
+
+    size_t ResumeReadyWaiters(WaiterList &list)
+    {
+        // waiters are unlinked one at a time, so the remaining ones survive an exception thrown by a coroutine
+        const ManagementAPIBlock block;
+        size_t num = 0;
+        while (list.p_head != nullptr)
+        {
+            impl::_InputWaiter &waiter = *list.p_head;
+            Remove(waiter);
+            num++;
+            waiter.handle.resume();
+        }
+
+        return num;
+    }
+
+
+    void OrphanReadyWaiters(const IDevice *const p_device) noexcept
+    {
+        for (WaiterList *const p_list : {&glob_ready_waiters, &glob_ready_status_waiters})
+        {
+            for (impl::_InputWaiter *p_waiter = p_list->p_head; p_waiter != nullptr; p_waiter = p_waiter->p_next)
+            {
+                if (p_waiter->wakeup.p_device == p_device) { p_waiter->wakeup.p_device = nullptr; }
+            }
+        }
+    }
+
+
+    void impl::_SuspendWaiter(_InputWaiter &waiter)
+    {
+        if (waiter.ctypeid >= NUM_CALLBACK_TYPES || waiter.p_list != nullptr)
+        {
+            throw std::runtime_error(std::format("{}: invalid or already awaited InputAwaitable", CROSSPUT_FUNCTION_STR));
+        }
+
+        PushBack(glob_waiters[waiter.ctypeid], waiter);
+    }
+
+
+    void impl::_CancelWaiter(_InputWaiter &waiter) noexcept
+    {
+        if (waiter.p_list != nullptr) { Remove(waiter); }
+    }
+
+
+    // GLOBAL COROUTINE API
+
+    inline ID DeviceOrAny(const IDevice *const p_device)
+    {
+        return p_device != nullptr ? p_device->GetID() : ID{0};
+    }
+
+
+    InputAwaitable NextMouseButtonPress(const IMouse *const p_mouse, const uint32_t index)
+    {
+        return InputAwaitable(DeviceOrAny(p_mouse), impl::_MouseButtonCallback::CTYPEID, index);
+    }
+
+
+    InputAwaitable NextKeyPress(const IKeyboard *const p_keyboard, const Key key)
+    {
+        return InputAwaitable(DeviceOrAny(p_keyboard), impl::_KeyboardKeyCallback::CTYPEID, IsValidKey(key) ? static_cast<uint32_t>(key) : impl::_ANY_CODE);
+    }
+
+
+    InputAwaitable NextButtonPress(const IGamepad *const p_gamepad, const Button button)
+    {
+        return InputAwaitable(DeviceOrAny(p_gamepad), impl::_GamepadButtonCallback::CTYPEID, IsValidButton(button) ? static_cast<uint32_t>(button) : impl::_ANY_CODE);
+    }
+
+
+    InputAwaitable NextStatusChange(const DeviceStatusChange status, const IDevice *const p_device)
+    {
+        return InputAwaitable(DeviceOrAny(p_device), impl::_StatusCallback::CTYPEID, static_cast<uint32_t>(status));
+    }
+}
+#endif // CROSSPUT_COROUTINES
@@ -10,24 +10,35 @@
 
 #include "common.hpp"
 
+#include <atomic>
+#include <cmath>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <filesystem>
 #include <format>
 #include <fstream>
 #include <iostream>
-#include <regex>
+#include <limits>
+#include <thread>
 #include <unordered_set>
 #include <errno.h>
 #include <fcntl.h>
 #include <time.h>
 #include <unistd.h>
 #include <linux/input.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
 #include <sys/ioctl.h>
+#ifdef CROSSPUT_LINUX_IO_URING
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif // CROSSPUT_LINUX_IO_URING
 
 
-// clock used for timestamps
-#define CROSSPUT_TSCLOCKID CLOCK_REALTIME
+// clock used for timestamps, monotonic so device timestamps and NowTimestamp() are comparable across wall clock adjustments
+#define CROSSPUT_TSCLOCKID CLOCK_MONOTONIC
 
 // fetch bit at offset within an array
 #define GETBIT_(array, at) (((reinterpret_cast<const unsigned char *>(array)[(at) / 8]) >> ((at) % 8)) & 1)
@@ -42,7 +53,34 @@ constexpr bool AnyBit(const unsigned char *const ptr, const size_t len) noexcept
 
 
 const std::string DEV_INPUT_DIR = "/dev/input";
-const std::regex REGEX_EVENTX_FN("^event[0-9]+$");
+
+
+// parse X from "eventX" filename, returns false if the filename does not match
+constexpr bool ParseEventXFilename(const char *fn, unsigned int &x) noexcept
+{
+    if (std::char_traits<char>::compare(fn, "event", 5) != 0) { return false; }
+    fn += 5;
+
+    if (*fn == '\0') { return false; }
+
+    x = 0;
+    for (; *fn != '\0'; fn++)
+    {
+        if (*fn < '0' || *fn > '9') { return false; }
+        x = (x * 10) + static_cast<unsigned int>(*fn - '0');
+    }
+
+    return true;
+}
+
+
+// open /dev/input/eventX file
+inline int OpenEventXFile(const unsigned int x, const int fd_flags)
+{
+    char path[64];
+    std::snprintf(path, sizeof(path), "%s/event%u", DEV_INPUT_DIR.c_str(), x);
+    return open(path, fd_flags);
+}
 
 
 constexpr bool input_id_equal(const input_id &left, const input_id &right) noexcept
@@ -167,10 +205,38 @@ public:
 };
 
 
+// A single eventX file of a device. Several files commonly share one LinuxHardwareID
+// (e.g. a keyboard and its consumer control keys, or the gamepad, touchpad, and motion sensors of a controller).
+struct LinuxEventXID
+{
+    LinuxHardwareID hwid;
+    unsigned int eventx;
+
+    inline bool operator==(const LinuxEventXID &other) const
+    {
+        return eventx == other.eventx && hwid == other.hwid;
+    }
+};
+
+
+template<>
+struct std::hash<LinuxEventXID>
+{
+public:
+    size_t operator()(const LinuxEventXID &id) const
+    {
+        return (std::hash<LinuxHardwareID>().operator()(id.hwid) * 23) + id.eventx;
+    }
+};
+
+
 namespace crossput
 {
     class LinuxDevice;
     class LinuxForce;
+    #ifdef CROSSPUT_LINUX_IO_URING
+    class IoUring;
+    #endif // CROSSPUT_LINUX_IO_URING
 
 
     // Linux Keycode -> crossput Key
@@ -586,12 +652,54 @@ namespace crossput
         0,
         0
     };
+
+
+    // kernel effect slots kept per ForceType after their forces were destroyed, reused by subsequently created forces
+    constexpr uint32_t MAX_POOLED_EFFECT_SLOTS = 4;
+
+    struct EffectSlotPool
+    {
+        int16_t effect_ids[MAX_POOLED_EFFECT_SLOTS];
+        uint32_t size = 0;
+    };
     #endif // CROSSPUT_FEATURE_FORCE
 
 
     // all hardware IDs that are in use
     std::unordered_set<LinuxHardwareID> nat_device_ids;
 
+    // inotify instance of the hotplug monitor (watching DEV_INPUT_DIR), negative if the monitor is disabled
+    int nat_hotplug_fd = -1;
+
+    // incremented whenever the monitor detects a change to the set of accessible eventX files
+    uint64_t nat_hotplug_generation = 0;
+
+    // true if DiscoverDevices() has to search for devices (only relevant while the monitor is enabled)
+    bool nat_discovery_pending = true;
+
+    // hardware IDs of all accessible eventX files (only maintained while the monitor is enabled)
+    std::unordered_multimap<LinuxHardwareID, unsigned int> nat_eventx_index;
+
+    // epoll instance used by WaitForInput(), negative until the function is invoked for the first time
+    int nat_epoll_fd = -1;
+
+    // value of nat_hotplug_generation during the last invocation of WaitForInput()
+    uint64_t nat_wait_hotplug_generation = 0;
+
+    // hotplug generation which causes a device to attempt reconnecting during its next update
+    constexpr uint64_t FORCE_RECONNECT_GENERATION = std::numeric_limits<uint64_t>::max();
+
+    #ifdef CROSSPUT_LINUX_IO_URING
+    // io_uring instance used by UpdateAllDevices(), nullptr until the function is invoked for the first time or if unsupported
+    IoUring *nat_p_uring = nullptr;
+
+    // true once the creation of the io_uring instance was attempted
+    bool nat_uring_attempted = false;
+
+    // watch index of a device that is not watched by the io_uring instance
+    constexpr uint32_t NO_URING_WATCH = std::numeric_limits<uint32_t>::max();
+    #endif // CROSSPUT_LINUX_IO_URING
+
 
     inline timestamp_t GetTimestampNow()
     {
@@ -676,20 +784,35 @@ namespace crossput
     }
 
 
+    struct LinuxDeviceMetadata;
+
+
     class LinuxDevice :
         public virtual BaseInterface,
         public virtual DeviceCallbackManager,
         public virtual DeviceForceManager<LinuxDevice>
     {
         friend LinuxForce;
+        #ifdef CROSSPUT_LINUX_IO_URING
+        friend IoUring;
+        #endif // CROSSPUT_LINUX_IO_URING
 
     protected:
         const LinuxHardwareID hardware_id_;
         std::vector<input_event> pending_events_;
+        std::unique_ptr<input_event[]> read_buffer_;
+        uint32_t read_buffer_size_ = 0;
         timestamp_t last_update_timestamp_ = 0;
+        uint64_t hotplug_generation_ = FORCE_RECONNECT_GENERATION;
         int file_desc_ = -1;
+        unsigned int eventx_ = 0; // X of the connected eventX file
+        #ifdef CROSSPUT_LINUX_IO_URING
+        uint32_t uring_watch_ = NO_URING_WATCH;
+        #endif // CROSSPUT_LINUX_IO_URING
+        std::string display_name_; // cached while connected
         #ifdef CROSSPUT_FEATURE_FORCE
         std::unordered_map<int16_t, LinuxForce *> force_mapping;
+        EffectSlotPool effect_slot_pools_[NUM_FORCE_TYPES];
         std::bitset<NUM_FORCE_TYPES> supported_forces_;
         float gain_ = 0.0F;
         unsigned short force_count_noorph_ = 0;
@@ -704,6 +827,21 @@ namespace crossput
         std::string GetDisplayName() const override final;
         void Update() override final;
 
+        // register with the epoll set used by WaitForInput()
+        inline void AddToEpollSet()
+        {
+            if (nat_epoll_fd >= 0)
+            {
+                epoll_event ev = {.events = EPOLLIN, .data = {.ptr = this}};
+                epoll_ctl(nat_epoll_fd, EPOLL_CTL_ADD, file_desc_, &ev);
+            }
+        }
+
+        #ifdef CROSSPUT_LINUX_IO_URING
+        // register with the io_uring instance used by UpdateAllDevices()
+        void AddToUring();
+        #endif // CROSSPUT_LINUX_IO_URING
+
         #ifdef CROSSPUT_FEATURE_FORCE
         constexpr uint32_t GetMotorCount() const override final;
         constexpr float GetGain(const uint32_t motor_index) const override final;
@@ -714,8 +852,16 @@ namespace crossput
 
         virtual ~LinuxDevice()
         {
+            #ifdef CROSSPUT_FEATURE_FORCE
+            // the worker of a force stream writes to the file
+            JoinForceStream();
+            #endif // CROSSPUT_FEATURE_FORCE
+
             nat_device_ids.erase(hardware_id_);
             CloseDevFile();
+
+            // hardware is available for discovery again
+            nat_discovery_pending = true;
         }
 
     protected:
@@ -728,8 +874,17 @@ namespace crossput
             #endif // CROSSPUT_FEATURE_FORCE
         }
 
+        // timestamp of the group of events currently pending (all events of a group share the timestamp of their SYN_REPORT)
+        inline timestamp_t GetPendingEventsTimestamp() const noexcept
+        {
+            return pending_events_.empty() ? last_update_timestamp_ : GetEventTimestamp(pending_events_.back());
+        }
+
         virtual constexpr void PreInputHandling() {}
 
+        // handles events that were read from the file, returns false if an event handler caused a disconnect
+        bool HandleEvents(const input_event *const p_events, const size_t num_events);
+
         // device-specific event handler implementation that uses the vector of stored events
         // note: vector is only cleared on SYN_DROPPED, so its contents are entirely managed by the implementation
         virtual void HandlePendingEvents() = 0;
@@ -738,14 +893,18 @@ namespace crossput
         virtual void HandleBufferOverrun(const timestamp_t timestamp) = 0;
 
         void CloseDevFile();
+        bool TryConnectFile(const int fd, const unsigned int x);
         bool TryConnect();
         void Disconnect();
 
-        virtual constexpr void OnConnected() {}
+        virtual constexpr void OnConnected([[maybe_unused]] LinuxDeviceMetadata &metadata) {}
         virtual constexpr void OnDisconnected() {}
 
         #ifdef CROSSPUT_FEATURE_FORCE
         void HandleFFStatusEvent(const input_event &ev);
+        bool AcquireEffectSlot(const ForceType type, int16_t &effect_id);
+        void ReleaseEffectSlot(const ForceType type, const int16_t effect_id);
+        bool EvictPooledEffectSlot();
 
         inline bool SetGainImpl(const float gain)
         {
@@ -785,6 +944,483 @@ namespace crossput
     };
 
 
+    #ifdef CROSSPUT_LINUX_IO_URING
+    // IO_URING
+
+    // keeps a read armed on the event file of every connected device, so that completed reads are handled without system calls
+    // and UpdateAllDevices() re-arms all of them with a single system call, regardless of the number of devices
+    // (re-arming right after a completion also catches up with events queued since, which complete during submission)
+    // note: reads target buffers owned by the instance, a read in flight never references the device that armed it
+    class IoUring
+    {
+    public:
+        enum class ReadStatus { NONE, IN_FLIGHT, COMPLETED };
+
+    private:
+        enum class Operation : uint64_t { READ = 0, CANCEL = 1 };
+
+        // two buffers, so that a read can be armed while the result of the previous one was not taken yet
+        struct Watch
+        {
+            LinuxDevice *p_device; // nullptr after Unwatch(), the watch is recycled once its read completed
+            std::unique_ptr<input_event[]> buffers[2];
+            uint32_t capacities[2]; // number of events
+            int32_t results[2];
+            uint32_t generation;
+            uint8_t num_results; // completed, but not taken yet
+            uint8_t oldest_result;
+            uint8_t in_flight_buffer;
+            bool is_in_flight;
+
+            constexpr bool CanRead() const noexcept { return p_device != nullptr && !is_in_flight && num_results < 2; }
+        };
+
+        static constexpr unsigned int ENTRIES = 64;
+
+        int ring_fd_ = -1;
+        void *p_sq_ring_ = MAP_FAILED;
+        void *p_cq_ring_ = MAP_FAILED;
+        size_t sq_ring_size_ = 0;
+        size_t cq_ring_size_ = 0;
+        io_uring_sqe *p_sqes_ = static_cast<io_uring_sqe *>(MAP_FAILED);
+        size_t sqes_size_ = 0;
+        io_uring_cqe *p_cqes_ = nullptr;
+        uint32_t *p_sq_head_ = nullptr;
+        uint32_t *p_sq_tail_ = nullptr;
+        uint32_t *p_sq_flags_ = nullptr;
+        uint32_t *p_sq_array_ = nullptr;
+        uint32_t *p_cq_head_ = nullptr;
+        uint32_t *p_cq_tail_ = nullptr;
+        uint32_t sq_mask_ = 0;
+        uint32_t sq_entries_ = 0;
+        uint32_t cq_mask_ = 0;
+        uint32_t num_unsubmitted_ = 0;
+        uint32_t num_in_flight_ = 0;
+        std::vector<Watch> watches_;
+        std::vector<uint32_t> free_watches_;
+        bool is_batching_ = false;
+        bool is_functional_ = true; // false once the kernel rejected a read, devices fall back to read() after taking their results
+        bool is_drained_ = false;   // reads in flight were cancelled after the instance stopped functioning
+
+        IoUring() = default;
+
+        static constexpr uint64_t UserData(const uint32_t index, const uint32_t generation, const uint32_t buffer, const Operation op) noexcept
+        {
+            return (static_cast<uint64_t>(generation) << 32) | (static_cast<uint64_t>(index) << 2) | (static_cast<uint64_t>(buffer) << 1) | static_cast<uint64_t>(op);
+        }
+
+        inline int Enter(const uint32_t to_submit, const uint32_t min_complete, const unsigned int flags)
+        {
+            CROSSPUT_STATS_ADD_GLOBAL(syscalls, 1);
+            return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, to_submit, min_complete, flags, nullptr, 0));
+        }
+
+        // submits all queued entries with a single system call (unless interrupted)
+        void Submit()
+        {
+            while (num_unsubmitted_ != 0)
+            {
+                const int stat = Enter(num_unsubmitted_, 0, 0);
+                if (stat < 0)
+                {
+                    if (errno == EINTR) { continue; }
+                    if (errno == EBUSY) { Harvest(); continue; } // completion queue is full
+                    is_functional_ = false;
+                    return;
+                }
+
+                num_unsubmitted_ -= std::min(static_cast<uint32_t>(stat), num_unsubmitted_);
+            }
+        }
+
+        io_uring_sqe &AcquireEntry(const uint64_t user_data, const int fd)
+        {
+            if (*p_sq_tail_ - std::atomic_ref<uint32_t>(*p_sq_head_).load(std::memory_order_acquire) == sq_entries_) [[unlikely]]
+            {
+                // submission queue is full
+                Submit();
+            }
+
+            const uint32_t tail = *p_sq_tail_;
+            const uint32_t at = tail & sq_mask_;
+            io_uring_sqe &sqe = p_sqes_[at];
+            std::memset(&sqe, 0, sizeof(io_uring_sqe));
+            sqe.fd = fd;
+            sqe.user_data = user_data;
+            p_sq_array_[at] = at;
+            std::atomic_ref<uint32_t>(*p_sq_tail_).store(tail + 1, std::memory_order_release);
+            num_unsubmitted_++;
+            return sqe;
+        }
+
+        // requires CanRead()
+        void QueueRead(const uint32_t index)
+        {
+            Watch &watch = watches_[index];
+            const LinuxDevice &device = *watch.p_device;
+            const uint32_t buffer = (watch.num_results == 0) ? 0 : (watch.oldest_result ^ 1);
+            if (watch.capacities[buffer] != device.read_batch_size_) [[unlikely]]
+            {
+                watch.buffers[buffer] = std::make_unique<input_event[]>(device.read_batch_size_);
+                watch.capacities[buffer] = device.read_batch_size_;
+            }
+
+            io_uring_sqe &sqe = AcquireEntry(UserData(index, watch.generation, buffer, Operation::READ), device.file_desc_);
+            sqe.opcode = IORING_OP_READ;
+            sqe.addr = reinterpret_cast<uint64_t>(watch.buffers[buffer].get());
+            sqe.len = static_cast<uint32_t>(watch.capacities[buffer] * sizeof(input_event));
+            watch.in_flight_buffer = static_cast<uint8_t>(buffer);
+            watch.is_in_flight = true;
+            num_in_flight_++;
+        }
+
+        void QueueCancel(const uint32_t index)
+        {
+            const Watch &watch = watches_[index];
+            io_uring_sqe &sqe = AcquireEntry(UserData(index, watch.generation, 0, Operation::CANCEL), -1);
+            sqe.opcode = IORING_OP_ASYNC_CANCEL;
+            sqe.addr = UserData(index, watch.generation, watch.in_flight_buffer, Operation::READ);
+        }
+
+        void Recycle(const uint32_t index)
+        {
+            watches_[index].generation++;
+            free_watches_.push_back(index);
+        }
+
+        void HandleCompletion(const io_uring_cqe &cqe)
+        {
+            if (static_cast<Operation>(cqe.user_data & 1) == Operation::CANCEL) { return; }
+
+            const uint32_t index = static_cast<uint32_t>(cqe.user_data >> 2) & 0x3FFFFFFF;
+            const uint32_t buffer = static_cast<uint32_t>(cqe.user_data >> 1) & 1;
+            Watch &watch = watches_[index];
+            if (watch.generation != static_cast<uint32_t>(cqe.user_data >> 32)) [[unlikely]] { return; }
+
+            watch.is_in_flight = false;
+            num_in_flight_--;
+            if (watch.p_device == nullptr)
+            {
+                Recycle(index);
+            }
+            else if (cqe.res == -ECANCELED || cqe.res == -EINTR) [[unlikely]]
+            {
+                // cancelled by Drain() before any event was read
+            }
+            else if (cqe.res == -EAGAIN || cqe.res == -EINVAL || cqe.res == -EOPNOTSUPP) [[unlikely]]
+            {
+                // kernel does not keep reads of non-blocking files armed, or does not support them at all
+                is_functional_ = false;
+            }
+            else
+            {
+                watch.results[buffer] = cqe.res;
+                if (watch.num_results++ == 0) { watch.oldest_result = static_cast<uint8_t>(buffer); }
+            }
+        }
+
+        // processes all available completions without a system call
+        void Harvest()
+        {
+            if ((std::atomic_ref<uint32_t>(*p_sq_flags_).load(std::memory_order_relaxed) & IORING_SQ_CQ_OVERFLOW) != 0) [[unlikely]]
+            {
+                // flush completions that did not fit into the completion queue
+                Enter(0, 0, IORING_ENTER_GETEVENTS);
+            }
+
+            uint32_t head = *p_cq_head_;
+            const uint32_t tail = std::atomic_ref<uint32_t>(*p_cq_tail_).load(std::memory_order_acquire);
+            for (; head != tail; head++) { HandleCompletion(p_cqes_[head & cq_mask_]); }
+            std::atomic_ref<uint32_t>(*p_cq_head_).store(head, std::memory_order_release);
+        }
+
+    public:
+        // returns nullptr if io_uring is unavailable (kernel version, seccomp, ...)
+        static IoUring *TryCreate()
+        {
+            io_uring_params params = {};
+            const int fd = static_cast<int>(syscall(__NR_io_uring_setup, ENTRIES, &params));
+            if (fd < 0) { return nullptr; }
+
+            // reads of non-blocking files only stay armed with internal polling,
+            // and completions must never be dropped, that would lose input
+            if ((params.features & IORING_FEAT_FAST_POLL) == 0 || (params.features & IORING_FEAT_NODROP) == 0)
+            {
+                close(fd);
+                return nullptr;
+            }
+
+            IoUring *const p_uring = new IoUring();
+            p_uring->ring_fd_ = fd;
+            p_uring->sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+            p_uring->cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            const bool is_single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (is_single_mmap)
+            {
+                p_uring->sq_ring_size_ = p_uring->cq_ring_size_ = std::max(p_uring->sq_ring_size_, p_uring->cq_ring_size_);
+            }
+
+            p_uring->p_sq_ring_ = mmap(nullptr, p_uring->sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+            p_uring->p_cq_ring_ = is_single_mmap
+                ? p_uring->p_sq_ring_
+                : mmap(nullptr, p_uring->cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            p_uring->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+            p_uring->p_sqes_ = static_cast<io_uring_sqe *>(mmap(nullptr, p_uring->sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+            if (p_uring->p_sq_ring_ == MAP_FAILED || p_uring->p_cq_ring_ == MAP_FAILED || p_uring->p_sqes_ == MAP_FAILED)
+            {
+                delete p_uring;
+                return nullptr;
+            }
+
+            char *const p_sq = static_cast<char *>(p_uring->p_sq_ring_);
+            char *const p_cq = static_cast<char *>(p_uring->p_cq_ring_);
+            p_uring->p_sq_head_ = reinterpret_cast<uint32_t *>(p_sq + params.sq_off.head);
+            p_uring->p_sq_tail_ = reinterpret_cast<uint32_t *>(p_sq + params.sq_off.tail);
+            p_uring->p_sq_flags_ = reinterpret_cast<uint32_t *>(p_sq + params.sq_off.flags);
+            p_uring->p_sq_array_ = reinterpret_cast<uint32_t *>(p_sq + params.sq_off.array);
+            p_uring->sq_mask_ = *reinterpret_cast<uint32_t *>(p_sq + params.sq_off.ring_mask);
+            p_uring->sq_entries_ = *reinterpret_cast<uint32_t *>(p_sq + params.sq_off.ring_entries);
+            p_uring->p_cq_head_ = reinterpret_cast<uint32_t *>(p_cq + params.cq_off.head);
+            p_uring->p_cq_tail_ = reinterpret_cast<uint32_t *>(p_cq + params.cq_off.tail);
+            p_uring->cq_mask_ = *reinterpret_cast<uint32_t *>(p_cq + params.cq_off.ring_mask);
+            p_uring->p_cqes_ = reinterpret_cast<io_uring_cqe *>(p_cq + params.cq_off.cqes);
+            p_uring->watches_.reserve(16);
+            return p_uring;
+        }
+
+        // only deleted once idle (see IsIdle()) or at exit, results which were not taken yet are discarded
+        ~IoUring()
+        {
+            // watched devices fall back to read()
+            for (uint32_t i = 0; i < static_cast<uint32_t>(watches_.size()); i++)
+            {
+                Watch &watch = watches_[i];
+                if (watch.p_device != nullptr)
+                {
+                    watch.p_device->uring_watch_ = NO_URING_WATCH;
+                    watch.p_device = nullptr;
+                }
+
+                if (watch.is_in_flight) { QueueCancel(i); }
+            }
+
+            // the kernel must not write to the buffers after they were released
+            Submit();
+            while (num_in_flight_ != 0 && is_functional_ && Enter(0, 1, IORING_ENTER_GETEVENTS) >= 0) { Harvest(); }
+            if (num_in_flight_ != 0) [[unlikely]]
+            {
+                for (Watch &watch : watches_)
+                {
+                    static_cast<void>(watch.buffers[0].release());
+                    static_cast<void>(watch.buffers[1].release());
+                }
+            }
+
+            if (p_sqes_ != MAP_FAILED) { munmap(p_sqes_, sqes_size_); }
+            if (p_cq_ring_ != MAP_FAILED && p_cq_ring_ != p_sq_ring_) { munmap(p_cq_ring_, cq_ring_size_); }
+            if (p_sq_ring_ != MAP_FAILED) { munmap(p_sq_ring_, sq_ring_size_); }
+            close(ring_fd_);
+        }
+
+        IoUring(const IoUring &) = delete;
+        IoUring &operator=(const IoUring &) = delete;
+
+        constexpr bool IsFunctional() const noexcept { return is_functional_; }
+
+        constexpr int GetFileDescriptor() const noexcept { return ring_fd_; }
+
+        // appends all watched devices with results which were not taken yet, returns their number
+        size_t CollectReady(std::vector<IDevice *> &ready_devices)
+        {
+            Harvest();
+            size_t num = 0;
+            for (const Watch &watch : watches_)
+            {
+                if (watch.p_device != nullptr && watch.num_results != 0)
+                {
+                    ready_devices.push_back(watch.p_device);
+                    num++;
+                }
+            }
+
+            return num;
+        }
+
+        // true once no device is watched and no read is in flight, i.e. the instance can be deleted without losing input
+        bool IsIdle() const noexcept
+        {
+            if (num_in_flight_ != 0) { return false; }
+            return std::none_of(watches_.begin(), watches_.end(), [](const Watch &watch) { return watch.p_device != nullptr; });
+        }
+
+        // stops arming reads and cancels the ones in flight, results of completed reads remain available to TakeRead(),
+        // so devices only fall back to read() once no read of their file is in flight anymore
+        void Drain()
+        {
+            is_functional_ = false;
+            if (is_drained_)
+            {
+                Harvest();
+                return;
+            }
+
+            is_drained_ = true;
+            Harvest();
+            for (uint32_t i = 0; i < static_cast<uint32_t>(watches_.size()); i++)
+            {
+                // reads of unwatched devices are already being cancelled
+                if (watches_[i].is_in_flight && watches_[i].p_device != nullptr) { QueueCancel(i); }
+            }
+
+            Submit();
+            while (num_in_flight_ != 0)
+            {
+                if (Enter(0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) { break; } // remaining reads are harvested later on
+                Harvest();
+            }
+        }
+
+        // returns the index of the watch, its first read is armed by Rearm()
+        uint32_t Add(LinuxDevice &device)
+        {
+            uint32_t index;
+            if (free_watches_.empty())
+            {
+                index = static_cast<uint32_t>(watches_.size());
+                watches_.push_back({});
+            }
+            else
+            {
+                index = free_watches_.back();
+                free_watches_.pop_back();
+            }
+
+            Watch &watch = watches_[index];
+            watch.p_device = &device;
+            watch.num_results = 0;
+            return index;
+        }
+
+        void Unwatch(const uint32_t index)
+        {
+            Watch &watch = watches_[index];
+            watch.p_device = nullptr;
+            watch.num_results = 0;
+            if (!watch.is_in_flight)
+            {
+                Recycle(index);
+                return;
+            }
+
+            // the watch is recycled once the cancelled read completes
+            QueueCancel(index);
+            Submit();
+        }
+
+        // harvests completions once for the whole batch and immediately re-arms the reads that completed, with a single system call
+        void BeginBatch()
+        {
+            is_batching_ = true;
+            Harvest();
+            if (!is_functional_) [[unlikely]] { return; }
+
+            for (uint32_t i = 0; i < static_cast<uint32_t>(watches_.size()); i++)
+            {
+                if (watches_[i].num_results != 0 && watches_[i].CanRead()) { QueueRead(i); }
+            }
+
+            if (num_unsubmitted_ != 0)
+            {
+                // reads of files with queued events complete during submission
+                Submit();
+                Harvest();
+            }
+        }
+
+        // re-arms the reads of all watches with a single system call
+        void EndBatch()
+        {
+            is_batching_ = false;
+            if (!is_functional_) [[unlikely]] { return; }
+
+            for (uint32_t i = 0; i < static_cast<uint32_t>(watches_.size()); i++)
+            {
+                if (watches_[i].CanRead()) { QueueRead(i); }
+            }
+
+            Submit();
+        }
+
+        // re-arms the read of a watch after its result was taken, immediately unless batching
+        void Rearm(const uint32_t index)
+        {
+            if (is_batching_ || !is_functional_) { return; }
+
+            if (watches_[index].CanRead())
+            {
+                QueueRead(index);
+                Submit();
+            }
+        }
+
+        // retrieves the oldest result of a completed read (see read(), sets errno on error)
+        ReadStatus TakeRead(const uint32_t index, const input_event *&p_events, ssize_t &result)
+        {
+            if (!is_batching_) { Harvest(); }
+
+            // the file must not be read directly while a read is in flight, even if the instance stopped functioning
+            Watch &watch = watches_[index];
+            if (watch.num_results == 0) { return watch.is_in_flight ? ReadStatus::IN_FLIGHT : ReadStatus::NONE; }
+
+            const uint32_t buffer = watch.oldest_result;
+            watch.num_results--;
+            watch.oldest_result ^= 1;
+            p_events = watch.buffers[buffer].get();
+            result = watch.results[buffer];
+            if (result < 0)
+            {
+                errno = static_cast<int>(-result);
+                result = -1;
+            }
+
+            return ReadStatus::COMPLETED;
+        }
+    };
+
+
+    void LinuxDevice::AddToUring()
+    {
+        if (nat_p_uring != nullptr && nat_p_uring->IsFunctional())
+        {
+            uring_watch_ = nat_p_uring->Add(*this);
+            nat_p_uring->Rearm(uring_watch_);
+        }
+    }
+
+
+    // releases the io_uring instance at exit, devices which still exist afterwards fall back to read()
+    struct IoUringReleaser
+    {
+        ~IoUringReleaser()
+        {
+            delete nat_p_uring;
+            nat_p_uring = nullptr;
+        }
+    } nat_uring_releaser;
+
+
+    // armed reads drain the files of watched devices, so WaitForInput() waits for completions of the io_uring instance instead
+    void AddUringToEpollSet()
+    {
+        if (nat_epoll_fd >= 0 && nat_p_uring != nullptr)
+        {
+            epoll_event ev = {.events = EPOLLIN, .data = {.ptr = &nat_p_uring}};
+            epoll_ctl(nat_epoll_fd, EPOLL_CTL_ADD, nat_p_uring->GetFileDescriptor(), &ev);
+        }
+    }
+    #endif // CROSSPUT_LINUX_IO_URING
+
+
     class LinuxMouse final :
         public virtual IMouse,
         public virtual LinuxDevice,
@@ -795,7 +1431,7 @@ namespace crossput
         static constexpr size_t NUM_BUTTONS = 8;
 
     private:
-        TSTV button_data_[NUM_BUTTONS] = {};
+        StateArray<NUM_BUTTONS> button_data_ = {};
         MouseData data_ = {};
 
     public:
@@ -811,6 +1447,10 @@ namespace crossput
         constexpr float GetButtonThreshold(const uint32_t index) const override;
         constexpr float GetButtonValue(const uint32_t index) const override;
         constexpr bool GetButtonState(const uint32_t index, float &time) const override;
+        StateView GetButtonView() const override { return button_data_.View(is_connected_); }
+        void GetButtonStates(uint64_t *const states, const size_t num_words) const override;
+        uint32_t GetButtonValues(float *const values, const uint32_t max_count) const override;
+        uint32_t GetButtonTimestamps(uint64_t *const timestamps, const uint32_t max_count) const override;
 
     private:
         void PreInputHandling() override;
@@ -827,7 +1467,7 @@ namespace crossput
         public virtual KeyboardCallbackManager
     {
     private:
-        TSTV key_data_[NUM_KEY_CODES] = {};
+        StateArray<NUM_KEY_CODES> key_data_ = {};
         uint32_t num_keys_pressed_ = 0;
 
     public:
@@ -839,6 +1479,10 @@ namespace crossput
         constexpr float GetKeyThreshold(const Key key) const override;
         constexpr float GetKeyValue(const Key key) const override;
         constexpr bool GetKeyState(const Key key, float &time) const override;
+        StateView GetKeyView() const override { return key_data_.View(is_connected_); }
+        void GetKeyStates(uint64_t *const states) const override;
+        void GetKeyValues(float *const values) const override;
+        void GetKeyTimestamps(uint64_t *const timestamps) const override;
 
     private:
         void HandlePendingEvents() override;
@@ -851,14 +1495,15 @@ namespace crossput
         public virtual IGamepad,
         public virtual LinuxDevice,
         public virtual TypedInterface<DeviceType::GAMEPAD>,
-        public virtual GamepadCallbackManager
+        public virtual GamepadCallbackManager,
+        public virtual GamepadProfileManager
     {
     public:
         static constexpr size_t NUM_TRIGGERS = 4;
         static constexpr size_t NUM_THUMBSTICKS = 2;
 
     private:
-        TSTV button_data_[NUM_BUTTON_CODES] = {};
+        StateArray<NUM_BUTTON_CODES> button_data_ = {};
         AbsValNorm thumbstick_norms_[NUM_THUMBSTICKS * 2] = {};
         AbsValNorm trigger_norms_[NUM_TRIGGERS] = {};
         float thumbstick_values_[NUM_THUMBSTICKS * 2] = {};
@@ -877,27 +1522,27 @@ namespace crossput
         constexpr float GetButtonThreshold(const Button button) const override;
         constexpr float GetButtonValue(const Button button) const override;
         constexpr bool GetButtonState(const Button button, float &time) const override;
+        StateView GetButtonView() const override { return button_data_.View(is_connected_); }
+        void GetButtonStates(uint64_t *const states) const override;
+        void GetButtonValues(float *const values) const override;
+        void GetButtonTimestamps(uint64_t *const timestamps) const override;
         constexpr uint32_t GetThumbstickCount() const override;
         constexpr void GetThumbstick(const uint32_t index, float &x, float &y) const override;
+        uint32_t GetThumbsticks(float *const xy, const uint32_t max_count) const override;
 
     private:
         void HandlePendingEvents() override;
         void HandleBufferOverrun(const timestamp_t timestamp) override;
-        void OnConnected() override;
+        void OnConnected(LinuxDeviceMetadata &metadata) override;
         void OnDisconnected() override;
         
         inline void DigitalizeAnalogDpad(const float nvalue, const timestamp_t timestamp, const Button b1, const Button b2)
         {
             const float value1 = std::max(0.0F, nvalue);
             const float value2 = std::max(0.0F, -nvalue);
-            #ifdef CROSSPUT_FEATURE_CALLBACK
             bool state1, state2;
-            if (button_data_[static_cast<int>(b1)].Modify(value1, timestamp, state1)) { ButtonChanged(b1, value1, state1); }
-            if (button_data_[static_cast<int>(b2)].Modify(value2, timestamp, state2)) { ButtonChanged(b2, value2, state2); }
-            #else
-            button_data_[static_cast<int>(b1)].Modify(value1, timestamp);
-            button_data_[static_cast<int>(b2)].Modify(value2, timestamp);
-            #endif // CROSSPUT_FEATURE_CALLBACK
+            if (button_data_.Modify(static_cast<int>(b1), value1, timestamp, state1)) { ButtonChanged(b1, value1, state1, timestamp); }
+            if (button_data_.Modify(static_cast<int>(b2), value2, timestamp, state2)) { ButtonChanged(b2, value2, state2, timestamp); }
         }
     };
 
@@ -929,7 +1574,7 @@ namespace crossput
             {
                 p_device_->force_mapping.erase(effect_id_);
                 p_device_->force_count_noorph_--;
-                ioctl(p_device_->file_desc_, EVIOCRMFF, effect_id_);
+                p_device_->ReleaseEffectSlot(type_, effect_id_);
             }
         }
     };
@@ -1144,47 +1789,355 @@ namespace crossput
     }
 
 
-    // invoke function-like object for every /dev/input/eventX file,
-    // returns number of invocations
-    // [handler signature: bool (const int file_descriptor, const unsigned int x, bool &close_fd)]
-    size_t ForeachEventXFile(auto &&handler, const int fd_flags)
+    // METADATA CACHE
+
+    // properties of an event device which are queried once and remain valid until the underlying hardware changes
+    struct LinuxDeviceMetadata
     {
-        size_t num = 0;
+        std::string name;
+        std::bitset<ABS_CNT> abs_queried;
+        std::bitset<ABS_CNT> abs_available;
+        AbsValNorm abs_norms[ABS_CNT] = {};
+        #ifdef CROSSPUT_FEATURE_FORCE
+        unsigned char ff_capabilities[(FF_CNT - 1) / 8 + 1] = {};
+        #endif // CROSSPUT_FEATURE_FORCE
+        DeviceType type = DeviceType::UNKNOWN;
 
-        for (const auto &entry : std::filesystem::directory_iterator(DEV_INPUT_DIR))
+        // normalizer of an absolute axis, queried on first use
+        bool GetAbsValNorm(const int fd, const int code, AbsValNorm &norm)
         {
-            if (entry.is_directory()) { continue; }
-
-            const std::string fnstr = entry.path().filename().string();
-            if (!std::regex_match(fnstr, REGEX_EVENTX_FN)) { continue; } // not an eventX file
-
-            const int fd = open(entry.path().c_str(), fd_flags);
-            if (fd < 0)
+            if (!abs_queried[code])
             {
-                if (errno == EPERM)
-                {
-                    throw std::runtime_error(std::format("Access to \"{}\" denied. Is the current user in the \"input\" group?", entry.path().c_str()));
-                }
-
-                continue;
+                abs_queried[code] = true;
+                abs_available[code] = AbsValueNormFromIoctl(fd, code, abs_norms[code]);
             }
 
-            bool close_fd;
-            char *end = nullptr;
-            const unsigned int x = static_cast<unsigned int>(std::strtoul(fnstr.data() + 5, &end, 10)); // parse eventX
-            const bool status = handler(fd, x, close_fd);
-            num++;
-
-            if (close_fd) { close(fd); }
-            if (!status) { break; }
+            if (abs_available[code]) { norm = abs_norms[code]; }
+            return abs_available[code];
         }
+    };
 
-        return num;
-    }
+    // metadata of probed event devices by hardware ID and eventX file, since files sharing a hardware ID may produce different types of input
+    // (entries are dropped when the device disconnects or the hotplug monitor reports a change of the underlying file)
+    std::unordered_map<LinuxEventXID, LinuxDeviceMetadata> nat_metadata_cache;
 
+    // metadata of the most recently probed device with an eventX fallback ID, which is never cached because other hardware may reuse the file
+    LinuxDeviceMetadata nat_uncached_metadata;
 
-    #ifdef CROSSPUT_FEATURE_FORCE
-    constexpr int16_t TranslateMagnitude(const float magnitude) noexcept
+
+    // absolute axes used by gamepads, which are probed together with the rest of the metadata
+    constexpr int gamepad_abs_codes[] =
+    {
+        ABS_X, ABS_Y, ABS_RX, ABS_RY,
+        ABS_HAT0X, ABS_HAT0Y, ABS_HAT1X, ABS_HAT1Y, ABS_HAT2X, ABS_HAT2Y
+    };
+
+
+    // query all metadata of an open eventX file (does not access any global state)
+    void ProbeDeviceMetadata(const int fd, LinuxDeviceMetadata &metadata)
+    {
+        metadata.type = DeduceInputDeviceType(fd);
+        if (metadata.type == DeviceType::UNKNOWN) { return; }
+
+        char name[256] = {};
+        if (ioctl(fd, EVIOCGNAME(sizeof(name) - 1), &name) >= 0) { metadata.name = name; }
+
+        #ifdef CROSSPUT_FEATURE_FORCE
+        ioctl(fd, EVIOCGBIT(EV_FF, sizeof(metadata.ff_capabilities)), metadata.ff_capabilities);
+        #endif // CROSSPUT_FEATURE_FORCE
+
+        if (metadata.type == DeviceType::GAMEPAD)
+        {
+            AbsValNorm norm;
+            for (const int code : gamepad_abs_codes) { metadata.GetAbsValNorm(fd, code, norm); }
+        }
+    }
+
+
+    // store metadata that was probed ahead of time
+    void CacheDeviceMetadata(const LinuxHardwareID &hwid, const unsigned int x, LinuxDeviceMetadata &&metadata)
+    {
+        if (hwid.idm == 2) { return; }
+        nat_metadata_cache.insert_or_assign(LinuxEventXID{hwid, x}, std::move(metadata));
+    }
+
+
+    // get metadata of an open eventX file, probing the device only if it is not cached
+    LinuxDeviceMetadata &QueryDeviceMetadata(const int fd, const LinuxHardwareID &hwid, const unsigned int x)
+    {
+        if (hwid.idm == 2)
+        {
+            nat_uncached_metadata = {};
+            ProbeDeviceMetadata(fd, nat_uncached_metadata);
+            return nat_uncached_metadata;
+        }
+
+        const auto [it, inserted] = nat_metadata_cache.try_emplace(LinuxEventXID{hwid, x});
+        if (inserted) { ProbeDeviceMetadata(fd, it->second); }
+        return it->second;
+    }
+
+
+    inline void InvalidateDeviceMetadata(const LinuxHardwareID &hwid, const unsigned int x)
+    {
+        nat_metadata_cache.erase(LinuxEventXID{hwid, x});
+    }
+
+
+    // PROBING
+
+    constexpr uint32_t MAX_PROBE_THREADS = 64;
+
+    // number of threads used to probe eventX files, parallel probing is disabled for values below 2
+    uint32_t nat_probe_thread_count = 1;
+
+    // see SetReadingBufferEnabled(), has no effect on this platform
+    bool nat_buffer_readings = false;
+
+
+    // result of probing a single eventX file
+    struct EventXProbe
+    {
+        LinuxHardwareID hwid;
+        LinuxDeviceMetadata metadata; // only valid if has_metadata is true
+        unsigned int x;
+        int fd = -1; // open file, negative if it could not be opened
+        int error = 0; // errno of open()
+        bool has_metadata = false;
+    };
+
+
+    // X of all /dev/input/eventX files in ascending order
+    std::vector<unsigned int> ListEventXFiles()
+    {
+        std::vector<unsigned int> files;
+        for (const auto &entry : std::filesystem::directory_iterator(DEV_INPUT_DIR))
+        {
+            if (entry.is_directory()) { continue; }
+
+            unsigned int x;
+            const std::string fnstr = entry.path().filename().string();
+            if (ParseEventXFilename(fnstr.c_str(), x)) { files.push_back(x); }
+        }
+
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+
+    // open an eventX file and query its hardware ID (and optionally its metadata)
+    void ProbeEventXFile(EventXProbe &probe, const int fd_flags, const bool query_metadata)
+    {
+        probe.fd = OpenEventXFile(probe.x, fd_flags);
+        if (probe.fd < 0)
+        {
+            probe.error = errno;
+            return;
+        }
+
+        GetHWID(probe.hwid, probe.fd, probe.x);
+        if (query_metadata)
+        {
+            ProbeDeviceMetadata(probe.fd, probe.metadata);
+            probe.has_metadata = true;
+        }
+    }
+
+
+    // deduced type of a probed file, metadata that was probed ahead of time is moved into the cache
+    DeviceType ResolveDeviceType(EventXProbe &probe)
+    {
+        if (!probe.has_metadata) { return QueryDeviceMetadata(probe.fd, probe.hwid, probe.x).type; }
+
+        const DeviceType type = probe.metadata.type;
+        CacheDeviceMetadata(probe.hwid, probe.x, std::move(probe.metadata));
+        probe.has_metadata = false;
+        return type;
+    }
+
+
+    // invoke function-like object for every /dev/input/eventX file in ascending order of X,
+    // all files are probed concurrently beforehand if requested and parallel probing is enabled,
+    // in which case their metadata is also probed ahead of time if requested (see ResolveDeviceType()),
+    // returns number of invocations
+    // [handler signature: bool (EventXProbe &probe, bool &close_fd)]
+    size_t ForeachEventXFile(auto &&handler, const int fd_flags, const bool parallel, const bool prefetch_metadata)
+    {
+        const std::vector<unsigned int> files = ListEventXFiles();
+        const size_t num_threads = parallel ? std::min(static_cast<size_t>(nat_probe_thread_count), files.size()) : 1;
+
+        std::vector<EventXProbe> probes(files.size());
+        for (size_t i = 0; i < files.size(); i++) { probes[i].x = files[i]; }
+
+        if (num_threads > 1)
+        {
+            // slow files only stall a single worker, results are handled in order afterwards
+            std::atomic<size_t> next = 0;
+            const auto worker = [&probes, &next, fd_flags, prefetch_metadata]()
+            {
+                for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < probes.size(); )
+                {
+                    ProbeEventXFile(probes[i], fd_flags, prefetch_metadata);
+                }
+            };
+
+            std::vector<std::thread> threads;
+            threads.reserve(num_threads - 1);
+            for (size_t t = 1; t < num_threads; t++) { threads.emplace_back(worker); }
+            worker();
+            for (std::thread &t : threads) { t.join(); }
+        }
+
+        size_t num = 0;
+        size_t i = 0;
+        try
+        {
+            for (; i < probes.size(); i++)
+            {
+                EventXProbe &probe = probes[i];
+                if (num_threads <= 1) { ProbeEventXFile(probe, fd_flags, false); }
+
+                if (probe.fd < 0)
+                {
+                    if (probe.error == EPERM)
+                    {
+                        throw std::runtime_error(std::format("Access to \"{}/event{}\" denied. Is the current user in the \"input\" group?", DEV_INPUT_DIR, probe.x));
+                    }
+
+                    continue;
+                }
+
+                bool close_fd;
+                const bool status = handler(probe, close_fd);
+                num++;
+
+                if (close_fd) { close(probe.fd); }
+                probe.fd = -1;
+                if (!status) { break; }
+            }
+        }
+        catch (...)
+        {
+            for (; i < probes.size(); i++) { if (probes[i].fd >= 0) { close(probes[i].fd); } }
+            throw;
+        }
+
+        // files that were probed ahead of time but not handled
+        for (; i < probes.size(); i++) { if (probes[i].fd >= 0) { close(probes[i].fd); } }
+
+        return num;
+    }
+
+
+    // HOTPLUG MONITOR
+
+    inline void EventXIndexChanged()
+    {
+        nat_hotplug_generation++;
+        nat_discovery_pending = true;
+    }
+
+
+    // (re-)insert a single eventX file into the index, returns true if the index was modified
+    bool IndexEventXFile(const unsigned int x)
+    {
+        const auto it_old = std::find_if(nat_eventx_index.begin(), nat_eventx_index.end(), [x](const auto &elm) { return elm.second == x; });
+
+        const int fd = OpenEventXFile(x, O_RDONLY | O_NONBLOCK);
+        if (fd < 0)
+        {
+            // file is not accessible (anymore)
+            if (it_old == nat_eventx_index.end()) { return false; }
+            InvalidateDeviceMetadata(it_old->first, x);
+            nat_eventx_index.erase(it_old);
+            return true;
+        }
+
+        LinuxHardwareID hwid;
+        GetHWID(hwid, fd, x);
+        close(fd);
+
+        if (it_old != nat_eventx_index.end())
+        {
+            if (it_old->first == hwid) { return false; }
+            InvalidateDeviceMetadata(it_old->first, x);
+            nat_eventx_index.erase(it_old);
+        }
+
+        nat_eventx_index.insert({hwid, x});
+        return true;
+    }
+
+
+    void RebuildEventXIndex()
+    {
+        nat_eventx_index.clear();
+        nat_metadata_cache.clear();
+
+        const auto indexer = [](EventXProbe &probe, bool &close_fd) -> bool
+        {
+            close_fd = true;
+
+            nat_eventx_index.insert({probe.hwid, probe.x});
+            if (probe.has_metadata) { (void)ResolveDeviceType(probe); }
+            return true;
+        };
+
+        ForeachEventXFile(indexer, O_RDONLY | O_NONBLOCK, true, true);
+        EventXIndexChanged();
+    }
+
+
+    // process all pending notifications of the hotplug monitor
+    void PollHotplugMonitor()
+    {
+        if (nat_hotplug_fd < 0) { return; }
+
+        alignas(inotify_event) char buffer[4096];
+        ssize_t len;
+        while ((len = read(nat_hotplug_fd, buffer, sizeof(buffer))) > 0)
+        {
+            CROSSPUT_STATS_ADD_GLOBAL(syscalls, 1);
+            for (ssize_t offset = 0; offset < len; )
+            {
+                const inotify_event *const p_ev = reinterpret_cast<const inotify_event *>(buffer + offset);
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + p_ev->len);
+
+                if (p_ev->mask & IN_Q_OVERFLOW) [[unlikely]]
+                {
+                    // notifications were lost, start from scratch
+                    RebuildEventXIndex();
+                    continue;
+                }
+
+                unsigned int x;
+                if (p_ev->len == 0 || !ParseEventXFilename(p_ev->name, x)) { continue; } // not an eventX file
+
+                if (p_ev->mask & (IN_DELETE | IN_MOVED_FROM))
+                {
+                    // file disappeared
+                    const auto disappeared = [x](const auto &elm) { return elm.second == x; };
+                    for (const auto &elm : nat_eventx_index) { if (disappeared(elm)) { InvalidateDeviceMetadata(elm.first, x); } }
+                    if (std::erase_if(nat_eventx_index, disappeared) > 0)
+                    {
+                        EventXIndexChanged();
+                    }
+                }
+                else if (IndexEventXFile(x))
+                {
+                    // file appeared or its accessibility changed
+                    // (udev usually adjusts permissions after creating the file, producing IN_ATTRIB)
+                    EventXIndexChanged();
+                }
+            }
+        }
+
+        CROSSPUT_STATS_ADD_GLOBAL(syscalls, 1); // final read that drained the queue
+    }
+
+
+    #ifdef CROSSPUT_FEATURE_FORCE
+    constexpr int16_t TranslateMagnitude(const float magnitude) noexcept
     {
         constexpr float M_LIMIT = static_cast<float>(std::numeric_limits<int16_t>::max()) / 1E3F;
         return static_cast<int16_t>(std::clamp(magnitude * 1E3F, -M_LIMIT, M_LIMIT));
@@ -1301,69 +2254,361 @@ namespace crossput
 
     // GLOBAL FUNCTION IMPLEMENTATIONS
 
+    uint64_t NowTimestamp()
+    {
+        return GetTimestampNow();
+    }
+
+
+    // create interface for an unregistered device, returns nullptr if the type of device is not recognized
+    LinuxDevice *CreateDevice(const LinuxHardwareID &hwid, const DeviceType type)
+    {
+        LinuxDevice *p_vdev;
+        switch (type)
+        {
+        case DeviceType::MOUSE: p_vdev = new LinuxMouse(hwid); break;
+        case DeviceType::KEYBOARD: p_vdev = new LinuxKeyboard(hwid); break;
+        case DeviceType::GAMEPAD: p_vdev = new LinuxGamepad(hwid); break;
+        default: return nullptr; // type of input produced by device not recognizable
+        }
+
+        nat_device_ids.insert(hwid);
+        glob_devices.Register(p_vdev);
+
+        DeviceStatusChanged(p_vdev, DeviceStatusChange::DISCOVERED);
+
+        return p_vdev;
+    }
+
+
     size_t DiscoverDevices()
     {
         ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
 
         size_t devices_created = 0;
-        const auto dev_analyzer = [&devices_created](const int fd, const unsigned int x, bool &close_fd) -> bool
+
+        if (nat_hotplug_fd >= 0)
         {
-            close_fd = true;
+            // the monitor keeps track of all accessible files, only search if anything changed
+            PollHotplugMonitor();
+            if (!nat_discovery_pending) { return 0; }
+            nat_discovery_pending = false;
 
-            // check if hardware is already registered
-            LinuxHardwareID hwid;
-            GetHWID(hwid, fd, x);
-            if (nat_device_ids.contains(hwid)) { return true; }
+            // files are visited in ascending order of X like during a scan, so the first recognized file of shared hardware creates the device
+            std::vector<std::pair<unsigned int, const LinuxHardwareID *>> files;
+            files.reserve(nat_eventx_index.size());
+            for (const auto &[hwid, x] : nat_eventx_index) { files.emplace_back(x, &hwid); }
+            std::sort(files.begin(), files.end(), [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
 
-            LinuxDevice *p_vdev;
-            switch (DeduceInputDeviceType(fd))
+            for (const auto &[x, p_hwid] : files)
             {
-            case DeviceType::MOUSE: p_vdev = new LinuxMouse(hwid); break;
-            case DeviceType::KEYBOARD: p_vdev = new LinuxKeyboard(hwid); break;
-            case DeviceType::GAMEPAD: p_vdev = new LinuxGamepad(hwid); break;
-            default: return true; // type of input produced by device not recognizable
+                const LinuxHardwareID &hwid = *p_hwid;
+
+                // check if hardware is already registered
+                if (nat_device_ids.contains(hwid)) { continue; }
+
+                // the file only has to be opened if the monitor did not probe it ahead of time
+                DeviceType type;
+                if (const auto it = nat_metadata_cache.find(LinuxEventXID{hwid, x}); it != nat_metadata_cache.end())
+                {
+                    type = it->second.type;
+                }
+                else
+                {
+                    const int fd = OpenEventXFile(x, O_RDONLY | O_NONBLOCK);
+                    if (fd < 0) { continue; }
+
+                    type = QueryDeviceMetadata(fd, hwid, x).type;
+                    close(fd);
+                }
+
+                if (CreateDevice(hwid, type) != nullptr) { devices_created++; }
             }
 
-            nat_device_ids.insert(hwid);
-            glob_interfaces.insert({p_vdev->GetID(), p_vdev});
+            return devices_created;
+        }
 
-            #ifdef CROSSPUT_FEATURE_CALLBACK
-            DeviceStatusChanged(p_vdev, DeviceStatusChange::DISCOVERED);
-            #endif // CROSSPUT_FEATURE_CALLBACK
+        const auto dev_analyzer = [&devices_created](EventXProbe &probe, bool &close_fd) -> bool
+        {
+            close_fd = true;
+
+            // check if hardware is already registered
+            if (nat_device_ids.contains(probe.hwid)) { return true; }
 
+            if (CreateDevice(probe.hwid, ResolveDeviceType(probe)) != nullptr) { devices_created++; }
             return true;
         };
 
-        ForeachEventXFile(dev_analyzer, O_RDONLY | O_NONBLOCK);
+        ForeachEventXFile(dev_analyzer, O_RDONLY | O_NONBLOCK, true, true);
 
         return devices_created;
     }
 
 
-    // LINUX DEVICE
-    std::string LinuxDevice::GetDisplayName() const
+    bool SetHotplugMonitorEnabled(const bool enabled)
     {
-        // use ioctl to query name
-        char name[256] = {};
-        return (is_connected_ && ioctl(file_desc_, EVIOCGNAME(sizeof(name) - 1), &name) >= 0)
-            ? std::string(name)
-            : std::string();
+        ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+        if (enabled == (nat_hotplug_fd >= 0)) { return true; }
+
+        if (!enabled)
+        {
+            if (nat_epoll_fd >= 0) { epoll_ctl(nat_epoll_fd, EPOLL_CTL_DEL, nat_hotplug_fd, nullptr); }
+            close(nat_hotplug_fd);
+            nat_hotplug_fd = -1;
+            nat_eventx_index.clear();
+            nat_discovery_pending = true;
+            return true;
+        }
+
+        const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0) { return false; }
+
+        if (inotify_add_watch(fd, DEV_INPUT_DIR.c_str(), IN_CREATE | IN_DELETE | IN_ATTRIB | IN_MOVED_TO | IN_MOVED_FROM) < 0)
+        {
+            close(fd);
+            return false;
+        }
+
+        // the watch is established before the initial scan, so no file can be missed
+        nat_hotplug_fd = fd;
+        RebuildEventXIndex();
+
+        if (nat_epoll_fd >= 0)
+        {
+            // monitor is identified via nullptr
+            epoll_event ev = {.events = EPOLLIN, .data = {.ptr = nullptr}};
+            epoll_ctl(nat_epoll_fd, EPOLL_CTL_ADD, nat_hotplug_fd, &ev);
+        }
+
+        return true;
     }
 
 
-    void LinuxDevice::Update()
+    bool IsHotplugMonitorEnabled()
     {
-        ProtectManagementAPI(std::format("crossput::IDevice::Update() - Device ID {}", id_));
-        
-        if (!(is_connected_ || TryConnect())) { return; }
+        return nat_hotplug_fd >= 0;
+    }
 
-        last_update_timestamp_ = GetTimestampNow();
-        PreInputHandling();
 
-        ssize_t stat;
-        input_event ev;
-        while ((stat = read(file_desc_, &ev, sizeof(input_event))) > 0)
+    void SetProbeThreadCount(const uint32_t count)
+    {
+        ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+        nat_probe_thread_count = std::clamp(count, static_cast<uint32_t>(1), MAX_PROBE_THREADS);
+    }
+
+
+    uint32_t GetProbeThreadCount()
+    {
+        return nat_probe_thread_count;
+    }
+
+
+    void SetReadingBufferEnabled(const bool enabled)
+    {
+        ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+        // evdev already delivers events in order without a history, the value is only stored
+        nat_buffer_readings = enabled;
+    }
+
+
+    bool IsReadingBufferEnabled()
+    {
+        return nat_buffer_readings;
+    }
+
+
+    void BeginDeviceUpdates()
+    {
+        #ifdef CROSSPUT_LINUX_IO_URING
+        if (!nat_uring_attempted) [[unlikely]]
+        {
+            // first invocation -> create io_uring instance watching all connected devices
+            nat_uring_attempted = true;
+            nat_p_uring = IoUring::TryCreate();
+            if (nat_p_uring != nullptr)
+            {
+                AddUringToEpollSet();
+                for (BaseInterface *const p_interface : glob_devices.Interfaces())
+                {
+                    LinuxDevice *const p_lxdev = dynamic_cast<LinuxDevice *>(p_interface);
+                    if (p_lxdev != nullptr && p_lxdev->IsConnected()) { p_lxdev->AddToUring(); }
+                }
+            }
+        }
+
+        if (nat_p_uring != nullptr)
+        {
+            if (!nat_p_uring->IsFunctional()) [[unlikely]]
+            {
+                // kernel rejected a read, devices take their remaining results before falling back to read()
+                nat_p_uring->Drain();
+                if (nat_p_uring->IsIdle())
+                {
+                    delete nat_p_uring;
+                    nat_p_uring = nullptr;
+                }
+                return;
+            }
+
+            nat_p_uring->BeginBatch();
+        }
+        #endif // CROSSPUT_LINUX_IO_URING
+    }
+
+
+    void EndDeviceUpdates()
+    {
+        #ifdef CROSSPUT_LINUX_IO_URING
+        if (nat_p_uring != nullptr) { nat_p_uring->EndBatch(); }
+        #endif // CROSSPUT_LINUX_IO_URING
+    }
+
+
+    size_t WaitForInput(std::vector<IDevice *> &ready_devices, const float timeout, bool *const p_hotplug_detected)
+    {
+        ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+        if (p_hotplug_detected != nullptr) { *p_hotplug_detected = false; }
+
+        if (nat_epoll_fd < 0)
+        {
+            // first invocation -> create epoll set containing all connected devices and the hotplug monitor
+            nat_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+            if (nat_epoll_fd < 0)
+            {
+                throw std::runtime_error(std::format("Failed to create epoll instance (errno {}).", errno));
+            }
+
+            for (BaseInterface *const p_interface : glob_devices.Interfaces())
+            {
+                LinuxDevice *const p_lxdev = dynamic_cast<LinuxDevice *>(p_interface);
+                if (p_lxdev != nullptr && p_lxdev->IsConnected()) { p_lxdev->AddToEpollSet(); }
+            }
+
+            if (nat_hotplug_fd >= 0)
+            {
+                epoll_event ev = {.events = EPOLLIN, .data = {.ptr = nullptr}};
+                epoll_ctl(nat_epoll_fd, EPOLL_CTL_ADD, nat_hotplug_fd, &ev);
+            }
+
+            #ifdef CROSSPUT_LINUX_IO_URING
+            AddUringToEpollSet();
+            #endif // CROSSPUT_LINUX_IO_URING
+
+            nat_wait_hotplug_generation = nat_hotplug_generation;
+        }
+
+        using clock = std::chrono::steady_clock;
+        const bool infinite = IsInfiniteWaitTimeout(timeout);
+        const clock::time_point deadline = clock::now() + std::chrono::duration_cast<clock::duration>(std::chrono::duration<float>(infinite ? 0.0F : timeout));
+
+        // events of any additional ready devices are reported during the next invocation
+        constexpr int MAX_EVENTS = 64;
+        epoll_event events[MAX_EVENTS];
+
+        while (true)
+        {
+            const size_t first_ready = ready_devices.size();
+            size_t num_ready = 0;
+
+            #ifdef CROSSPUT_LINUX_IO_URING
+            // results of completed reads are reported without blocking
+            if (nat_p_uring != nullptr) { num_ready = nat_p_uring->CollectReady(ready_devices); }
+            #endif // CROSSPUT_LINUX_IO_URING
+
+            int timeout_ms = -1;
+            if (num_ready > 0)
+            {
+                timeout_ms = 0;
+            }
+            else if (!infinite)
+            {
+                const int64_t remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - clock::now()).count();
+                timeout_ms = static_cast<int>(std::clamp(remaining, int64_t{0}, static_cast<int64_t>(std::numeric_limits<int>::max())));
+            }
+
+            const int num_events = epoll_wait(nat_epoll_fd, events, MAX_EVENTS, timeout_ms);
+            CROSSPUT_STATS_ADD_GLOBAL(syscalls, 1);
+            if (num_events < 0)
+            {
+                if (errno == EINTR)
+                {
+                    // results are collected again
+                    ready_devices.resize(first_ready);
+                    continue;
+                }
+
+                throw std::runtime_error(std::format("Failed to wait for input (errno {}).", errno));
+            }
+
+            #ifdef CROSSPUT_LINUX_IO_URING
+            const auto is_uring_event = [](const epoll_event &ev) { return ev.data.ptr == &nat_p_uring; };
+            if (num_ready == 0 && std::any_of(events, events + num_events, is_uring_event))
+            {
+                // reads completed while waiting
+                num_ready = nat_p_uring->CollectReady(ready_devices);
+            }
+            #endif // CROSSPUT_LINUX_IO_URING
+
+            for (int i = 0; i < num_events; i++)
+            {
+                #ifdef CROSSPUT_LINUX_IO_URING
+                if (is_uring_event(events[i])) { continue; }
+                #endif // CROSSPUT_LINUX_IO_URING
+
+                LinuxDevice *const p_lxdev = static_cast<LinuxDevice *>(events[i].data.ptr);
+                if (p_lxdev != nullptr)
+                {
+                    // input is pending, or the file was removed (EPOLLHUP/EPOLLERR) and the device will disconnect during its update,
+                    // devices with results of completed reads were already reported
+                    if (std::find(ready_devices.begin() + first_ready, ready_devices.end(), p_lxdev) != ready_devices.end()) { continue; }
+                    ready_devices.push_back(p_lxdev);
+                    num_ready++;
+                }
+                else
+                {
+                    PollHotplugMonitor();
+                }
+            }
+
+            const bool hotplug_detected = nat_wait_hotplug_generation != nat_hotplug_generation;
+            if (hotplug_detected)
+            {
+                // accessible files changed, disconnected devices with matching hardware may be able to reconnect
+                nat_wait_hotplug_generation = nat_hotplug_generation;
+                if (p_hotplug_detected != nullptr) { *p_hotplug_detected = true; }
+                for (BaseInterface *const p_interface : glob_devices.Interfaces())
+                {
+                    LinuxDevice *const p_lxdev = dynamic_cast<LinuxDevice *>(p_interface);
+                    if (p_lxdev != nullptr && !p_lxdev->IsConnected() && nat_eventx_index.contains(p_lxdev->GetHardwareID()))
+                    {
+                        ready_devices.push_back(p_lxdev);
+                        num_ready++;
+                    }
+                }
+            }
+
+            // notifications of the monitor which did not change the set of accessible files keep waiting
+            if (num_ready > 0 || hotplug_detected || num_events == 0) { return num_ready; }
+        }
+    }
+
+
+    // LINUX DEVICE
+    std::string LinuxDevice::GetDisplayName() const
+    {
+        return is_connected_ ? display_name_ : std::string();
+    }
+
+
+    bool LinuxDevice::HandleEvents(const input_event *const p_events, const size_t num_events)
+    {
+        CROSSPUT_STATS_ADD(events_read, num_events);
+        for (size_t i = 0; i < num_events; i++)
         {
+            const input_event &ev = p_events[i];
             switch (ev.type)
             {
             case EV_SYN:
@@ -1372,23 +2617,17 @@ namespace crossput
                     // buffer overrun, drop events
                     pending_events_.clear();
                     fsync(file_desc_);
+                    CROSSPUT_STATS_ADD(overruns, 1);
+                    CROSSPUT_STATS_ADD(syscalls, 1);
                     HandleBufferOverrun(GetEventTimestamp(ev));
-                    break;
                 }
-
-                if (ev.code == SYN_REPORT)
+                else if (ev.code == SYN_REPORT)
                 {
                     // process a group of events (device-specific implementation)
                     last_update_timestamp_ = std::max(last_update_timestamp_, GetEventTimestamp(ev));
+                    CROSSPUT_STATS_ADD(event_groups, 1);
                     HandlePendingEvents();
                 }
-
-                if (!is_connected_)
-                {
-                    // error in event handler caused disconnect, abort
-                    return;
-                }
-
                 break;
 
             #ifdef CROSSPUT_FEATURE_FORCE
@@ -1396,13 +2635,95 @@ namespace crossput
                 HandleFFStatusEvent(ev);
                 break;
             #endif // CROSSPUT_FEATURE_FORCE
-                
+
             default:
                 // device implementation handles event
                 pending_events_.push_back(ev);
                 break;
             }
+
+            if (!is_connected_) [[unlikely]]
+            {
+                // error in event handler caused disconnect, abort
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+
+    void LinuxDevice::Update()
+    {
+        ProtectManagementAPI("crossput::IDevice::Update()", id_);
+        CROSSPUT_STATS_TIME_UPDATE();
+        MarkServiced();
+        
+        if (!(is_connected_ || TryConnect())) { return; }
+
+        last_update_timestamp_ = GetTimestampNow();
+        PreInputHandling();
+
+        // (re-)allocate read buffer when the batch size was changed
+        if (read_buffer_size_ != read_batch_size_) [[unlikely]]
+        {
+            read_buffer_ = std::make_unique<input_event[]>(read_batch_size_);
+            read_buffer_size_ = read_batch_size_;
+        }
+
+        const size_t read_len = static_cast<size_t>(read_buffer_size_) * sizeof(input_event);
+        ssize_t stat;
+
+        #ifdef CROSSPUT_LINUX_IO_URING
+        if (uring_watch_ != NO_URING_WATCH)
+        {
+            // the io_uring instance keeps a read armed, its completions are handled without a system call
+            const input_event *p_events = nullptr;
+            IoUring::ReadStatus status;
+            bool has_result = false;
+            bool is_full = false;
+            while ((status = nat_p_uring->TakeRead(uring_watch_, p_events, stat)) == IoUring::ReadStatus::COMPLETED)
+            {
+                if (stat < 0)
+                {
+                    // error during event reading
+                    Disconnect();
+                    return;
+                }
+
+                if (!HandleEvents(p_events, static_cast<size_t>(stat) / sizeof(input_event))) { return; }
+                has_result = true;
+                is_full = static_cast<size_t>(stat) == read_len;
+            }
+
+            // the armed read receives all further events, and a partially filled buffer means that the kernel-side queue was drained
+            // (otherwise read directly, e.g. before the first read was armed)
+            if (status == IoUring::ReadStatus::IN_FLIGHT) { return; }
+            if (!nat_p_uring->IsFunctional()) [[unlikely]]
+            {
+                // all results were taken, fall back to read() from now on
+                nat_p_uring->Unwatch(uring_watch_);
+                uring_watch_ = NO_URING_WATCH;
+            }
+            else if (has_result && !is_full)
+            {
+                nat_p_uring->Rearm(uring_watch_);
+                return;
+            }
+        }
+        #endif // CROSSPUT_LINUX_IO_URING
+
+        do
+        {
+            // read as many events as possible with a single system call
+            stat = read(file_desc_, read_buffer_.get(), read_len);
+            CROSSPUT_STATS_ADD(syscalls, 1);
+            if (stat <= 0) { break; }
+
+            if (!HandleEvents(read_buffer_.get(), static_cast<size_t>(stat) / sizeof(input_event))) { return; }
         }
+        // a partially filled buffer means that the kernel-side queue was drained, no need to read again
+        while (static_cast<size_t>(stat) == read_len);
 
         if (stat < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
         {
@@ -1410,6 +2731,37 @@ namespace crossput
             Disconnect();
             return;
         }
+
+        #ifdef CROSSPUT_LINUX_IO_URING
+        if (uring_watch_ != NO_URING_WATCH) { nat_p_uring->Rearm(uring_watch_); }
+        #endif // CROSSPUT_LINUX_IO_URING
+    }
+
+
+    bool LinuxDevice::TryConnectFile(const int fd, const unsigned int x)
+    {
+        LinuxHardwareID hwid;
+        GetHWID(hwid, fd, x);
+
+        // hardware ID and device type must match
+        if (hardware_id_ == hwid && QueryDeviceMetadata(fd, hwid, x).type == GetType())
+        {
+            // set timestamp clock ID
+            int clockid = CROSSPUT_TSCLOCKID;
+            if (ioctl(fd, EVIOCSCLOCKID, &clockid) >= 0)
+            {
+                file_desc_ = fd;
+                eventx_ = x;
+                is_connected_ = true;
+                AddToEpollSet();
+                #ifdef CROSSPUT_LINUX_IO_URING
+                AddToUring();
+                #endif // CROSSPUT_LINUX_IO_URING
+                return true;
+            }
+        }
+
+        return false;
     }
 
 
@@ -1417,40 +2769,46 @@ namespace crossput
     {
         if (is_connected_) [[unlikely]] { return true; }
 
-        unsigned int event_x;
-        const auto analyze_device = [this, &event_x](const int fd, const unsigned int x, bool &close_fd) -> bool
+        if (nat_hotplug_fd >= 0)
         {
-            close_fd = true;
+            // only attempt to reconnect after the set of accessible files changed
+            PollHotplugMonitor();
+            if (hotplug_generation_ == nat_hotplug_generation) { return false; }
+            hotplug_generation_ = nat_hotplug_generation;
+            CROSSPUT_STATS_ADD(reconnect_attempts, 1);
 
-            LinuxHardwareID hwid;
-            GetHWID(hwid, fd, x);
-
-            // hardware ID and device type must match
-            if (this->hardware_id_ == hwid && DeduceInputDeviceType(fd) == this->GetType())
+            // only open files which are known to have a matching hardware ID
+            auto [it, end] = nat_eventx_index.equal_range(hardware_id_);
+            for (; it != end; it++)
             {
-                // set timestamp clock ID
-                int clockid = CROSSPUT_TSCLOCKID;
-                if (ioctl(fd, EVIOCSCLOCKID, &clockid) >= 0)
-                {
-                    close_fd = false;
-                    event_x = x;
-                    this->file_desc_ = fd;
-                    this->is_connected_ = true;
-                    return false; // stop searching for devices
-                }
+                const int fd = OpenEventXFile(it->second, O_RDWR | O_NONBLOCK);
+                CROSSPUT_STATS_ADD(syscalls, 1);
+                if (fd < 0) { continue; }
+                if (TryConnectFile(fd, it->second)) { break; }
+                close(fd);
             }
+        }
+        else
+        {
+            CROSSPUT_STATS_ADD(reconnect_attempts, 1);
+            const auto analyze_device = [this](EventXProbe &probe, bool &close_fd) -> bool
+            {
+                close_fd = !(probe.hwid == this->hardware_id_ && this->TryConnectFile(probe.fd, probe.x));
+                return close_fd; // stop searching for devices once connected
+            };
 
-            return true;
-        };
-
-        ForeachEventXFile(analyze_device, O_RDWR | O_NONBLOCK);
+            // probed sequentially, every attempt would otherwise start workers that open all files at once
+            ForeachEventXFile(analyze_device, O_RDWR | O_NONBLOCK, false, false);
+        }
 
         if (is_connected_)
         {
+            LinuxDeviceMetadata &metadata = QueryDeviceMetadata(file_desc_, hardware_id_, eventx_);
+            display_name_ = metadata.name;
+
             #ifdef CROSSPUT_FEATURE_FORCE
-            // query force capabilities
-            unsigned char ff_capabilities[(FF_CNT - 1) / 8 + 1] = {};
-            ioctl(file_desc_, EVIOCGBIT(EV_FF, sizeof(ff_capabilities)), ff_capabilities);
+            // force capabilities
+            const unsigned char *const ff_capabilities = metadata.ff_capabilities;
 
             #define QUERY_FF_CAPABILITY_(enum_name, code) supported_forces_[static_cast<int>(ForceType::enum_name)] = GETBIT_(ff_capabilities, code)
             #define ENABLE_FF_CAPABILITY_(enum_name) supported_forces_[static_cast<int>(ForceType::enum_name)] = true
@@ -1484,11 +2842,9 @@ namespace crossput
             (void)DisableAutocenterImpl();
             #endif // CROSSPUT_FEATURE_FORCE
 
-            OnConnected();
+            OnConnected(metadata);
 
-            #ifdef CROSSPUT_FEATURE_CALLBACK
             DeviceStatusChanged(this, DeviceStatusChange::CONNECTED);
-            #endif // CROSSPUT_FEATURE_CALLBACK
         }
 
         return is_connected_;
@@ -1501,7 +2857,12 @@ namespace crossput
 
         is_connected_ = false;
         last_update_timestamp_ = 0;
+        hotplug_generation_ = FORCE_RECONNECT_GENERATION;
         pending_events_.clear();
+        display_name_.clear();
+
+        // hardware might have changed while disconnected
+        InvalidateDeviceMetadata(hardware_id_, eventx_);
 
         #ifdef CROSSPUT_FEATURE_FORCE
         supported_forces_.reset();
@@ -1515,9 +2876,7 @@ namespace crossput
         CloseDevFile();
         OnDisconnected();
 
-        #ifdef CROSSPUT_FEATURE_CALLBACK
         DeviceStatusChanged(this, DeviceStatusChange::DISCONNECTED);
-        #endif // CROSSPUT_FEATURE_CALLBACK
     }
 
 
@@ -1526,6 +2885,9 @@ namespace crossput
         if (file_desc_ < 0) { return; }
         
         #ifdef CROSSPUT_FEATURE_FORCE
+        // a force stream must neither upload to the file while it is closed, nor afterwards
+        const std::lock_guard<std::mutex> lock(force_mutex_);
+
         // orphan forces
         for (auto [effect_id, p_force] : force_mapping)
         {
@@ -1533,8 +2895,23 @@ namespace crossput
             p_force->status_ = ForceStatus::INACTIVE;
             ioctl(file_desc_, EVIOCRMFF, effect_id);
         }
+
+        // drop pooled effect slots
+        for (EffectSlotPool &pool : effect_slot_pools_)
+        {
+            for (uint32_t i = 0; i < pool.size; i++) { ioctl(file_desc_, EVIOCRMFF, pool.effect_ids[i]); }
+            pool.size = 0;
+        }
         #endif // CROSSPUT_FEATURE_FORCE
 
+        if (nat_epoll_fd >= 0) { epoll_ctl(nat_epoll_fd, EPOLL_CTL_DEL, file_desc_, nullptr); }
+        #ifdef CROSSPUT_LINUX_IO_URING
+        if (uring_watch_ != NO_URING_WATCH)
+        {
+            nat_p_uring->Unwatch(uring_watch_);
+            uring_watch_ = NO_URING_WATCH;
+        }
+        #endif // CROSSPUT_LINUX_IO_URING
         close(file_desc_);
         file_desc_ = -1;
     }
@@ -1590,24 +2967,70 @@ namespace crossput
 
     bool LinuxDevice::TryCreateForce(const uint32_t motor_index, const ForceType type, IForce *&p_force)
     {
-        const int type_index = static_cast<int>(type);
-        if (SupportsForce(motor_index, type) && force_count_noorph_ < FF_MAX_EFFECTS)
+        int16_t effect_id;
+        if (SupportsForce(motor_index, type) && force_count_noorph_ < FF_MAX_EFFECTS && AcquireEffectSlot(type, effect_id))
+        {
+            // effect allocation successful, now create interface
+            LinuxForce *const p_lxforce = new LinuxForce(this, type, effect_id);
+            InsertForce(p_lxforce);
+            force_mapping.insert({effect_id, p_lxforce});
+            p_force = p_lxforce;
+            force_count_noorph_++;
+            return true;
+        }
+
+        p_force = nullptr;
+        return false;
+    }
+
+
+    bool LinuxDevice::AcquireEffectSlot(const ForceType type, int16_t &effect_id)
+    {
+        // reuse the slot of a previously destroyed force, its effect is re-uploaded by the first WriteParams()
+        EffectSlotPool &pool = effect_slot_pools_[static_cast<int>(type)];
+        if (pool.size > 0)
+        {
+            effect_id = pool.effect_ids[--pool.size];
+            return true;
+        }
+
+        // allocate new slot
+        ff_effect effect = {.type = effect_type_mapping[static_cast<int>(type)], .id = -1};
+        while (ioctl(file_desc_, EVIOCSFF, &effect) < 0)
+        {
+            // slots of the device are exhausted, free a pooled one of a different type and retry
+            if (errno != ENOSPC || !EvictPooledEffectSlot()) { return false; }
+            effect.id = -1;
+        }
+
+        effect_id = effect.id;
+        return effect_id >= 0;
+    }
+
+
+    void LinuxDevice::ReleaseEffectSlot(const ForceType type, const int16_t effect_id)
+    {
+        // stop effect, the slot may be handed out again before its parameters are re-uploaded
+        const input_event ev = {.type = EV_FF, .code = static_cast<uint16_t>(effect_id), .value = 0};
+        [[maybe_unused]] const ssize_t ignore = write(file_desc_, &ev, sizeof(input_event));
+
+        EffectSlotPool &pool = effect_slot_pools_[static_cast<int>(type)];
+        if (pool.size < MAX_POOLED_EFFECT_SLOTS) { pool.effect_ids[pool.size++] = effect_id; }
+        else { ioctl(file_desc_, EVIOCRMFF, effect_id); }
+    }
+
+
+    bool LinuxDevice::EvictPooledEffectSlot()
+    {
+        for (EffectSlotPool &pool : effect_slot_pools_)
         {
-            // create effect
-            ff_effect effect = {.type = effect_type_mapping[type_index], .id = -1};
-            if (ioctl(file_desc_, EVIOCSFF, &effect) >= 0 && effect.id >= 0)
+            if (pool.size > 0)
             {
-                // effect allocation successful, now create interface
-                LinuxForce *const p_lxforce = new LinuxForce(this, type, effect.id);
-                forces_.insert({p_lxforce->GetID(), p_lxforce});
-                force_mapping.insert({effect.id, p_lxforce});
-                p_force = p_lxforce;
-                force_count_noorph_++;
+                ioctl(file_desc_, EVIOCRMFF, pool.effect_ids[--pool.size]);
                 return true;
             }
         }
 
-        p_force = nullptr;
         return false;
     }
     #endif // CROSSPUT_FEATURE_FORCE
@@ -1652,12 +3075,8 @@ namespace crossput
                 {
                     const unsigned short mb = ev.code - BTN_LEFT;
                     const float value = ev.value != 0 ? 1.0F : 0.0F;
-                    #ifdef CROSSPUT_FEATURE_CALLBACK
                     bool state;
-                    if (button_data_[mb].Modify(value, GetEventTimestamp(ev), state)) { ButtonChanged(static_cast<uint32_t>(mb), value, state); }
-                    #else
-                    button_data_[mb].Modify(value, GetEventTimestamp(ev));
-                    #endif // CROSSPUT_FEATURE_CALLBACK
+                    if (button_data_.Modify(mb, value, GetEventTimestamp(ev), state)) { ButtonChanged(static_cast<uint32_t>(mb), value, state, GetEventTimestamp(ev)); }
                 }
                 break;
 
@@ -1669,6 +3088,7 @@ namespace crossput
             }
         }
 
+        const timestamp_t timestamp = GetPendingEventsTimestamp();
         pending_events_.clear();
 
         // accumulate movement
@@ -1678,9 +3098,7 @@ namespace crossput
             data_.y += dy;
             data_.dx += dx;
             data_.dy += dy;
-            #ifdef CROSSPUT_FEATURE_CALLBACK
-            MouseMoved(data_.x, data_.y, dx, dy);
-            #endif // CROSSPUT_FEATURE_CALLBACK
+            MouseMoved(data_.x, data_.y, dx, dy, timestamp);
         }
 
         // accumulate scroll
@@ -1691,9 +3109,7 @@ namespace crossput
             data_.sy += hrsdy;
             data_.sdx += hrsdx;
             data_.sdy += hrsdy;
-            #ifdef CROSSPUT_FEATURE_CALLBACK
-            MouseScrolled(data_.sx, data_.sy, hrsdx, hrsdy);
-            #endif // CROSSPUT_FEATURE_CALLBACK
+            MouseScrolled(data_.sx, data_.sy, hrsdx, hrsdy, timestamp);
         }
         else if (sdx != 0 || sdy != 0)
         {
@@ -1704,9 +3120,7 @@ namespace crossput
             data_.sy += sdy_120;
             data_.sdx += sdx_120;
             data_.sdy += sdy_120;
-            #ifdef CROSSPUT_FEATURE_CALLBACK
-            MouseScrolled(data_.sx, data_.sy, sdx_120, sdy_120);
-            #endif // CROSSPUT_FEATURE_CALLBACK
+            MouseScrolled(data_.sx, data_.sy, sdx_120, sdy_120, timestamp);
         }
     }
 
@@ -1714,6 +3128,7 @@ namespace crossput
     void LinuxMouse::HandleBufferOverrun(const timestamp_t timestamp)
     {
         unsigned char globks[(KEY_CNT - 1) / 8 + 1];
+        CROSSPUT_STATS_ADD(syscalls, 1);
         if (ioctl(file_desc_, EVIOCGKEY(sizeof(globks)), &globks) < 0)
         {
             // cannot query global key states
@@ -1725,19 +3140,15 @@ namespace crossput
         for (unsigned int mb = 0; mb < LinuxMouse::NUM_BUTTONS; mb++)
         {
             const float value = GETBIT_(globks, BTN_LEFT + mb) ? 1.0F : 0.0F;
-            #ifdef CROSSPUT_FEATURE_CALLBACK
             bool state;
-            if (button_data_[mb].Modify(value, timestamp, state)) { ButtonChanged(static_cast<uint32_t>(mb), value, state); }
-            #else
-            button_data_[mb].Modify(value, timestamp);
-            #endif // CROSSPUT_FEATURE_CALLBACK
+            if (button_data_.Modify(mb, value, timestamp, state)) { ButtonChanged(static_cast<uint32_t>(mb), value, state, timestamp); }
         }
     }
 
 
     void LinuxMouse::OnDisconnected()
     {
-        std::memset(button_data_, 0, sizeof(button_data_));
+        button_data_.Reset();
         data_ = {};
     }
 
@@ -1779,27 +3190,27 @@ namespace crossput
     {
         if (index < LinuxMouse::NUM_BUTTONS)
         {
-            button_data_[index].SetThreshold(std::clamp(threshold, 0.0F, 1.0F));
+            button_data_.SetThreshold(index, std::clamp(threshold, 0.0F, 1.0F));
         }
     }
 
     constexpr void LinuxMouse::SetGlobalThreshold(float threshold)
     {
         threshold = std::clamp(threshold, 0.0F, 1.0F);
-        for (unsigned int i = 0; i < LinuxMouse::NUM_BUTTONS; i++) { button_data_[i].SetThreshold(threshold); }
+        for (unsigned int i = 0; i < LinuxMouse::NUM_BUTTONS; i++) { button_data_.SetThreshold(i, threshold); }
     }
 
     constexpr float LinuxMouse::GetButtonThreshold(const uint32_t index) const
     {
         return index < LinuxMouse::NUM_BUTTONS
-            ? button_data_[index].Threshold()
+            ? button_data_.Threshold(index)
             : 0.0F;
     }
 
     constexpr float LinuxMouse::GetButtonValue(const uint32_t index) const
     {
         return (is_connected_ && index < LinuxMouse::NUM_BUTTONS)
-            ? button_data_[index].Value()
+            ? button_data_.Value(index)
             : 0.0F;
     }
 
@@ -1807,9 +3218,8 @@ namespace crossput
     {
         if (is_connected_ && index < LinuxMouse::NUM_BUTTONS)
         {
-            const TSTV &d = button_data_[index];
-            time = TimestampDeltaSeconds(d.Timestamp(), last_update_timestamp_);
-            return d.State();
+            time = TimestampDeltaSeconds(button_data_.Timestamp(index), last_update_timestamp_);
+            return button_data_.State(index);
         }
         else
         {
@@ -1818,6 +3228,25 @@ namespace crossput
         }
     }
 
+    void LinuxMouse::GetButtonStates(uint64_t *const states, const size_t num_words) const
+    {
+        button_data_.CopyStates(states, num_words, is_connected_);
+    }
+
+    uint32_t LinuxMouse::GetButtonValues(float *const values, const uint32_t max_count) const
+    {
+        const uint32_t n = std::min(max_count, LinuxMouse::GetButtonCount());
+        button_data_.CopyValues(values, n, is_connected_);
+        return n;
+    }
+
+    uint32_t LinuxMouse::GetButtonTimestamps(uint64_t *const timestamps, const uint32_t max_count) const
+    {
+        const uint32_t n = std::min(max_count, LinuxMouse::GetButtonCount());
+        button_data_.CopyTimestamps(timestamps, n, is_connected_);
+        return n;
+    }
+
 
     // LINUX KEYBOARD
     void LinuxKeyboard::HandlePendingEvents()
@@ -1833,12 +3262,8 @@ namespace crossput
                 if (IsValidKey(key))
                 {
                     const float value = ev.value != 0 ? 1.0F : 0.0F;
-                    #ifdef CROSSPUT_FEATURE_CALLBACK
                     bool state;
-                    if (key_data_[static_cast<int>(key)].Modify(value, GetEventTimestamp(ev), state, num_keys_pressed_)) { KeyChanged(key, value, state); }
-                    #else
-                    key_data_[static_cast<int>(key)].Modify(value, GetEventTimestamp(ev), num_keys_pressed_);
-                    #endif // CROSSPUT_FEATURE_CALLBACK
+                    if (key_data_.Modify(static_cast<int>(key), value, GetEventTimestamp(ev), state, num_keys_pressed_)) { KeyChanged(key, value, state, GetEventTimestamp(ev)); }
                 }
             }
             #ifdef CROSSPUT_FEATURE_FORCE
@@ -1856,6 +3281,7 @@ namespace crossput
     void LinuxKeyboard::HandleBufferOverrun(const timestamp_t timestamp)
     {
         unsigned char globks[(KEY_CNT - 1) / 8 + 1];
+        CROSSPUT_STATS_ADD(syscalls, 1);
         if (ioctl(file_desc_, EVIOCGKEY(sizeof(globks)), &globks) < 0)
         {
             // cannot query global key states
@@ -1867,19 +3293,15 @@ namespace crossput
         for (unsigned int k = 0; k < NUM_KEY_CODES; k++)
         {
             const float value = GETBIT_(globks, reverse_keycode_mapping[k]) ? 1.0F : 0.0F;
-            #ifdef CROSSPUT_FEATURE_CALLBACK
             bool state;
-            if (key_data_[k].Modify(value, timestamp, state, num_keys_pressed_)) { KeyChanged(static_cast<Key>(k), value, state); }
-            #else
-            key_data_[k].Modify(value, timestamp, num_keys_pressed_);
-            #endif // CROSSPUT_FEATURE_CALLBACK
+            if (key_data_.Modify(k, value, timestamp, state, num_keys_pressed_)) { KeyChanged(static_cast<Key>(k), value, state, timestamp); }
         }
     }
 
 
     void LinuxKeyboard::OnDisconnected()
     {
-        std::memset(key_data_, 0, sizeof(key_data_));
+        key_data_.Reset();
         num_keys_pressed_ = 0;
     }
 
@@ -1893,35 +3315,34 @@ namespace crossput
     {
         if (IsValidKey(key))
         {
-            key_data_[static_cast<int>(key)].SetThreshold(std::clamp(threshold, 0.0F, 1.0F));
+            key_data_.SetThreshold(static_cast<int>(key), std::clamp(threshold, 0.0F, 1.0F));
         }
     }
 
     constexpr void LinuxKeyboard::SetGlobalThreshold(float threshold)
     {
         threshold = std::clamp(threshold, 0.0F, 1.0F);
-        for (unsigned int i = 0; i < NUM_KEY_CODES; i++) { key_data_[i].SetThreshold(threshold); }
+        for (unsigned int i = 0; i < NUM_KEY_CODES; i++) { key_data_.SetThreshold(i, threshold); }
     }
 
     constexpr float LinuxKeyboard::GetKeyThreshold(const Key key) const
     {
         return IsValidKey(key)
-            ? key_data_[static_cast<int>(key)].Threshold()
+            ? key_data_.Threshold(static_cast<int>(key))
             : 0.0F;
     }
 
     constexpr float LinuxKeyboard::GetKeyValue(const Key key) const
     {
-        return (is_connected_ && IsValidKey(key)) ? key_data_[static_cast<int>(key)].Value() : 0.0F;
+        return (is_connected_ && IsValidKey(key)) ? key_data_.Value(static_cast<int>(key)) : 0.0F;
     }
 
     constexpr bool LinuxKeyboard::GetKeyState(const Key key, float &time) const
     {
         if (is_connected_ && IsValidKey(key))
         {
-            const TSTV &d = key_data_[static_cast<int>(key)];
-            time = TimestampDeltaSeconds(d.Timestamp(), last_update_timestamp_);
-            return d.State();
+            time = TimestampDeltaSeconds(key_data_.Timestamp(static_cast<int>(key)), last_update_timestamp_);
+            return key_data_.State(static_cast<int>(key));
         }
         else
         {
@@ -1930,6 +3351,21 @@ namespace crossput
         }
     }
 
+    void LinuxKeyboard::GetKeyStates(uint64_t *const states) const
+    {
+        key_data_.CopyStates(states, NUM_KEY_STATE_WORDS, is_connected_);
+    }
+
+    void LinuxKeyboard::GetKeyValues(float *const values) const
+    {
+        key_data_.CopyValues(values, NUM_KEY_CODES, is_connected_);
+    }
+
+    void LinuxKeyboard::GetKeyTimestamps(uint64_t *const timestamps) const
+    {
+        key_data_.CopyTimestamps(timestamps, NUM_KEY_CODES, is_connected_);
+    }
+
 
     // LINUX GAMEPAD
     void LinuxGamepad::HandlePendingEvents()
@@ -1977,13 +3413,9 @@ namespace crossput
 
         const auto handle_analog_trigger = [this](const int32_t raw_value, const timestamp_t timestamp, const int trigger_index, const Button b)
         {
-            const float value = NormalizeAbsValue(this->trigger_norms_[trigger_index], raw_value);
-            #ifdef CROSSPUT_FEATURE_CALLBACK
+            const float value = this->ProcessButton(b, NormalizeAbsValue(this->trigger_norms_[trigger_index], raw_value));
             bool state;
-            if (this->button_data_[static_cast<int>(b)].Modify(value, timestamp, state)) { this->ButtonChanged(b, value, state); }
-            #else
-            this->button_data_[static_cast<int>(b)].Modify(value, timestamp);
-            #endif // CROSSPUT_FEATURE_CALLBACK
+            if (this->button_data_.Modify(static_cast<int>(b), value, timestamp, state)) { this->ButtonChanged(b, value, state, timestamp); }
         };
 
         const auto handle_digital_button = [this](const int32_t raw_value, const timestamp_t timestamp, const Button b)
@@ -1997,12 +3429,8 @@ namespace crossput
             if (p_norm != nullptr) { return; }
 
             const float value = raw_value != 0 ? 1.0F : 0.0F;
-            #ifdef CROSSPUT_FEATURE_CALLBACK
             bool state;
-            if (this->button_data_[b_index].Modify(value, timestamp, state)) { ButtonChanged(b, value, state); }
-            #else
-            this->button_data_[b_index].Modify(value, timestamp);
-            #endif // CROSSPUT_FEATURE_CALLBACK
+            if (this->button_data_.Modify(b_index, value, timestamp, state)) { ButtonChanged(b, value, state, timestamp); }
         };
 
         ThumbstickMod tsmod = {};
@@ -2060,34 +3488,19 @@ namespace crossput
         // apply thumbstick modification
         if (tsmod.has_target)
         {
-            [[maybe_unused]] bool do_callback = false; // only used for CROSSPUT_FEATURE_CALLBACK
-            float x, y;
             const size_t tx = static_cast<size_t>(tsmod.target) * 2;
             const size_t ty = tx + 1;
-            float &dest_x = thumbstick_values_[tx];
-            float &dest_y = thumbstick_values_[ty];
-
-            if (tsmod.has_x)
-            {
-                x = NormalizeAbsValue(thumbstick_norms_[tx], tsmod.x);
-                #ifdef CROSSPUT_FEATURE_CALLBACK
-                do_callback |= (x != dest_x);
-                #endif // CROSSPUT_FEATURE_CALLBACK
-                dest_x = x;
-            }
+            float x = tsmod.has_x ? NormalizeAbsValue(thumbstick_norms_[tx], tsmod.x) : RawThumbstickAxis(tx);
+            float y = tsmod.has_y ? -NormalizeAbsValue(thumbstick_norms_[ty], tsmod.y) : RawThumbstickAxis(ty); // negate Y
+            ProcessThumbstick(tsmod.target, x, y);
 
-            if (tsmod.has_y)
+            // only the processed position is reported, which filters out jitter within the deadzone
+            if (x != thumbstick_values_[tx] || y != thumbstick_values_[ty])
             {
-                y = -NormalizeAbsValue(thumbstick_norms_[ty], tsmod.y); // negate Y
-                #ifdef CROSSPUT_FEATURE_CALLBACK
-                do_callback |= (y != dest_y);
-                #endif // CROSSPUT_FEATURE_CALLBACK
-                dest_y = y;
+                thumbstick_values_[tx] = x;
+                thumbstick_values_[ty] = y;
+                ThumbstickChanged(tsmod.target, x, y, GetPendingEventsTimestamp());
             }
-
-            #ifdef CROSSPUT_FEATURE_CALLBACK
-            if (do_callback) { ThumbstickChanged(tsmod.target, dest_x, dest_y); }
-            #endif // CROSSPUT_FEATURE_CALLBACK
         }
 
         pending_events_.clear();
@@ -2097,6 +3510,7 @@ namespace crossput
     void LinuxGamepad::HandleBufferOverrun(const timestamp_t timestamp)
     {
         unsigned char globks[(KEY_CNT - 1) / 8 + 1];
+        CROSSPUT_STATS_ADD(syscalls, 1);
         if (ioctl(file_desc_, EVIOCGKEY(sizeof(globks)), &globks) < 0)
         {
             // cannot query global key states
@@ -2107,19 +3521,17 @@ namespace crossput
         const auto handle_digital_button = [this, &globks, timestamp](const Button b)
         {
             const float value = GETBIT_(globks, reverse_button_mapping[static_cast<int>(b)]) ? 1.0F : 0.0F;
-            #ifdef CROSSPUT_FEATURE_CALLBACK
             bool state;
-            if (this->button_data_[static_cast<int>(b)].Modify(value, timestamp, state)) { ButtonChanged(b, value, state); }
-            #else
-            this->button_data_[static_cast<int>(b)].Modify(value, timestamp);
-            #endif // CROSSPUT_FEATURE_CALLBACK
+            if (this->button_data_.Modify(static_cast<int>(b), value, timestamp, state)) { ButtonChanged(b, value, state, timestamp); }
         };
 
-        const auto query_thumbstick = [this](const uint32_t index, const unsigned short code_x, const unsigned short code_y)
+        const auto query_thumbstick = [this, timestamp](const uint32_t index, const unsigned short code_x, const unsigned short code_y)
         {
+            CROSSPUT_STATS_ADD(syscalls, 2);
             float x, y;
             if (!AbsValueFromIoctl(this->file_desc_, code_x, x)) { x = 0.0F; }
             if (!AbsValueFromIoctl(this->file_desc_, code_y, y)) { y = 0.0F; } else { y = -y; } // negate Y
+            this->ProcessThumbstick(index, x, y);
 
             const size_t tx = static_cast<size_t>(index) * 2;
             float &dest_x = this->thumbstick_values_[tx];
@@ -2128,26 +3540,20 @@ namespace crossput
             {
                 dest_x = x;
                 dest_y = y;
-
-                #ifdef CROSSPUT_FEATURE_CALLBACK
-                ThumbstickChanged(index, x, y);
-                #endif // CROSSPUT_FEATURE_CALLBACK
+                ThumbstickChanged(index, x, y, timestamp);
             }
         };
 
         const auto query_trigger = [this, &handle_digital_button, timestamp](const int code, const Button b)
         {
             input_absinfo info;
+            CROSSPUT_STATS_ADD(syscalls, 1);
             if (ioctl(this->file_desc_, EVIOCGABS(code), &info) >= 0)
             {
                 // analog available
-                const float value = NormalizeAbsValue(info);
-                #ifdef CROSSPUT_FEATURE_CALLBACK
+                const float value = this->ProcessButton(b, NormalizeAbsValue(info));
                 bool state;
-                if (this->button_data_[static_cast<int>(b)].Modify(value, timestamp, state)) { ButtonChanged(b, value, state); }
-                #else
-                this->button_data_[static_cast<int>(b)].Modify(value, timestamp);
-                #endif // CROSSPUT_FEATURE_CALLBACK
+                if (this->button_data_.Modify(static_cast<int>(b), value, timestamp, state)) { ButtonChanged(b, value, state, timestamp); }
             }
             else
             {
@@ -2159,6 +3565,7 @@ namespace crossput
         const auto query_dpad = [this, &handle_digital_button, timestamp](const int code, const Button b1, const Button b2)
         {
             input_absinfo info;
+            CROSSPUT_STATS_ADD(syscalls, 1);
             if (ioctl(this->file_desc_, EVIOCGABS(code), &info) >= 0)
             {
                 // analog available
@@ -2198,11 +3605,11 @@ namespace crossput
     }
 
 
-    void LinuxGamepad::OnConnected()
+    void LinuxGamepad::OnConnected(LinuxDeviceMetadata &metadata)
     {
-        const auto handle_abs_val_button = [this](const int code, AbsValNorm &norm_dest, std::initializer_list<Button> &&buttons)
+        const auto handle_abs_val_button = [this, &metadata](const int code, AbsValNorm &norm_dest, std::initializer_list<Button> &&buttons)
         {
-            if (AbsValueNormFromIoctl(this->file_desc_, code, norm_dest))
+            if (metadata.GetAbsValNorm(this->file_desc_, code, norm_dest))
             {
                 for (const Button b : buttons) { this->button_to_normalizer_[static_cast<int>(b)] = &norm_dest; }
             }
@@ -2219,7 +3626,7 @@ namespace crossput
         handle_abs_val_button(ABS_HAT2X, trigger_norms_[3], { Button::R2 });
 
         // thumbsticks
-        #define CREATE_THUMBSTICK_HANDLER(code, norm_dest) if (!AbsValueNormFromIoctl(file_desc_, code, norm_dest)) { norm_dest = {}; }
+        #define CREATE_THUMBSTICK_HANDLER(code, norm_dest) if (!metadata.GetAbsValNorm(file_desc_, code, norm_dest)) { norm_dest = {}; }
         CREATE_THUMBSTICK_HANDLER(ABS_X, thumbstick_norms_[0])
         CREATE_THUMBSTICK_HANDLER(ABS_Y, thumbstick_norms_[1])
         CREATE_THUMBSTICK_HANDLER(ABS_RX, thumbstick_norms_[2])
@@ -2230,11 +3637,12 @@ namespace crossput
 
     void LinuxGamepad::OnDisconnected()
     {
-        std::memset(button_data_, 0, sizeof(button_data_));
+        button_data_.Reset();
         std::memset(thumbstick_norms_, 0 , sizeof(thumbstick_norms_));
         std::memset(trigger_norms_, 0, sizeof(trigger_norms_));
         std::memset(thumbstick_values_, 0, sizeof(thumbstick_values_));
         std::memset(button_to_normalizer_, 0, sizeof(button_to_normalizer_));
+        ResetRawThumbsticks();
         dpad_norm_ = {};
     }
 
@@ -2243,27 +3651,27 @@ namespace crossput
     {
         if (IsValidButton(button))
         {
-            button_data_[static_cast<int>(button)].SetThreshold(std::clamp(threshold, 0.0F, 1.0F));
+            button_data_.SetThreshold(static_cast<int>(button), std::clamp(threshold, 0.0F, 1.0F));
         }
     }
 
     constexpr void LinuxGamepad::SetGlobalThreshold(float threshold)
     {
         threshold = std::clamp(threshold, 0.0F, 1.0F);
-        for (unsigned int i = 0; i < NUM_BUTTON_CODES; i++) { button_data_[i].SetThreshold(threshold); }
+        for (unsigned int i = 0; i < NUM_BUTTON_CODES; i++) { button_data_.SetThreshold(i, threshold); }
     }
 
     constexpr float LinuxGamepad::GetButtonThreshold(const Button button) const
     {
         return IsValidButton(button)
-            ? button_data_[static_cast<int>(button)].Threshold()
+            ? button_data_.Threshold(static_cast<int>(button))
             : 0.0F;
     }
 
     constexpr float LinuxGamepad::GetButtonValue(const Button button) const
     {
         return (is_connected_ && IsValidButton(button))
-            ? button_data_[static_cast<int>(button)].Value()
+            ? button_data_.Value(static_cast<int>(button))
             : 0.0F;
     }
 
@@ -2271,9 +3679,8 @@ namespace crossput
     {
         if (is_connected_ && IsValidButton(button))
         {
-            const TSTV &d = button_data_[static_cast<int>(button)];
-            time = TimestampDeltaSeconds(d.Timestamp(), last_update_timestamp_);
-            return d.State();
+            time = TimestampDeltaSeconds(button_data_.Timestamp(static_cast<int>(button)), last_update_timestamp_);
+            return button_data_.State(static_cast<int>(button));
         }
         else
         {
@@ -2282,6 +3689,21 @@ namespace crossput
         }
     }
 
+    void LinuxGamepad::GetButtonStates(uint64_t *const states) const
+    {
+        button_data_.CopyStates(states, NUM_BUTTON_STATE_WORDS, is_connected_);
+    }
+
+    void LinuxGamepad::GetButtonValues(float *const values) const
+    {
+        button_data_.CopyValues(values, NUM_BUTTON_CODES, is_connected_);
+    }
+
+    void LinuxGamepad::GetButtonTimestamps(uint64_t *const timestamps) const
+    {
+        button_data_.CopyTimestamps(timestamps, NUM_BUTTON_CODES, is_connected_);
+    }
+
     constexpr uint32_t LinuxGamepad::GetThumbstickCount() const
     {
         return is_connected_ ? LinuxGamepad::NUM_THUMBSTICKS : 0;
@@ -2301,6 +3723,13 @@ namespace crossput
         y = thumbstick_values_[tx + 1];
     }
 
+    uint32_t LinuxGamepad::GetThumbsticks(float *const xy, const uint32_t max_count) const
+    {
+        const uint32_t n = std::min(max_count, LinuxGamepad::GetThumbstickCount());
+        std::memcpy(xy, thumbstick_values_, static_cast<size_t>(n) * 2 * sizeof(float));
+        return n;
+    }
+
 
     #ifdef CROSSPUT_FEATURE_FORCE
     void LinuxForce::SetActive(const bool active)
@@ -2328,9 +3757,14 @@ namespace crossput
     {
         if (!IsOrphaned() && params_.type == type_)
         {
+            if (!IsDirty()) { return true; } // hardware already holds these parameters
+
             ff_effect effect = TranslateForceParams(params_);
             effect.id = effect_id_;
-            return ioctl(p_device_->file_desc_, EVIOCSFF, &effect) >= 0;
+            if (ioctl(p_device_->file_desc_, EVIOCSFF, &effect) < 0) { return false; }
+
+            MarkWritten();
+            return true;
         }
 
         return false;
@@ -0,0 +1,206 @@
+/*================================================================================= *
+*                                   +----------+                                    *
+*                                   | crossput |                                    *
+*                                   +----------+                                    *
+*                            Copyright 2024 Trice Helix                             *
+*                                                                                   *
+* This file is part of crossput and is distributed under the BSD-3-Clause License.  *
+* Please refer to LICENSE.txt for additional information.                           *
+* =================================================================================*/
+
+#include "common.hpp"
+
+
+namespace crossput
+{
+    // MEMORY RESOURCE
+
+    void *DefaultAllocate(const size_t size, const size_t alignment, void *const)
+    {
+        return ::operator new(size, static_cast<std::align_val_t>(alignment), std::nothrow);
+    }
+
+
+    void DefaultDeallocate(void *const p_memory, const size_t size, const size_t alignment, void *const)
+    {
+        ::operator delete(p_memory, size, static_cast<std::align_val_t>(alignment));
+    }
+
+
+    // constant-initialized, so global containers can allocate from it during dynamic initialization
+    constinit MemoryResource glob_default_memory({.allocate = &DefaultAllocate, .deallocate = &DefaultDeallocate, .p_user = nullptr}, false);
+    constinit MemoryResource *glob_p_memory = &glob_default_memory;
+
+
+    inline constexpr size_t AlignUp(const size_t value, const size_t alignment) noexcept
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+
+    void *MemoryResource::Allocate(const size_t size, const size_t alignment)
+    {
+        void *const p = allocator_.allocate(size, alignment, allocator_.p_user);
+        if (p == nullptr) [[unlikely]] { throw std::bad_alloc(); }
+
+        allocated_bytes_ += size;
+        live_count_++;
+        return p;
+    }
+
+
+    void MemoryResource::Deallocate(void *const p, const size_t size, const size_t alignment) noexcept
+    {
+        if (p == nullptr) { return; }
+
+        allocator_.deallocate(p, size, alignment, allocator_.p_user);
+        allocated_bytes_ -= size;
+        live_count_--;
+    }
+
+
+    void *MemoryResource::AllocateObject(const size_t size, const size_t alignment)
+    {
+        Pool *const p_pool = FindPool(size, alignment);
+        if (p_pool == nullptr) { return Allocate(size, alignment); }
+
+        if (p_pool->p_free == nullptr)
+        {
+            // allocate another chunk and link all of its objects, in order of their addresses
+            const size_t chunk_size = p_pool->chunk_header_size + p_pool->stride * POOL_CHUNK_CAPACITY;
+            char *const p_chunk = static_cast<char *>(Allocate(chunk_size, p_pool->alignment));
+            *reinterpret_cast<void **>(p_chunk) = p_pool->p_chunks;
+            p_pool->p_chunks = p_chunk;
+            LinkChunk(*p_pool, p_chunk);
+        }
+
+        void *const p = p_pool->p_free;
+        p_pool->p_free = *static_cast<void **>(p);
+        p_pool->live_count++;
+        return p;
+    }
+
+
+    void MemoryResource::DeallocateObject(void *const p, const size_t size, const size_t alignment) noexcept
+    {
+        if (p == nullptr) { return; }
+
+        // pools are never removed, so an object is returned to the pool it was taken from
+        Pool *const p_pool = FindPool(size, alignment);
+        if (p_pool == nullptr) { Deallocate(p, size, alignment); return; }
+
+        *static_cast<void **>(p) = p_pool->p_free;
+        p_pool->p_free = p;
+        if (--p_pool->live_count == 0) { TrimPool(*p_pool); }
+    }
+
+
+    void MemoryResource::ReleaseIdlePools() noexcept
+    {
+        for (size_t i = 0; i < pool_count_; i++)
+        {
+            if (pools_[i].live_count == 0) { ReleasePool(pools_[i]); }
+        }
+    }
+
+
+    MemoryResource::Pool *MemoryResource::FindPool(const size_t size, const size_t alignment) noexcept
+    {
+        if (!use_pools_) { return nullptr; }
+
+        for (size_t i = 0; i < pool_count_; i++)
+        {
+            if (pools_[i].size == size && pools_[i].alignment == std::max(alignment, alignof(void *))) { return &pools_[i]; }
+        }
+
+        if (pool_count_ == MAX_POOLS) { return nullptr; }
+
+        // objects hold the link of the free list while unused
+        Pool &pool = pools_[pool_count_++];
+        pool.size = size;
+        pool.alignment = std::max(alignment, alignof(void *));
+        pool.stride = AlignUp(std::max(size, sizeof(void *)), pool.alignment);
+        pool.chunk_header_size = AlignUp(sizeof(void *), pool.alignment);
+        pool.p_free = nullptr;
+        pool.p_chunks = nullptr;
+        pool.live_count = 0;
+        return &pool;
+    }
+
+
+    // link all objects of a chunk as the free list, in order of their addresses
+    void MemoryResource::LinkChunk(Pool &pool, char *const p_chunk) noexcept
+    {
+        char *const p_objects = p_chunk + pool.chunk_header_size;
+        for (size_t i = 0; i < POOL_CHUNK_CAPACITY; i++)
+        {
+            *reinterpret_cast<void **>(p_objects + i * pool.stride) = (i + 1 < POOL_CHUNK_CAPACITY) ? p_objects + (i + 1) * pool.stride : nullptr;
+        }
+        pool.p_free = p_objects;
+    }
+
+
+    // keeps the most recent chunk of a pool without live objects,
+    // so repeatedly creating and destroying a single object (e.g. hot-plugging a gamepad) does not allocate
+    void MemoryResource::TrimPool(Pool &pool) noexcept
+    {
+        char *const p_kept = static_cast<char *>(pool.p_chunks);
+        pool.p_chunks = *reinterpret_cast<void **>(p_kept);
+        ReleasePool(pool);
+
+        *reinterpret_cast<void **>(p_kept) = nullptr;
+        pool.p_chunks = p_kept;
+        LinkChunk(pool, p_kept);
+    }
+
+
+    void MemoryResource::ReleasePool(Pool &pool) noexcept
+    {
+        const size_t chunk_size = pool.chunk_header_size + pool.stride * POOL_CHUNK_CAPACITY;
+        while (pool.p_chunks != nullptr)
+        {
+            void *const p_next = *static_cast<void **>(pool.p_chunks);
+            Deallocate(pool.p_chunks, chunk_size, pool.alignment);
+            pool.p_chunks = p_next;
+        }
+
+        pool.p_free = nullptr;
+    }
+
+
+    // GLOBAL MEMORY API
+
+    void SetAllocator(const Allocator &allocator, const bool use_pools)
+    {
+        ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+        bool has_objects = glob_devices.Size() != 0 || !glob_action_maps.empty();
+        #ifdef CROSSPUT_FEATURE_CALLBACK
+        has_objects |= !glob_callbacks.empty();
+        #endif // CROSSPUT_FEATURE_CALLBACK
+        if (has_objects) { throw std::runtime_error(std::format("{}: devices, callbacks, or action maps exist", CROSSPUT_FUNCTION_STR)); }
+
+        MemoryResource *const p_prev = glob_p_memory;
+        glob_p_memory = (allocator.allocate != nullptr && allocator.deallocate != nullptr)
+            ? new MemoryResource(allocator, use_pools)
+            : new MemoryResource({.allocate = &DefaultAllocate, .deallocate = &DefaultDeallocate, .p_user = nullptr}, use_pools);
+
+        // the global maps are empty, replacing them returns their buckets to the previous resource and binds them to the new one
+        #ifdef CROSSPUT_FEATURE_CALLBACK
+        glob_callbacks = decltype(glob_callbacks)();
+        #endif // CROSSPUT_FEATURE_CALLBACK
+        #ifdef CROSSPUT_FEATURE_AGGREGATE
+        glob_dev_to_aggr = decltype(glob_dev_to_aggr)();
+        #endif // CROSSPUT_FEATURE_AGGREGATE
+
+        p_prev->ReleaseIdlePools();
+        assert(p_prev->GetLiveCount() == 0);
+        if (p_prev != &glob_default_memory) { delete p_prev; }
+    }
+
+
+    size_t GetAllocatedBytes()
+    {
+        return glob_p_memory->GetAllocatedBytes();
+    }
+}
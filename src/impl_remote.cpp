@@ -0,0 +1,684 @@
+/*================================================================================= *
+*                                   +----------+                                    *
+*                                   | crossput |                                    *
+*                                   +----------+                                    *
+*                            Copyright 2024 Trice Helix                             *
+*                                                                                   *
+* This file is part of crossput and is distributed under the BSD-3-Clause License.  *
+* Please refer to LICENSE.txt for additional information.                           *
+* =================================================================================*/
+
+#include "common.hpp"
+
+#include <cmath>
+#include <cstring>
+
+
+namespace crossput
+{
+    // PACKET ENCODING
+
+    // packets consist of a version, the DeviceType and flags, followed by a type-specific body which is omitted while disconnected:
+    // - buttons/keys which changed: varint count, then per entry varint index, u16 value (bit 15 holds the state, bits 0-14 the quantized value)
+    //   and varint age of the timestamp in microseconds plus one (0 -> never changed)
+    // - mouse only: position, delta, scroll and scroll delta (X and Y) as zigzag varints
+    // - gamepad only: u8 thumbstick count, then per thumbstick X and Y as quantized i16
+    constexpr uint8_t REMOTE_PACKET_VERSION = 1;
+    constexpr uint8_t REMOTE_FLAG_CONNECTED = 1;
+    constexpr size_t MAX_REMOTE_ENTRIES = std::max(std::max(NUM_KEY_CODES, NUM_BUTTON_CODES), MAX_TRACKED_MOUSE_BUTTONS);
+    constexpr size_t MAX_REMOTE_WORDS = (MAX_REMOTE_ENTRIES + 63) / 64;
+
+    constexpr float QUANTIZED_VALUE_SCALE = 32767.0F;
+    constexpr uint16_t QUANTIZED_STATE_BIT = 0x8000;
+
+
+    class PacketWriter
+    {
+    private:
+        std::vector<uint8_t> &packet_;
+
+    public:
+        PacketWriter(std::vector<uint8_t> &packet) : packet_(packet) {}
+
+        inline void U8(const uint8_t v) { packet_.push_back(v); }
+
+        inline void U16(const uint16_t v)
+        {
+            packet_.push_back(static_cast<uint8_t>(v));
+            packet_.push_back(static_cast<uint8_t>(v >> 8));
+        }
+
+        inline void Varint(uint64_t v)
+        {
+            while (v >= 0x80)
+            {
+                packet_.push_back(static_cast<uint8_t>(v | 0x80));
+                v >>= 7;
+            }
+            packet_.push_back(static_cast<uint8_t>(v));
+        }
+
+        inline void Zigzag(const int64_t v) { Varint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63)); }
+
+        inline void Value(const float value, const bool state)
+        {
+            U16(static_cast<uint16_t>(std::lround(std::clamp(value, 0.0F, 1.0F) * QUANTIZED_VALUE_SCALE)) | (state ? QUANTIZED_STATE_BIT : 0));
+        }
+
+        inline void Axis(const float value)
+        {
+            U16(static_cast<uint16_t>(static_cast<int16_t>(std::lround(std::clamp(value, -1.0F, 1.0F) * QUANTIZED_VALUE_SCALE))));
+        }
+    };
+
+
+    // every read past the end fails the whole packet
+    class PacketReader
+    {
+    private:
+        const uint8_t *const p_begin_;
+        const uint8_t *p_;
+        const uint8_t *const p_end_;
+        bool ok_ = true;
+
+    public:
+        PacketReader(const uint8_t *const data, const size_t size) : p_begin_(data), p_(data), p_end_(data + size) {}
+
+        constexpr bool Ok() const noexcept { return ok_; }
+        constexpr size_t Consumed() const noexcept { return static_cast<size_t>(p_ - p_begin_); }
+
+        inline uint8_t U8() noexcept
+        {
+            if (p_ == p_end_) { ok_ = false; return 0; }
+            return *(p_++);
+        }
+
+        inline uint16_t U16() noexcept
+        {
+            const uint8_t lo = U8();
+            return static_cast<uint16_t>(lo | (U8() << 8));
+        }
+
+        inline uint64_t Varint() noexcept
+        {
+            uint64_t v = 0;
+            for (unsigned int shift = 0; shift < 64; shift += 7)
+            {
+                const uint8_t b = U8();
+                v |= static_cast<uint64_t>(b & 0x7F) << shift;
+                if ((b & 0x80) == 0) { return v; }
+            }
+            ok_ = false; // overlong
+            return 0;
+        }
+
+        inline int64_t Zigzag() noexcept
+        {
+            const uint64_t v = Varint();
+            return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+        }
+
+        inline float Axis() noexcept { return static_cast<float>(static_cast<int16_t>(U16())) / QUANTIZED_VALUE_SCALE; }
+    };
+
+
+    struct RemotePacket
+    {
+        struct Entry
+        {
+            uint32_t index;
+            float value;
+            bool state;
+            uint64_t age; // see packet encoding
+        };
+
+        DeviceType type;
+        bool is_connected;
+        uint32_t num_entries;
+        Entry entries[MAX_REMOTE_ENTRIES];
+        int64_t mouse[8];  // position, delta, scroll, scroll delta
+        uint32_t thumbstick_count;
+        float thumbsticks[DeviceSnapshot::MAX_THUMBSTICKS][2];
+    };
+
+
+    constexpr size_t MaxRemoteEntries(const DeviceType type) noexcept
+    {
+        switch (type)
+        {
+        case DeviceType::MOUSE: return MAX_TRACKED_MOUSE_BUTTONS;
+        case DeviceType::KEYBOARD: return NUM_KEY_CODES;
+        case DeviceType::GAMEPAD: return NUM_BUTTON_CODES;
+        default: return 0;
+        }
+    }
+
+
+    template <size_t N>
+    void WriteChangedEntries(PacketWriter &writer, const uint64_t *const changed, const float *const values, const uint64_t *const timestamps, const uint64_t *const states, const timestamp_t now)
+    {
+        constexpr size_t NUM_WORDS = (N + 63) / 64;
+
+        uint32_t count = 0;
+        for (size_t w = 0; w < NUM_WORDS; w++) { count += static_cast<uint32_t>(std::popcount(changed[w])); }
+        writer.Varint(count);
+
+        for (size_t w = 0; w < NUM_WORDS; w++)
+        {
+            for (uint64_t bits = changed[w]; bits != 0; bits &= bits - 1)
+            {
+                const size_t i = w * 64 + static_cast<size_t>(std::countr_zero(bits));
+                writer.Varint(i);
+                writer.Value(values[i], (states[w] >> (i % 64)) & 1);
+                writer.Varint(timestamps[i] != 0 ? (now - std::min(timestamps[i], now)) + 1 : 0);
+            }
+        }
+    }
+
+
+    bool ParseRemotePacket(PacketReader &reader, RemotePacket &packet) noexcept
+    {
+        if (reader.U8() != REMOTE_PACKET_VERSION) { return false; }
+        packet.type = static_cast<DeviceType>(reader.U8());
+        packet.is_connected = (reader.U8() & REMOTE_FLAG_CONNECTED) != 0;
+
+        const size_t max_entries = MaxRemoteEntries(packet.type);
+        if (max_entries == 0) { return false; }
+        if (!packet.is_connected) { return reader.Ok(); }
+
+        const uint64_t num_entries = reader.Varint();
+        if (num_entries > max_entries) { return false; }
+        packet.num_entries = static_cast<uint32_t>(num_entries);
+
+        for (uint32_t i = 0; i < packet.num_entries; i++)
+        {
+            RemotePacket::Entry &entry = packet.entries[i];
+            const uint64_t index = reader.Varint();
+            if (index >= max_entries) { return false; }
+
+            const uint16_t value = reader.U16();
+            entry.index = static_cast<uint32_t>(index);
+            entry.value = static_cast<float>(value & ~QUANTIZED_STATE_BIT) / QUANTIZED_VALUE_SCALE;
+            entry.state = (value & QUANTIZED_STATE_BIT) != 0;
+            entry.age = reader.Varint();
+        }
+
+        if (packet.type == DeviceType::MOUSE)
+        {
+            for (int64_t &v : packet.mouse) { v = reader.Zigzag(); }
+        }
+        else if (packet.type == DeviceType::GAMEPAD)
+        {
+            packet.thumbstick_count = reader.U8();
+            if (packet.thumbstick_count > DeviceSnapshot::MAX_THUMBSTICKS) { return false; }
+            for (uint32_t i = 0; i < packet.thumbstick_count; i++)
+            {
+                packet.thumbsticks[i][0] = reader.Axis();
+                packet.thumbsticks[i][1] = reader.Axis();
+            }
+        }
+
+        return reader.Ok();
+    }
+
+
+    // REMOTE DEVICE
+
+    // implements:
+    // IDevice::GetDisplayName()
+    // IDevice::Update()
+    // and applies packets created by SerializeDeviceState()
+    class RemoteDevice :
+        public virtual BaseInterface,
+        public virtual DeviceCallbackManager,
+        public virtual DeviceForceManagerEmpty
+    {
+    protected:
+        const std::string display_name_;
+        timestamp_t last_apply_timestamp_ = 0;
+
+    public:
+        RemoteDevice(const std::string &display_name) : display_name_(display_name) {}
+
+        #ifdef CROSSPUT_FEATURE_AGGREGATE
+        constexpr bool IsAggregate() const noexcept override final { return false; }
+        #endif // CROSSPUT_FEATURE_AGGREGATE
+
+        std::string GetDisplayName() const override { return display_name_; }
+
+        void Update() override final
+        {
+            // input only changes via ApplyDeviceState()
+            ProtectManagementAPI("crossput::IDevice::Update()", id_);
+            CROSSPUT_STATS_TIME_UPDATE();
+            MarkServiced();
+        }
+
+        void Apply(const RemotePacket &packet)
+        {
+            last_apply_timestamp_ = NowTimestamp();
+            SetConnected(packet.is_connected);
+            if (!is_connected_) { return; }
+
+            CROSSPUT_STATS_ADD(event_groups, 1);
+            ApplyBody(packet, last_apply_timestamp_);
+        }
+
+    protected:
+        virtual void ApplyBody(const RemotePacket &packet, const timestamp_t now) = 0;
+        virtual void OnDisconnected() = 0;
+
+        static constexpr timestamp_t EntryTimestamp(const RemotePacket::Entry &entry, const timestamp_t now) noexcept
+        {
+            return entry.age != 0 ? now - std::min(entry.age - 1, now) : 0;
+        }
+
+    private:
+        void SetConnected(const bool connected)
+        {
+            if (connected == is_connected_) { return; }
+
+            is_connected_ = connected;
+            if (!connected) { OnDisconnected(); }
+            DeviceStatusChanged(this, connected ? DeviceStatusChange::CONNECTED : DeviceStatusChange::DISCONNECTED);
+        }
+    };
+
+
+    class RemoteMouse final :
+        public virtual IMouse,
+        public virtual RemoteDevice,
+        public virtual TypedInterface<DeviceType::MOUSE>,
+        public virtual MouseCallbackManager
+    {
+    private:
+        MouseData data_ = {};
+        StateArray<MAX_TRACKED_MOUSE_BUTTONS> button_data_ = {};
+        uint32_t button_count_ = 0; // highest button index received plus one
+
+    public:
+        RemoteMouse(const std::string &display_name) : RemoteDevice(display_name) {}
+
+        void GetPosition(int64_t &x, int64_t &y) const override
+        {
+            if (!is_connected_) { return; }
+            x = data_.x;
+            y = data_.y;
+        }
+
+        void GetDelta(int64_t &x, int64_t &y) const override
+        {
+            if (!is_connected_) { return; }
+            x = data_.dx;
+            y = data_.dy;
+        }
+
+        void GetScroll(int64_t &x, int64_t &y) const override
+        {
+            if (!is_connected_) { return; }
+            x = data_.sx;
+            y = data_.sy;
+        }
+
+        void GetScrollDelta(int64_t &x, int64_t &y) const override
+        {
+            if (!is_connected_) { return; }
+            x = data_.sdx;
+            y = data_.sdy;
+        }
+
+        uint32_t GetButtonCount() const override { return is_connected_ ? button_count_ : 0; }
+
+        // thresholds are owned by the sender
+        void SetButtonThreshold(const uint32_t, float) override {}
+        void SetGlobalThreshold(float) override {}
+        float GetButtonThreshold(const uint32_t) const override { return 0.0F; }
+
+        float GetButtonValue(const uint32_t index) const override
+        {
+            return (is_connected_ && index < button_count_) ? button_data_.Value(index) : 0.0F;
+        }
+
+        bool GetButtonState(const uint32_t index, float &time) const override
+        {
+            if (is_connected_ && index < button_count_)
+            {
+                time = TimestampDeltaSeconds(button_data_.Timestamp(index), last_apply_timestamp_);
+                return button_data_.State(index);
+            }
+            else
+            {
+                time = std::numeric_limits<float>::infinity();
+                return false;
+            }
+        }
+
+        StateView GetButtonView() const override { return button_data_.View(is_connected_); }
+        void GetButtonStates(uint64_t *const states, const size_t num_words) const override
+        {
+            button_data_.CopyStates(states, num_words, is_connected_);
+        }
+
+        uint32_t GetButtonValues(float *const values, const uint32_t max_count) const override
+        {
+            const uint32_t n = std::min(max_count, RemoteMouse::GetButtonCount());
+            button_data_.CopyValues(values, n, is_connected_);
+            return n;
+        }
+
+        uint32_t GetButtonTimestamps(uint64_t *const timestamps, const uint32_t max_count) const override
+        {
+            const uint32_t n = std::min(max_count, RemoteMouse::GetButtonCount());
+            button_data_.CopyTimestamps(timestamps, n, is_connected_);
+            return n;
+        }
+
+    private:
+        void ApplyBody(const RemotePacket &packet, const timestamp_t now) override
+        {
+            data_ = {
+                .x = packet.mouse[0], .y = packet.mouse[1], .dx = packet.mouse[2], .dy = packet.mouse[3],
+                .sx = packet.mouse[4], .sy = packet.mouse[5], .sdx = packet.mouse[6], .sdy = packet.mouse[7]
+            };
+            if (data_.dx != 0 || data_.dy != 0) { MouseMoved(data_.x, data_.y, data_.dx, data_.dy, now); }
+            if (data_.sdx != 0 || data_.sdy != 0) { MouseScrolled(data_.sx, data_.sy, data_.sdx, data_.sdy, now); }
+
+            for (uint32_t i = 0; i < packet.num_entries; i++)
+            {
+                const RemotePacket::Entry &entry = packet.entries[i];
+                button_count_ = std::max(button_count_, entry.index + 1);
+
+                const timestamp_t ts = EntryTimestamp(entry, now);
+                if (button_data_.Assign(entry.index, entry.value, ts, entry.state)) { ButtonChanged(entry.index, entry.value, entry.state, ts); }
+            }
+        }
+
+        void OnDisconnected() override
+        {
+            data_ = {};
+            button_data_.Reset();
+        }
+    };
+
+
+    class RemoteKeyboard final :
+        public virtual IKeyboard,
+        public virtual RemoteDevice,
+        public virtual TypedInterface<DeviceType::KEYBOARD>,
+        public virtual KeyboardCallbackManager
+    {
+    private:
+        StateArray<NUM_KEY_CODES> key_data_ = {};
+        uint32_t num_keys_pressed_ = 0;
+
+    public:
+        RemoteKeyboard(const std::string &display_name) : RemoteDevice(display_name) {}
+
+        uint32_t GetNumKeysPressed() const override { return is_connected_ ? num_keys_pressed_ : 0; }
+
+        // thresholds are owned by the sender
+        void SetKeyThreshold(const Key, float) override {}
+        void SetGlobalThreshold(float) override {}
+        float GetKeyThreshold(const Key) const override { return 0.0F; }
+
+        float GetKeyValue(const Key key) const override
+        {
+            return (is_connected_ && IsValidKey(key)) ? key_data_.Value(static_cast<int>(key)) : 0.0F;
+        }
+
+        bool GetKeyState(const Key key, float &time) const override
+        {
+            if (is_connected_ && IsValidKey(key))
+            {
+                time = TimestampDeltaSeconds(key_data_.Timestamp(static_cast<int>(key)), last_apply_timestamp_);
+                return key_data_.State(static_cast<int>(key));
+            }
+            else
+            {
+                time = std::numeric_limits<float>::infinity();
+                return false;
+            }
+        }
+
+        StateView GetKeyView() const override { return key_data_.View(is_connected_); }
+        void GetKeyStates(uint64_t *const states) const override { key_data_.CopyStates(states, NUM_KEY_STATE_WORDS, is_connected_); }
+        void GetKeyValues(float *const values) const override { key_data_.CopyValues(values, NUM_KEY_CODES, is_connected_); }
+        void GetKeyTimestamps(uint64_t *const timestamps) const override { key_data_.CopyTimestamps(timestamps, NUM_KEY_CODES, is_connected_); }
+
+    private:
+        void ApplyBody(const RemotePacket &packet, const timestamp_t now) override
+        {
+            for (uint32_t i = 0; i < packet.num_entries; i++)
+            {
+                const RemotePacket::Entry &entry = packet.entries[i];
+                const bool old_state = key_data_.State(entry.index);
+
+                const timestamp_t ts = EntryTimestamp(entry, now);
+                if (!key_data_.Assign(entry.index, entry.value, ts, entry.state)) { continue; }
+
+                if (entry.state != old_state) { entry.state ? num_keys_pressed_++ : num_keys_pressed_--; }
+                KeyChanged(static_cast<Key>(entry.index), entry.value, entry.state, ts);
+            }
+        }
+
+        void OnDisconnected() override
+        {
+            key_data_.Reset();
+            num_keys_pressed_ = 0;
+        }
+    };
+
+
+    class RemoteGamepad final :
+        public virtual IGamepad,
+        public virtual RemoteDevice,
+        public virtual TypedInterface<DeviceType::GAMEPAD>,
+        public virtual GamepadCallbackManager,
+        public virtual GamepadProfileManagerEmpty
+    {
+    private:
+        StateArray<NUM_BUTTON_CODES> button_data_ = {};
+        std::pair<float, float> thumbstick_values_[DeviceSnapshot::MAX_THUMBSTICKS] = {};
+        uint32_t thumbstick_count_ = 0;
+
+    public:
+        RemoteGamepad(const std::string &display_name) : RemoteDevice(display_name) {}
+
+        // thresholds are owned by the sender
+        void SetButtonThreshold(const Button, float) override {}
+        void SetGlobalThreshold(float) override {}
+        float GetButtonThreshold(const Button) const override { return 0.0F; }
+
+        float GetButtonValue(const Button button) const override
+        {
+            return (is_connected_ && IsValidButton(button)) ? button_data_.Value(static_cast<int>(button)) : 0.0F;
+        }
+
+        bool GetButtonState(const Button button, float &time) const override
+        {
+            if (is_connected_ && IsValidButton(button))
+            {
+                time = TimestampDeltaSeconds(button_data_.Timestamp(static_cast<int>(button)), last_apply_timestamp_);
+                return button_data_.State(static_cast<int>(button));
+            }
+            else
+            {
+                time = std::numeric_limits<float>::infinity();
+                return false;
+            }
+        }
+
+        StateView GetButtonView() const override { return button_data_.View(is_connected_); }
+        void GetButtonStates(uint64_t *const states) const override { button_data_.CopyStates(states, NUM_BUTTON_STATE_WORDS, is_connected_); }
+        void GetButtonValues(float *const values) const override { button_data_.CopyValues(values, NUM_BUTTON_CODES, is_connected_); }
+        void GetButtonTimestamps(uint64_t *const timestamps) const override { button_data_.CopyTimestamps(timestamps, NUM_BUTTON_CODES, is_connected_); }
+
+        uint32_t GetThumbstickCount() const override { return is_connected_ ? thumbstick_count_ : 0; }
+
+        void GetThumbstick(const uint32_t index, float &x, float &y) const override
+        {
+            std::tie(x, y) = (is_connected_ && index < thumbstick_count_)
+                ? thumbstick_values_[index]
+                : std::make_pair(0.0F, 0.0F);
+        }
+
+        uint32_t GetThumbsticks(float *const xy, const uint32_t max_count) const override
+        {
+            const uint32_t n = std::min(max_count, RemoteGamepad::GetThumbstickCount());
+            for (uint32_t i = 0; i < n; i++)
+            {
+                xy[i * 2] = thumbstick_values_[i].first;
+                xy[i * 2 + 1] = thumbstick_values_[i].second;
+            }
+            return n;
+        }
+
+    private:
+        void ApplyBody(const RemotePacket &packet, const timestamp_t now) override
+        {
+            for (uint32_t i = 0; i < packet.num_entries; i++)
+            {
+                const RemotePacket::Entry &entry = packet.entries[i];
+                const timestamp_t ts = EntryTimestamp(entry, now);
+                if (button_data_.Assign(entry.index, entry.value, ts, entry.state)) { ButtonChanged(static_cast<Button>(entry.index), entry.value, entry.state, ts); }
+            }
+
+            thumbstick_count_ = packet.thumbstick_count;
+            for (uint32_t i = 0; i < thumbstick_count_; i++)
+            {
+                const std::pair<float, float> xy = {packet.thumbsticks[i][0], packet.thumbsticks[i][1]};
+                if (xy == thumbstick_values_[i]) { continue; }
+
+                thumbstick_values_[i] = xy;
+                ThumbstickChanged(i, xy.first, xy.second, now);
+            }
+        }
+
+        void OnDisconnected() override
+        {
+            button_data_.Reset();
+            std::fill(std::begin(thumbstick_values_), std::end(thumbstick_values_), std::make_pair(0.0F, 0.0F));
+            thumbstick_count_ = 0;
+        }
+    };
+
+
+    // GLOBAL REMOTE API
+
+    bool SerializeDeviceState(const ID device_id, const uint64_t since_generation, std::vector<uint8_t> &packet, uint64_t &generation)
+    {
+        const BaseInterface *const p_interface = glob_devices.Find(device_id);
+        if (p_interface == nullptr) { return false; }
+
+        const DeviceType type = p_interface->GetType();
+        if (MaxRemoteEntries(type) == 0) { return false; }
+
+        generation = glob_generation;
+
+        PacketWriter writer(packet);
+        writer.U8(REMOTE_PACKET_VERSION);
+        writer.U8(static_cast<uint8_t>(type));
+        writer.U8(p_interface->IsConnected() ? REMOTE_FLAG_CONNECTED : 0);
+        if (!p_interface->IsConnected()) { return true; }
+
+        // bulk getters avoid reading every single button/key via virtual calls
+        const timestamp_t now = NowTimestamp();
+        uint64_t changed[MAX_REMOTE_WORDS];
+        uint64_t states[MAX_REMOTE_WORDS];
+        float values[MAX_REMOTE_ENTRIES];
+        uint64_t timestamps[MAX_REMOTE_ENTRIES];
+
+        switch (type)
+        {
+        case DeviceType::MOUSE:
+            {
+                constexpr size_t NUM_WORDS = (MAX_TRACKED_MOUSE_BUTTONS + 63) / 64;
+                const IMouse *const p_mouse = dynamic_cast<const IMouse *>(p_interface);
+                p_mouse->GetChangedButtons(since_generation, changed, NUM_WORDS);
+                p_mouse->GetButtonStates(states, NUM_WORDS);
+                const uint32_t n = p_mouse->GetButtonValues(values, static_cast<uint32_t>(MAX_TRACKED_MOUSE_BUTTONS));
+                p_mouse->GetButtonTimestamps(timestamps, n);
+
+                // buttons which have disappeared since are not sent
+                for (size_t i = n; i < MAX_TRACKED_MOUSE_BUTTONS; i++) { changed[i / 64] &= ~(static_cast<uint64_t>(1) << (i % 64)); }
+                WriteChangedEntries<MAX_TRACKED_MOUSE_BUTTONS>(writer, changed, values, timestamps, states, now);
+
+                int64_t mouse[8];
+                p_mouse->GetPosition(mouse[0], mouse[1]);
+                p_mouse->GetDelta(mouse[2], mouse[3]);
+                p_mouse->GetScroll(mouse[4], mouse[5]);
+                p_mouse->GetScrollDelta(mouse[6], mouse[7]);
+                for (const int64_t v : mouse) { writer.Zigzag(v); }
+            }
+            break;
+
+        case DeviceType::KEYBOARD:
+            {
+                const IKeyboard *const p_keyboard = dynamic_cast<const IKeyboard *>(p_interface);
+                p_keyboard->GetChangedKeys(since_generation, changed);
+                p_keyboard->GetKeyStates(states);
+                p_keyboard->GetKeyValues(values);
+                p_keyboard->GetKeyTimestamps(timestamps);
+                WriteChangedEntries<NUM_KEY_CODES>(writer, changed, values, timestamps, states, now);
+            }
+            break;
+
+        case DeviceType::GAMEPAD:
+            {
+                const IGamepad *const p_gamepad = dynamic_cast<const IGamepad *>(p_interface);
+                p_gamepad->GetChangedButtons(since_generation, changed);
+                p_gamepad->GetButtonStates(states);
+                p_gamepad->GetButtonValues(values);
+                p_gamepad->GetButtonTimestamps(timestamps);
+                WriteChangedEntries<NUM_BUTTON_CODES>(writer, changed, values, timestamps, states, now);
+
+                float xy[DeviceSnapshot::MAX_THUMBSTICKS * 2];
+                const uint32_t n = p_gamepad->GetThumbsticks(xy, DeviceSnapshot::MAX_THUMBSTICKS);
+                writer.U8(static_cast<uint8_t>(n));
+                for (uint32_t i = 0; i < n * 2; i++) { writer.Axis(xy[i]); }
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        return true;
+    }
+
+
+    IDevice *CreateRemoteDevice(const DeviceType type, const std::string &display_name)
+    {
+        ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+        BaseInterface *p_vdev;
+        switch (type)
+        {
+        case DeviceType::MOUSE: p_vdev = new RemoteMouse(display_name); break;
+        case DeviceType::KEYBOARD: p_vdev = new RemoteKeyboard(display_name); break;
+        case DeviceType::GAMEPAD: p_vdev = new RemoteGamepad(display_name); break;
+        default: return nullptr;
+        }
+
+        glob_devices.Register(p_vdev);
+        DeviceStatusChanged(p_vdev, DeviceStatusChange::DISCOVERED);
+        return p_vdev;
+    }
+
+
+    size_t ApplyDeviceState(const ID device_id, const uint8_t *const data, const size_t size)
+    {
+        ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+        RemoteDevice *const p_remote = dynamic_cast<RemoteDevice *>(glob_devices.Find(device_id));
+        if (p_remote == nullptr) { return 0; }
+
+        // parse completely first, so malformed packets are never applied partially
+        RemotePacket packet;
+        PacketReader reader(data, size);
+        if (!ParseRemotePacket(reader, packet) || packet.type != p_remote->GetType()) { return 0; }
+
+        p_remote->Apply(packet);
+        return reader.Consumed();
+    }
+}
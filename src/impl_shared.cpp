@@ -0,0 +1,948 @@
+/*================================================================================= *
+*                                   +----------+                                    *
+*                                   | crossput |                                    *
+*                                   +----------+                                    *
+*                            Copyright 2024 Trice Helix                             *
+*                                                                                   *
+* This file is part of crossput and is distributed under the BSD-3-Clause License.  *
+* Please refer to LICENSE.txt for additional information.                           *
+* =================================================================================*/
+
+#include "common.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+
+namespace crossput
+{
+    // SEGMENT LAYOUT
+
+    // a segment consists of a ServerHeader, MAX_SERVER_DEVICES ServerDeviceSlots and SERVER_EVENT_CAPACITY ServerEventSlots,
+    // everything is written by the server only and versioned via seqlock so clients can map it read-only
+    inline constexpr char SERVER_MAGIC[8] = {'C', 'R', 'S', 'P', 'T', 'S', 'H', 'M'};
+    constexpr uint32_t SERVER_VERSION = 3;
+    constexpr uint32_t SERVER_EVENT_CAPACITY = 4096;
+    constexpr size_t SERVER_NAME_LENGTH = 64;
+    constexpr uint32_t MAX_SNAPSHOT_READ_ATTEMPTS = 64; // per device update, the previous snapshot is kept afterwards
+    constexpr std::chrono::milliseconds SERVER_LIVENESS_INTERVAL(100); // between two checks whether the process of a server still exists
+
+    static_assert(std::has_single_bit(SERVER_EVENT_CAPACITY), "capacity must be a power of two");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared atomics must not rely on process-local locks");
+
+    struct ServerHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t snapshot_size; // rejects clients built with a different DeviceSnapshot
+        uint32_t max_devices;
+        uint32_t event_capacity;
+        std::atomic<uint32_t> device_count; // number of assigned slots, slots are never unassigned
+        std::atomic<uint32_t> is_running;
+        uint32_t server_pid;                // process which created the segment
+        timestamp_t server_start;           // creation time (see NowTimestamp()), tells the segments of a restarted server apart
+        std::atomic<uint64_t> event_head;   // total number of events written to the ring
+    };
+
+    // (odd sequence -> write in progress, zero -> nothing published yet)
+    struct ServerDeviceSlot
+    {
+        std::atomic<uint64_t> sequence;
+        timestamp_t publish_timestamp;
+        DeviceType type;                       // written once before the slot is assigned
+        char display_name[SERVER_NAME_LENGTH]; // written once before the slot is assigned
+        DeviceSnapshot data;
+    };
+
+    // sequence is 2 * position + 2 once the event at ring position "position" has been written
+    struct ServerEventSlot
+    {
+        std::atomic<uint64_t> sequence;
+        CaptureRecord record; // device holds the slot index, kind is always EVENT
+    };
+
+    constexpr size_t SERVER_SEGMENT_SIZE = sizeof(ServerHeader)
+        + MAX_SERVER_DEVICES * sizeof(ServerDeviceSlot)
+        + SERVER_EVENT_CAPACITY * sizeof(ServerEventSlot);
+
+
+    // MAPPED SEGMENT
+
+    // false only if the process is known to have terminated
+    bool IsProcessAlive(const uint32_t pid) noexcept
+    {
+        #ifdef _WIN32
+        const HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, static_cast<DWORD>(pid));
+        if (process == nullptr) { return GetLastError() != ERROR_INVALID_PARAMETER; } // other errors (e.g. access denied) imply that it exists
+
+        const bool is_alive = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+        CloseHandle(process);
+        return is_alive;
+        #else
+        return kill(static_cast<pid_t>(pid), 0) == 0 || errno != ESRCH;
+        #endif // _WIN32
+    }
+
+
+    // named shared-memory segment, writable by the server and read-only for clients
+    class MappedSegment
+    {
+    private:
+        void *p_data_ = nullptr;
+        size_t size_ = 0;
+        std::string path_;
+        bool is_owner_ = false;
+        mutable bool is_server_alive_ = true;
+        mutable std::chrono::steady_clock::time_point liveness_checked_ = {};
+        #ifdef _WIN32
+        HANDLE mapping_ = nullptr;
+        #endif // _WIN32
+
+    public:
+        MappedSegment(const std::string &name, const bool create, [[maybe_unused]] const ServerAccess access = ServerAccess::OWNER)
+        {
+            if (name.empty() || name.find_first_of("/\\") != std::string::npos)
+            {
+                throw std::runtime_error(std::format("Invalid input server name \"{}\".", name));
+            }
+
+            #ifdef _WIN32
+            path_ = "Local\\crossput-" + name;
+            if (create)
+            {
+                mapping_ = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, static_cast<DWORD>(SERVER_SEGMENT_SIZE), path_.c_str());
+                if (mapping_ == nullptr) { Fail(name, GetLastError()); }
+                if (GetLastError() == ERROR_ALREADY_EXISTS)
+                {
+                    // still mapped by another server or its clients
+                    CloseHandle(mapping_);
+                    mapping_ = nullptr;
+                    throw std::runtime_error(std::format("Input server \"{}\" already exists.", name));
+                }
+            }
+            else
+            {
+                mapping_ = OpenFileMappingA(FILE_MAP_READ, FALSE, path_.c_str());
+                if (mapping_ == nullptr) { Fail(name, GetLastError()); }
+            }
+
+            p_data_ = MapViewOfFile(mapping_, create ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+            if (p_data_ == nullptr) { Fail(name, GetLastError()); }
+
+            MEMORY_BASIC_INFORMATION info;
+            size_ = VirtualQuery(p_data_, &info, sizeof(info)) != 0 ? info.RegionSize : 0;
+            #else
+            path_ = "/crossput-" + name;
+            int fd;
+            if (create)
+            {
+                // never readable by other users, the segment exposes every keystroke
+                const mode_t mode = access == ServerAccess::GROUP ? 0640 : 0600;
+                fd = shm_open(path_.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, mode);
+                if (fd < 0 && errno == EEXIST)
+                {
+                    // only the stale segment of a stopped or crashed server is replaced, clients of the old segment keep their mapping
+                    if (!IsStaleSegment(path_)) { throw std::runtime_error(std::format("Input server \"{}\" already exists.", name)); }
+                    shm_unlink(path_.c_str());
+                    fd = shm_open(path_.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, mode);
+                }
+                if (fd < 0) { Fail(name, errno); }
+                is_owner_ = true;
+
+                // the mode passed to shm_open() is restricted by the umask
+                if (fchmod(fd, mode) < 0)
+                {
+                    const int e = errno;
+                    close(fd);
+                    Fail(name, e);
+                }
+
+                if (ftruncate(fd, static_cast<off_t>(SERVER_SEGMENT_SIZE)) < 0)
+                {
+                    const int e = errno;
+                    close(fd);
+                    Fail(name, e);
+                }
+                size_ = SERVER_SEGMENT_SIZE;
+            }
+            else
+            {
+                fd = shm_open(path_.c_str(), O_RDONLY | O_CLOEXEC, 0);
+                if (fd < 0) { Fail(name, errno); }
+
+                struct stat st;
+                if (fstat(fd, &st) < 0)
+                {
+                    const int e = errno;
+                    close(fd);
+                    Fail(name, e);
+                }
+                size_ = static_cast<size_t>(st.st_size);
+            }
+
+            void *const p = mmap(nullptr, size_, create ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+            const int e = errno;
+            close(fd); // mapping stays valid
+            if (p == MAP_FAILED) { Fail(name, e); }
+            p_data_ = p;
+            #endif // _WIN32
+
+            if (create)
+            {
+                // zero-filled by the OS, the magic is written last
+                ServerHeader &header = Header();
+                header.version = SERVER_VERSION;
+                header.snapshot_size = sizeof(DeviceSnapshot);
+                header.max_devices = static_cast<uint32_t>(MAX_SERVER_DEVICES);
+                header.event_capacity = SERVER_EVENT_CAPACITY;
+                #ifdef _WIN32
+                header.server_pid = static_cast<uint32_t>(GetCurrentProcessId());
+                #else
+                header.server_pid = static_cast<uint32_t>(getpid());
+                #endif // _WIN32
+                header.server_start = NowTimestamp();
+                header.is_running.store(1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                std::memcpy(header.magic, SERVER_MAGIC, sizeof(header.magic));
+            }
+            else
+            {
+                // validate
+                const ServerHeader &header = Header();
+                if (size_ < SERVER_SEGMENT_SIZE
+                    || std::memcmp(header.magic, SERVER_MAGIC, sizeof(header.magic)) != 0
+                    || header.version != SERVER_VERSION
+                    || header.snapshot_size != sizeof(DeviceSnapshot)
+                    || header.max_devices != MAX_SERVER_DEVICES
+                    || header.event_capacity != SERVER_EVENT_CAPACITY)
+                {
+                    Fail(name, 0);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+            }
+        }
+
+        MappedSegment(const MappedSegment &) = delete;
+        MappedSegment &operator=(const MappedSegment &) = delete;
+
+        ~MappedSegment() { Unmap(); }
+
+        inline ServerHeader &Header() const noexcept { return *static_cast<ServerHeader *>(p_data_); }
+
+        // true while the server publishes into this segment, i.e. it was neither stopped nor did its process terminate
+        // (the process is checked at most once per SERVER_LIVENESS_INTERVAL, which is shared by all client devices of the segment)
+        bool IsServerRunning() const noexcept
+        {
+            if (!is_server_alive_ || Header().is_running.load(std::memory_order_acquire) == 0) { return false; }
+
+            const auto now = std::chrono::steady_clock::now();
+            if (now - liveness_checked_ >= SERVER_LIVENESS_INTERVAL)
+            {
+                liveness_checked_ = now;
+                is_server_alive_ = IsProcessAlive(Header().server_pid);
+            }
+
+            return is_server_alive_;
+        }
+
+        // true if both segments were created by the same server
+        inline bool IsSameServer(const MappedSegment &other) const noexcept
+        {
+            return Header().server_pid == other.Header().server_pid && Header().server_start == other.Header().server_start;
+        }
+
+        inline ServerDeviceSlot &DeviceSlot(const uint32_t index) const noexcept
+        {
+            return reinterpret_cast<ServerDeviceSlot *>(static_cast<unsigned char *>(p_data_) + sizeof(ServerHeader))[index];
+        }
+
+        inline ServerEventSlot &EventSlot(const uint64_t position) const noexcept
+        {
+            return reinterpret_cast<ServerEventSlot *>(static_cast<unsigned char *>(p_data_) + sizeof(ServerHeader) + MAX_SERVER_DEVICES * sizeof(ServerDeviceSlot))
+                [position & (SERVER_EVENT_CAPACITY - 1)];
+        }
+
+    private:
+        #ifndef _WIN32
+        // segment of a server which stopped without removing it, or whose process no longer exists,
+        // segments which cannot be identified as compatible crossput segments (e.g. still being created) are never stale
+        static bool IsStaleSegment(const std::string &path) noexcept
+        {
+            const int fd = shm_open(path.c_str(), O_RDONLY | O_CLOEXEC, 0);
+            if (fd < 0) { return errno == ENOENT; } // removed in the meantime
+
+            bool is_stale = false;
+            struct stat st;
+            if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(ServerHeader))
+            {
+                void *const p = mmap(nullptr, sizeof(ServerHeader), PROT_READ, MAP_SHARED, fd, 0);
+                if (p != MAP_FAILED)
+                {
+                    const ServerHeader &header = *static_cast<const ServerHeader *>(p);
+                    if (std::memcmp(header.magic, SERVER_MAGIC, sizeof(header.magic)) == 0 && header.version == SERVER_VERSION)
+                    {
+                        std::atomic_thread_fence(std::memory_order_acquire);
+                        is_stale = header.is_running.load(std::memory_order_acquire) == 0 || !IsProcessAlive(header.server_pid);
+                    }
+                    munmap(p, sizeof(ServerHeader));
+                }
+            }
+
+            close(fd);
+            return is_stale;
+        }
+        #endif // _WIN32
+
+        void Unmap() noexcept
+        {
+            #ifdef _WIN32
+            if (p_data_ != nullptr) { UnmapViewOfFile(p_data_); }
+            if (mapping_ != nullptr) { CloseHandle(mapping_); }
+            mapping_ = nullptr;
+            #else
+            if (p_data_ != nullptr) { munmap(p_data_, size_); }
+            if (is_owner_) { shm_unlink(path_.c_str()); }
+            is_owner_ = false;
+            #endif // _WIN32
+            p_data_ = nullptr;
+        }
+
+        [[noreturn]] void Fail(const std::string &name, const unsigned long error)
+        {
+            Unmap();
+            throw error != 0
+                ? std::runtime_error(std::format("Failed to map input server \"{}\" (error {}).", name, error))
+                : std::runtime_error(std::format("Segment \"{}\" is not a compatible crossput input server.", name));
+        }
+    };
+
+
+    // INPUT SERVER
+
+    bool IsClientDevice(const IDevice *const p_device) noexcept;
+
+    class InputServer
+    {
+    private:
+        static constexpr uint32_t NOT_PUBLISHED = std::numeric_limits<uint32_t>::max();
+
+        MappedSegment segment_;
+        std::unordered_map<ID, uint32_t> slot_indices_; // includes devices which are not published
+        std::vector<std::pair<ID, uint32_t>> published_;
+        uint64_t event_head_ = 0;
+        DeviceSnapshot snapshot_ = {};
+
+    public:
+        InputServer(const std::string &name, const ServerAccess access) : segment_(name, true, access)
+        {
+            slot_indices_.reserve(MAX_SERVER_DEVICES);
+            published_.reserve(MAX_SERVER_DEVICES);
+        }
+
+        InputServer(const InputServer &) = delete;
+        InputServer &operator=(const InputServer &) = delete;
+
+        ~InputServer()
+        {
+            segment_.Header().is_running.store(0, std::memory_order_release);
+        }
+
+        void WriteEvent(const IDevice *const p_device, const InputEvent &ev)
+        {
+            const uint32_t index = SlotIndex(p_device);
+            if (index == NOT_PUBLISHED) { return; }
+
+            ServerEventSlot &slot = segment_.EventSlot(event_head_);
+            const uint64_t seq = event_head_ * 2 + 1;
+
+            slot.sequence.store(seq, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.record = {.device = index, .kind = CaptureRecordKind::EVENT, .detail = 0, .reserved = 0, .event = ev};
+            slot.sequence.store(seq + 1, std::memory_order_release);
+
+            segment_.Header().event_head.store(++event_head_, std::memory_order_release);
+        }
+
+        void Publish()
+        {
+            // assign slots of devices discovered since the previous publish
+            for (IDevice *const p_device : glob_devices.Devices()) { SlotIndex(p_device); }
+
+            const timestamp_t now = NowTimestamp();
+            for (const auto &[id, index] : published_)
+            {
+                ServerDeviceSlot &slot = segment_.DeviceSlot(index);
+                BaseInterface *const p_interface = glob_devices.Find(id);
+                if (p_interface != nullptr)
+                {
+                    CaptureSnapshot(p_interface, snapshot_);
+                }
+                else if (slot.data.is_connected)
+                {
+                    // destroyed devices stay disconnected
+                    snapshot_ = {};
+                    snapshot_.device_id = id;
+                    snapshot_.type = slot.type;
+                }
+                else
+                {
+                    continue;
+                }
+
+                // single writer, so relaxed loads of the own sequence are sufficient
+                const uint64_t seq = slot.sequence.load(std::memory_order_relaxed);
+                snapshot_.sequence = (seq / 2) + 1;
+
+                slot.sequence.store(seq + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                slot.publish_timestamp = now;
+                std::memcpy(&slot.data, &snapshot_, sizeof(DeviceSnapshot));
+                slot.sequence.store(seq + 2, std::memory_order_release);
+            }
+        }
+
+    private:
+        uint32_t SlotIndex(const IDevice *const p_device)
+        {
+            const auto it = slot_indices_.find(p_device->GetID());
+            if (it != slot_indices_.end()) [[likely]] { return it->second; }
+
+            uint32_t index = NOT_PUBLISHED;
+            const bool publish = published_.size() < MAX_SERVER_DEVICES
+                && p_device->GetType() != DeviceType::UNKNOWN
+                #ifdef CROSSPUT_FEATURE_AGGREGATE
+                && !p_device->IsAggregate()
+                #endif // CROSSPUT_FEATURE_AGGREGATE
+                && !IsClientDevice(p_device); // never republish another server
+
+            if (publish)
+            {
+                index = static_cast<uint32_t>(published_.size());
+                published_.emplace_back(p_device->GetID(), index);
+
+                ServerDeviceSlot &slot = segment_.DeviceSlot(index);
+                const std::string display_name = p_device->GetDisplayName();
+                std::memset(slot.display_name, 0, sizeof(slot.display_name));
+                std::memcpy(slot.display_name, display_name.data(), std::min(display_name.size(), sizeof(slot.display_name) - 1));
+                slot.type = p_device->GetType();
+
+                segment_.Header().device_count.store(index + 1, std::memory_order_release);
+            }
+
+            slot_indices_.insert({p_device->GetID(), index});
+            return index;
+        }
+    };
+
+
+    InputServer *glob_p_server = nullptr;
+
+
+    void ServerEvent(const IDevice *const p_device, const InputEvent &ev) noexcept
+    {
+        try { glob_p_server->WriteEvent(p_device, ev); }
+        catch (...) {} // event is lost, clients still receive the state
+    }
+
+
+    void PublishServerState()
+    {
+        glob_p_server->Publish();
+    }
+
+
+    bool StartInputServer(const std::string &name, const ServerAccess access)
+    {
+        ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+        if (glob_p_server != nullptr) { return false; }
+
+        glob_p_server = new InputServer(name, access);
+        return true;
+    }
+
+
+    void StopInputServer()
+    {
+        ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+        if (glob_p_server == nullptr) { return; }
+
+        InputServer *const p_server = glob_p_server;
+        glob_p_server = nullptr;
+        delete p_server;
+    }
+
+
+    bool IsInputServerRunning()
+    {
+        return glob_p_server != nullptr;
+    }
+
+
+    // CLIENT DEVICE
+
+    // implements:
+    // IDevice::GetDisplayName()
+    // IDevice::Update()
+    // and mirrors a single slot of an input server
+    class ClientDevice :
+        public virtual BaseInterface,
+        public virtual DeviceCallbackManager,
+        public virtual DeviceForceManagerEmpty
+    {
+    protected:
+        const std::shared_ptr<const MappedSegment> p_segment_;
+        const uint32_t slot_index_;
+        DeviceSnapshot data_ = {};
+        DeviceSnapshot scratch_ = {}; // copy in progress, only moved to data_ if consistent
+        timestamp_t publish_timestamp_ = 0;
+        uint64_t sequence_ = 0; // sequence of the slot when data_ was copied
+        uint64_t event_cursor_;
+        StateArray<DeviceSnapshot::MAX_BUTTONS> view_data_ = {}; // buttons of data_ in the layout read by StateView
+
+    public:
+        ClientDevice(std::shared_ptr<const MappedSegment> p_segment, const uint32_t slot_index) :
+            p_segment_(std::move(p_segment)),
+            slot_index_(slot_index),
+            event_cursor_(p_segment_->Header().event_head.load(std::memory_order_acquire))
+            {}
+
+        #ifdef CROSSPUT_FEATURE_AGGREGATE
+        constexpr bool IsAggregate() const noexcept override final { return false; }
+        #endif // CROSSPUT_FEATURE_AGGREGATE
+
+        std::string GetDisplayName() const override
+        {
+            const char *const name = p_segment_->DeviceSlot(slot_index_).display_name;
+            return std::string(name, strnlen(name, SERVER_NAME_LENGTH));
+        }
+
+        void Update() override final
+        {
+            ProtectManagementAPI("crossput::IDevice::Update()", id_);
+            CROSSPUT_STATS_TIME_UPDATE();
+            MarkServiced();
+
+            const ServerHeader &header = p_segment_->Header();
+            const ServerDeviceSlot &slot = p_segment_->DeviceSlot(slot_index_);
+
+            // copy the most recent state, unless nothing has been published since the previous update,
+            // the previous state is kept if no consistent copy succeeds (e.g. the server died while publishing)
+            const bool is_running = p_segment_->IsServerRunning();
+            for (uint32_t attempt = 0; is_running && attempt < MAX_SNAPSHOT_READ_ATTEMPTS; attempt++)
+            {
+                const uint64_t seq1 = slot.sequence.load(std::memory_order_acquire);
+                if (seq1 == sequence_) { break; }
+                if (seq1 & 1) { continue; } // write in progress
+
+                const timestamp_t publish_timestamp = slot.publish_timestamp;
+                std::memcpy(&scratch_, &slot.data, sizeof(DeviceSnapshot));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.sequence.load(std::memory_order_relaxed) != seq1) { continue; }
+
+                std::memcpy(&data_, &scratch_, sizeof(DeviceSnapshot));
+                publish_timestamp_ = publish_timestamp;
+                sequence_ = seq1;
+                UpdateView();
+                break;
+            }
+
+            SetConnected(data_.is_connected && is_running);
+
+            // replay the events published since the previous update, events overwritten in the meantime are skipped
+            const uint64_t head = header.event_head.load(std::memory_order_acquire);
+            if (head - event_cursor_ > SERVER_EVENT_CAPACITY)
+            {
+                CROSSPUT_STATS_ADD(overruns, 1);
+                event_cursor_ = head - SERVER_EVENT_CAPACITY;
+            }
+
+            for (; event_cursor_ < head; event_cursor_++)
+            {
+                const ServerEventSlot &event_slot = p_segment_->EventSlot(event_cursor_);
+                const uint64_t expected = event_cursor_ * 2 + 2;
+                if (event_slot.sequence.load(std::memory_order_acquire) != expected) { continue; }
+
+                const CaptureRecord record = event_slot.record;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (event_slot.sequence.load(std::memory_order_relaxed) != expected) { continue; }
+
+                if (record.device == slot_index_ && is_connected_)
+                {
+                    CROSSPUT_STATS_ADD(events_read, 1);
+                    ReplayEvent(record.event);
+                }
+            }
+        }
+
+    protected:
+        virtual void ReplayEvent(const InputEvent &ev) = 0;
+
+        // time since the last state change relative to the publish, converted back to a timestamp
+        inline timestamp_t ButtonTimestamp(const uint32_t index) const noexcept
+        {
+            const float time = data_.button_times[index];
+            return std::isfinite(time) ? publish_timestamp_ - static_cast<timestamp_t>(time * 1'000'000.0F) : 0;
+        }
+
+        inline void CopyButtonStates(uint64_t *const states, const size_t num_words, const uint32_t count) const noexcept
+        {
+            std::memset(states, 0, num_words * sizeof(uint64_t));
+            if (!is_connected_) { return; }
+
+            const size_t n = std::min(static_cast<size_t>(count), num_words * 64);
+            for (size_t i = 0; i < n; i++)
+            {
+                states[i / 64] |= static_cast<uint64_t>(data_.button_states[i]) << (i % 64);
+            }
+        }
+
+        inline void CopyButtonValues(float *const values, const uint32_t count) const noexcept
+        {
+            if (is_connected_) { std::memcpy(values, data_.button_values, count * sizeof(float)); }
+            else { std::memset(values, 0, count * sizeof(float)); }
+        }
+
+        inline void CopyButtonTimestamps(uint64_t *const timestamps, const uint32_t count) const noexcept
+        {
+            for (uint32_t i = 0; i < count; i++) { timestamps[i] = is_connected_ ? ButtonTimestamp(i) : 0; }
+        }
+
+    private:
+        void UpdateView() noexcept
+        {
+            for (uint32_t i = 0; i < DeviceSnapshot::MAX_BUTTONS; i++)
+            {
+                const bool is_valid = i < data_.button_count;
+                view_data_.Assign(i, is_valid ? data_.button_values[i] : 0.0F, is_valid ? ButtonTimestamp(i) : 0, is_valid && data_.button_states[i]);
+            }
+        }
+
+        void SetConnected(const bool connected)
+        {
+            if (connected == is_connected_) { return; }
+
+            is_connected_ = connected;
+            DeviceStatusChanged(this, connected ? DeviceStatusChange::CONNECTED : DeviceStatusChange::DISCONNECTED);
+        }
+    };
+
+
+    bool IsClientDevice(const IDevice *const p_device) noexcept
+    {
+        return dynamic_cast<const ClientDevice *>(p_device) != nullptr;
+    }
+
+
+    class ClientMouse final :
+        public virtual IMouse,
+        public virtual ClientDevice,
+        public virtual TypedInterface<DeviceType::MOUSE>,
+        public virtual MouseCallbackManager
+    {
+    public:
+        ClientMouse(std::shared_ptr<const MappedSegment> p_segment, const uint32_t slot_index) :
+            ClientDevice(std::move(p_segment), slot_index)
+            {}
+
+        void GetPosition(int64_t &x, int64_t &y) const override
+        {
+            if (!is_connected_) { return; }
+            x = data_.position[0];
+            y = data_.position[1];
+        }
+
+        void GetDelta(int64_t &x, int64_t &y) const override
+        {
+            if (!is_connected_) { return; }
+            x = data_.delta[0];
+            y = data_.delta[1];
+        }
+
+        void GetScroll(int64_t &x, int64_t &y) const override
+        {
+            if (!is_connected_) { return; }
+            x = data_.scroll[0];
+            y = data_.scroll[1];
+        }
+
+        void GetScrollDelta(int64_t &x, int64_t &y) const override
+        {
+            if (!is_connected_) { return; }
+            x = data_.scroll_delta[0];
+            y = data_.scroll_delta[1];
+        }
+
+        uint32_t GetButtonCount() const override { return is_connected_ ? data_.button_count : 0; }
+
+        // thresholds are owned by the server
+        void SetButtonThreshold(const uint32_t, float) override {}
+        void SetGlobalThreshold(float) override {}
+        float GetButtonThreshold(const uint32_t) const override { return 0.0F; }
+
+        float GetButtonValue(const uint32_t index) const override
+        {
+            return (is_connected_ && index < data_.button_count) ? data_.button_values[index] : 0.0F;
+        }
+
+        bool GetButtonState(const uint32_t index, float &time) const override
+        {
+            if (is_connected_ && index < data_.button_count)
+            {
+                time = data_.button_times[index];
+                return data_.button_states[index];
+            }
+            else
+            {
+                time = std::numeric_limits<float>::infinity();
+                return false;
+            }
+        }
+
+        StateView GetButtonView() const override { return view_data_.View(is_connected_); }
+        void GetButtonStates(uint64_t *const states, const size_t num_words) const override
+        {
+            CopyButtonStates(states, num_words, data_.button_count);
+        }
+
+        uint32_t GetButtonValues(float *const values, const uint32_t max_count) const override
+        {
+            const uint32_t n = std::min(max_count, ClientMouse::GetButtonCount());
+            CopyButtonValues(values, n);
+            return n;
+        }
+
+        uint32_t GetButtonTimestamps(uint64_t *const timestamps, const uint32_t max_count) const override
+        {
+            const uint32_t n = std::min(max_count, ClientMouse::GetButtonCount());
+            CopyButtonTimestamps(timestamps, n);
+            return n;
+        }
+
+    private:
+        void ReplayEvent(const InputEvent &ev) override
+        {
+            switch (ev.type)
+            {
+            case InputEventType::MOUSE_MOVE:
+                MouseMoved(data_.position[0], data_.position[1], ev.delta.dx, ev.delta.dy, ev.timestamp);
+                break;
+
+            case InputEventType::MOUSE_SCROLL:
+                MouseScrolled(data_.scroll[0], data_.scroll[1], ev.delta.dx, ev.delta.dy, ev.timestamp);
+                break;
+
+            case InputEventType::MOUSE_BUTTON:
+                if (ev.code < data_.button_count) { ButtonChanged(ev.code, ev.value, ev.state, ev.timestamp); }
+                break;
+
+            default:
+                break;
+            }
+        }
+    };
+
+
+    class ClientKeyboard final :
+        public virtual IKeyboard,
+        public virtual ClientDevice,
+        public virtual TypedInterface<DeviceType::KEYBOARD>,
+        public virtual KeyboardCallbackManager
+    {
+    public:
+        ClientKeyboard(std::shared_ptr<const MappedSegment> p_segment, const uint32_t slot_index) :
+            ClientDevice(std::move(p_segment), slot_index)
+            {}
+
+        uint32_t GetNumKeysPressed() const override { return is_connected_ ? data_.num_keys_pressed : 0; }
+
+        // thresholds are owned by the server
+        void SetKeyThreshold(const Key, float) override {}
+        void SetGlobalThreshold(float) override {}
+        float GetKeyThreshold(const Key) const override { return 0.0F; }
+
+        float GetKeyValue(const Key key) const override
+        {
+            return (is_connected_ && IsValidKey(key)) ? data_.button_values[static_cast<int>(key)] : 0.0F;
+        }
+
+        bool GetKeyState(const Key key, float &time) const override
+        {
+            if (is_connected_ && IsValidKey(key))
+            {
+                time = data_.button_times[static_cast<int>(key)];
+                return data_.button_states[static_cast<int>(key)];
+            }
+            else
+            {
+                time = std::numeric_limits<float>::infinity();
+                return false;
+            }
+        }
+
+        StateView GetKeyView() const override { return view_data_.View(is_connected_, NUM_KEY_CODES); }
+        void GetKeyStates(uint64_t *const states) const override { CopyButtonStates(states, NUM_KEY_STATE_WORDS, NUM_KEY_CODES); }
+        void GetKeyValues(float *const values) const override { CopyButtonValues(values, NUM_KEY_CODES); }
+        void GetKeyTimestamps(uint64_t *const timestamps) const override { CopyButtonTimestamps(timestamps, NUM_KEY_CODES); }
+
+    private:
+        void ReplayEvent(const InputEvent &ev) override
+        {
+            if (ev.type == InputEventType::KEYBOARD_KEY && IsValidKey(static_cast<Key>(ev.code)))
+            {
+                KeyChanged(static_cast<Key>(ev.code), ev.value, ev.state, ev.timestamp);
+            }
+        }
+    };
+
+
+    class ClientGamepad final :
+        public virtual IGamepad,
+        public virtual ClientDevice,
+        public virtual TypedInterface<DeviceType::GAMEPAD>,
+        public virtual GamepadCallbackManager,
+        public virtual GamepadProfileManagerEmpty
+    {
+    public:
+        ClientGamepad(std::shared_ptr<const MappedSegment> p_segment, const uint32_t slot_index) :
+            ClientDevice(std::move(p_segment), slot_index)
+            {}
+
+        // thresholds are owned by the server
+        void SetButtonThreshold(const Button, float) override {}
+        void SetGlobalThreshold(float) override {}
+        float GetButtonThreshold(const Button) const override { return 0.0F; }
+
+        float GetButtonValue(const Button button) const override
+        {
+            return (is_connected_ && IsValidButton(button)) ? data_.button_values[static_cast<int>(button)] : 0.0F;
+        }
+
+        bool GetButtonState(const Button button, float &time) const override
+        {
+            if (is_connected_ && IsValidButton(button))
+            {
+                time = data_.button_times[static_cast<int>(button)];
+                return data_.button_states[static_cast<int>(button)];
+            }
+            else
+            {
+                time = std::numeric_limits<float>::infinity();
+                return false;
+            }
+        }
+
+        StateView GetButtonView() const override { return view_data_.View(is_connected_, NUM_BUTTON_CODES); }
+        void GetButtonStates(uint64_t *const states) const override { CopyButtonStates(states, NUM_BUTTON_STATE_WORDS, NUM_BUTTON_CODES); }
+        void GetButtonValues(float *const values) const override { CopyButtonValues(values, NUM_BUTTON_CODES); }
+        void GetButtonTimestamps(uint64_t *const timestamps) const override { CopyButtonTimestamps(timestamps, NUM_BUTTON_CODES); }
+
+        uint32_t GetThumbstickCount() const override { return is_connected_ ? data_.thumbstick_count : 0; }
+
+        void GetThumbstick(const uint32_t index, float &x, float &y) const override
+        {
+            if (is_connected_ && index < data_.thumbstick_count)
+            {
+                x = data_.thumbsticks[index][0];
+                y = data_.thumbsticks[index][1];
+            }
+            else
+            {
+                x = 0.0F;
+                y = 0.0F;
+            }
+        }
+
+        uint32_t GetThumbsticks(float *const xy, const uint32_t max_count) const override
+        {
+            const uint32_t n = std::min(max_count, ClientGamepad::GetThumbstickCount());
+            std::memcpy(xy, data_.thumbsticks, n * 2 * sizeof(float));
+            return n;
+        }
+
+    private:
+        void ReplayEvent(const InputEvent &ev) override
+        {
+            if (ev.type == InputEventType::GAMEPAD_BUTTON && IsValidButton(static_cast<Button>(ev.code)))
+            {
+                ButtonChanged(static_cast<Button>(ev.code), ev.value, ev.state, ev.timestamp);
+            }
+            else if (ev.type == InputEventType::GAMEPAD_THUMBSTICK && ev.code < data_.thumbstick_count)
+            {
+                ThumbstickChanged(ev.code, ev.axes.x, ev.axes.y, ev.timestamp);
+            }
+        }
+    };
+
+
+    // GLOBAL SHARED MEMORY API
+
+    // segments this process is a client of, with the number of slots which already have a client device
+    std::unordered_map<std::string, std::pair<std::weak_ptr<const MappedSegment>, uint32_t>> glob_client_segments;
+
+
+    size_t ConnectInputServer(const std::string &name, std::vector<IDevice *> &devices)
+    {
+        ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+        auto &[p_weak_segment, num_mirrored] = glob_client_segments[name];
+        std::shared_ptr<const MappedSegment> p_segment = p_weak_segment.lock();
+        if (p_segment == nullptr)
+        {
+            // the previous segment (if any) is no longer mirrored by any device
+            p_segment = std::make_shared<const MappedSegment>(name, false);
+            p_weak_segment = p_segment;
+            num_mirrored = 0;
+        }
+        else if (!p_segment->IsServerRunning())
+        {
+            // a restarted server publishes into a new segment, devices of the previous one stay disconnected
+            std::shared_ptr<const MappedSegment> p_new_segment;
+            try { p_new_segment = std::make_shared<const MappedSegment>(name, false); }
+            catch (const std::runtime_error &) {} // not restarted (yet)
+
+            if (p_new_segment != nullptr && !p_new_segment->IsSameServer(*p_segment))
+            {
+                p_segment = std::move(p_new_segment);
+                p_weak_segment = p_segment;
+                num_mirrored = 0;
+            }
+        }
+
+        const uint32_t device_count = std::min(p_segment->Header().device_count.load(std::memory_order_acquire), static_cast<uint32_t>(MAX_SERVER_DEVICES));
+
+        size_t num = 0;
+        for (; num_mirrored < device_count; num_mirrored++)
+        {
+            BaseInterface *p_vdev;
+            switch (p_segment->DeviceSlot(num_mirrored).type)
+            {
+            case DeviceType::MOUSE: p_vdev = new ClientMouse(p_segment, num_mirrored); break;
+            case DeviceType::KEYBOARD: p_vdev = new ClientKeyboard(p_segment, num_mirrored); break;
+            case DeviceType::GAMEPAD: p_vdev = new ClientGamepad(p_segment, num_mirrored); break;
+            default: continue;
+            }
+
+            glob_devices.Register(p_vdev);
+            DeviceStatusChanged(p_vdev, DeviceStatusChange::DISCOVERED);
+
+            devices.push_back(p_vdev);
+            num++;
+        }
+
+        return num;
+    }
+}
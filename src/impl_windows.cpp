@@ -10,6 +10,8 @@
 
 #include "common.hpp"
 
+#include <atomic>
+#include <chrono>
 #include <limits>
 #include <unordered_set>
 #include <GameInput.h>
@@ -341,6 +343,33 @@ namespace crossput
     IGameInput *p_input = nullptr;
     std::unordered_set<WindowsHardwareID> nat_device_ids;
 
+    // see SetProbeThreadCount(), has no effect on this platform
+    uint32_t nat_probe_thread_count = 1;
+
+    // true if reading callbacks push readings into per-device buffers which are drained during updates
+    bool nat_buffer_readings = false;
+
+    // device callback of the hotplug monitor, 0 if the monitor is disabled
+    GameInputCallbackToken nat_hotplug_token = 0;
+
+    // incremented by the hotplug monitor (on a GameInput thread) whenever a device connects or disconnects
+    std::atomic<uint64_t> nat_hotplug_generation = 0;
+
+    // true if DiscoverDevices() has to search for devices (only relevant while the monitor is enabled)
+    std::atomic<bool> nat_discovery_pending = true;
+
+    // event signalled by reading callbacks and the hotplug monitor, nullptr until WaitForInput() is invoked for the first time
+    HANDLE nat_input_event = nullptr;
+
+    // value of nat_hotplug_generation during the last invocation of WaitForInput()
+    uint64_t nat_wait_hotplug_generation = 0;
+
+    // hotplug generation which causes a device to attempt reconnecting during its next update
+    constexpr uint64_t FORCE_RECONNECT_GENERATION = std::numeric_limits<uint64_t>::max();
+
+    // number of readings each device can buffer between two updates (see SetReadingBufferEnabled())
+    constexpr size_t READING_BUFFER_CAPACITY = 512;
+
 
     inline bool IsNativeDeviceConnected(IGameInputDevice *const p_ndev)
     {
@@ -359,8 +388,15 @@ namespace crossput
     protected:
         const WindowsHardwareID hardware_id_;
         IGameInputDevice *p_ndev_ = nullptr;
+        std::vector<IGameInputReading *> readings_; // scratch buffer used during Update()
+        std::unique_ptr<SpscQueue<IGameInputReading *, READING_BUFFER_CAPACITY>> reading_buffer_; // filled by the reading callback while buffering is enabled
+        std::atomic<bool> reading_overrun_ = false; // readings were dropped, the next update has to walk the input chain
         gdk_timestamp_t last_reading_timestamp_ = 0;
         timestamp_t last_update_timestamp_ = 0;
+        uint64_t hotplug_generation_ = FORCE_RECONNECT_GENERATION;
+        GameInputCallbackToken reading_token_ = 0;
+        std::atomic<bool> has_pending_input_ = false;
+        std::string display_name_; // cached while connected
         bool supports_sync_ = false;
         #ifdef CROSSPUT_FEATURE_FORCE
         // when supports_rumble_ == true, the first motor is for rumble only
@@ -376,6 +412,32 @@ namespace crossput
         std::string GetDisplayName() const override final;
         void Update() override final;
 
+        // register reading callback which notifies WaitForInput() about new input and/or buffers readings
+        // (only if either of them is currently required)
+        void EnableReadingCallback();
+
+        inline void DisableReadingCallback()
+        {
+            if (reading_token_ != 0)
+            {
+                // blocks until the callback is guaranteed to not be running anymore
+                p_input->UnregisterCallback(reading_token_, 60000);
+                reading_token_ = 0;
+            }
+
+            has_pending_input_ = false;
+            DiscardBufferedReadings();
+
+            // the buffer is only fed while the callback is registered, otherwise Update() would wait for readings forever
+            reading_buffer_.reset();
+            reading_overrun_ = false;
+        }
+
+        // returns true if new input arrived since the last invocation
+        bool ConsumePendingInput();
+
+        constexpr bool HasReadingNotifications() const noexcept { return reading_token_ != 0; }
+
         #ifdef CROSSPUT_FEATURE_FORCE
         constexpr bool SupportsForce(const uint32_t motor_index, const ForceType type) const override final
         {
@@ -408,14 +470,25 @@ namespace crossput
 
         virtual ~WindowsDevice()
         {
+            #ifdef CROSSPUT_FEATURE_FORCE
+            // the worker of a force stream uses the native device and the motor gains
+            JoinForceStream();
+            #endif // CROSSPUT_FEATURE_FORCE
+
             nat_device_ids.erase(hardware_id_);
+            DisableReadingCallback();
             ReleaseNativeDevicePtr();
+
+            // hardware is available for discovery again
+            nat_discovery_pending = true;
         }
 
     protected:
         WindowsDevice(const APP_LOCAL_DEVICE_ID &dev_id) :
             hardware_id_(WindowsHardwareID(dev_id))
-            {}
+        {
+            readings_.reserve(16);
+        }
 
         virtual GameInputKind GetQueryInputKind() const = 0;
 
@@ -427,6 +500,16 @@ namespace crossput
         // NOTE: reading is automatically released after the method returns
         virtual bool HandleNativeReading(IGameInputReading *const p_reading) = 0;
 
+        inline void DiscardBufferedReadings()
+        {
+            if (reading_buffer_ == nullptr) { return; }
+
+            IGameInputReading *p_reading;
+            while (reading_buffer_->TryPop(p_reading)) { p_reading->Release(); }
+        }
+
+        bool HandleBufferedReadings(size_t &num_handled);
+
         inline void ReleaseNativeDevicePtr()
         {
             if (p_ndev_ != nullptr)
@@ -467,7 +550,7 @@ namespace crossput
 
     
     private:
-        TSTV button_data_[NUM_BUTTONS] = {};
+        StateArray<NUM_BUTTONS> button_data_ = {};
         MouseData data_ = {};
         Offset offset_ = {};
         bool has_offset_ = false;
@@ -485,6 +568,10 @@ namespace crossput
         constexpr float GetButtonThreshold(const uint32_t index) const noexcept override;
         constexpr float GetButtonValue(const uint32_t index) const noexcept override;
         constexpr bool GetButtonState(const uint32_t index, float &time) const noexcept override;
+        StateView GetButtonView() const override { return button_data_.View(is_connected_); }
+        void GetButtonStates(uint64_t *const states, const size_t num_words) const override;
+        uint32_t GetButtonValues(float *const values, const uint32_t max_count) const override;
+        uint32_t GetButtonTimestamps(uint64_t *const timestamps, const uint32_t max_count) const override;
 
     protected:
         constexpr GameInputKind GetQueryInputKind() const noexcept override { return Q_INPUT_KIND_MOUSE; }
@@ -501,7 +588,7 @@ namespace crossput
         public virtual KeyboardCallbackManager
     {
     private:
-        TSTV key_data_[NUM_KEY_CODES] = {};
+        StateArray<NUM_KEY_CODES> key_data_ = {};
         std::unique_ptr<GameInputKeyState[]> p_giks_cache_;
         uint32_t max_num_keys_pressed_ = 0;
         uint32_t num_keys_pressed_ = 0;
@@ -515,6 +602,10 @@ namespace crossput
         constexpr float GetKeyThreshold(const Key key) const override;
         constexpr float GetKeyValue(const Key key) const override;
         constexpr bool GetKeyState(const Key key, float &time) const override;
+        StateView GetKeyView() const override { return key_data_.View(is_connected_); }
+        void GetKeyStates(uint64_t *const states) const override;
+        void GetKeyValues(float *const values) const override;
+        void GetKeyTimestamps(uint64_t *const timestamps) const override;
 
     private:
         constexpr GameInputKind GetQueryInputKind() const noexcept override { return Q_INPUT_KIND_KEYBOARD; }
@@ -528,13 +619,14 @@ namespace crossput
         public virtual IGamepad,
         public virtual WindowsDevice,
         public virtual TypedInterface<DeviceType::GAMEPAD>,
-        public virtual GamepadCallbackManager
+        public virtual GamepadCallbackManager,
+        public virtual GamepadProfileManager
     {
     public:
         static constexpr size_t NUM_THUMBSTICKS = 2;
 
     private:
-        TSTV button_data_[NUM_BUTTON_CODES] = {};
+        StateArray<NUM_BUTTON_CODES> button_data_ = {};
         std::pair<float, float> thumbstick_values_[NUM_THUMBSTICKS] = {};
         
     public:
@@ -545,23 +637,27 @@ namespace crossput
         constexpr float GetButtonThreshold(const Button button) const override;
         constexpr float GetButtonValue(const Button button) const override;
         constexpr bool GetButtonState(const Button button, float &time) const override;
+        StateView GetButtonView() const override { return button_data_.View(is_connected_); }
+        void GetButtonStates(uint64_t *const states) const override;
+        void GetButtonValues(float *const values) const override;
+        void GetButtonTimestamps(uint64_t *const timestamps) const override;
         constexpr uint32_t GetThumbstickCount() const override;
         constexpr void GetThumbstick(const uint32_t index, float &x, float &y) const override;
+        uint32_t GetThumbsticks(float *const xy, const uint32_t max_count) const override;
 
     private:
         constexpr GameInputKind GetQueryInputKind() const noexcept override { return Q_INPUT_KIND_GAMEPAD; }
         bool HandleNativeReading(IGameInputReading *const p_reading) override;
         void OnDisconnected() override;
 
-        inline void HandleThumbstick(const uint32_t index, const float x, const float y)
+        inline void HandleThumbstick(const uint32_t index, float x, float y, const timestamp_t timestamp)
         {
+            // only the processed position is reported, which filters out jitter within the deadzone
+            ProcessThumbstick(index, x, y);
             if (x != thumbstick_values_[index].first || y != thumbstick_values_[index].second)
             {
                 thumbstick_values_[index] = {x, y};
-
-                #ifdef CROSSPUT_FEATURE_CALLBACK
-                ThumbstickChanged(index, x, y);
-                #endif // CROSSPUT_FEATURE_CALLBACK
+                ThumbstickChanged(index, x, y, timestamp);
             }
         }
     };
@@ -655,12 +751,10 @@ namespace crossput
             return nullptr;
         }
 
-        glob_interfaces.insert({p_vdev->GetID(), p_vdev});
+        glob_devices.Register(p_vdev);
         nat_device_ids.insert(p_vdev->GetHardwareID());
 
-        #ifdef CROSSPUT_FEATURE_CALLBACK
         DeviceStatusChanged(p_vdev, DeviceStatusChange::DISCOVERED);
-        #endif // CROSSPUT_FEATURE_CALLBACK
 
         return p_vdev;
     }
@@ -668,14 +762,14 @@ namespace crossput
 
     // iterate over input chain until the specified timestamp is reached, using given filters, and handle each input reading (from oldest to newest) using the provided handler function
     // returns number of inputs read, including the first input that is past the minimum timestamp (meaning if an error occurs, 0 is returned)
-    size_t ReadInputChain(const GameInputKind input_kind, IGameInputDevice *const p_device, const gdk_timestamp_t min_timestamp, auto &&handler)
+    // readings is a scratch buffer owned by the caller, reusing it avoids allocating on every invocation
+    size_t ReadInputChain(const GameInputKind input_kind, IGameInputDevice *const p_device, const gdk_timestamp_t min_timestamp, std::vector<IGameInputReading *> &readings, auto &&handler)
     {
         assert(input_kind != GameInputKind::GameInputKindUnknown);
 
         size_t read = 0;
         IGameInputReading *p_reading;
-        std::vector<IGameInputReading *> readings;
-        readings.reserve(16);
+        readings.clear();
 
         if (SUCCEEDED(p_input->GetCurrentReading(input_kind, p_device, &p_reading)))
         {
@@ -879,10 +973,8 @@ namespace crossput
 
     // GLOBAL FUNCTION IMPLEMENTATIONS
 
-    size_t DiscoverDevices()
+    inline void InitializeGameInput()
     {
-        ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
-
         if (p_input == nullptr)
         {
             // first invocation -> hook into GDK
@@ -893,6 +985,32 @@ namespace crossput
 
             nat_device_ids.reserve(16);
         }
+    }
+
+
+    // GameInput timestamps are derived from the performance counter, the fallback only serves before initialization
+    uint64_t NowTimestamp()
+    {
+        if (p_input != nullptr) [[likely]] { return p_input->GetCurrentTimestamp(); }
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+
+    // GameInput delivers readings without per-device system calls, nothing to batch
+    void BeginDeviceUpdates() {}
+    void EndDeviceUpdates() {}
+
+
+    size_t DiscoverDevices()
+    {
+        ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+        InitializeGameInput();
+
+        if (nat_hotplug_token != 0 && !nat_discovery_pending.exchange(false))
+        {
+            // the monitor did not report any changes
+            return 0;
+        }
 
         constexpr auto devenum_callback = [](
             [[maybe_unused]] _In_ GameInputCallbackToken callback_token,
@@ -941,25 +1059,198 @@ namespace crossput
     }
 
 
-    // WINDOWS DEVICE
-    std::string WindowsDevice::GetDisplayName() const
+    bool SetHotplugMonitorEnabled(const bool enabled)
     {
-        if (is_connected_)
+        ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+        if (enabled == (nat_hotplug_token != 0)) { return true; }
+
+        if (!enabled)
+        {
+            p_input->UnregisterCallback(nat_hotplug_token, 60000);
+            nat_hotplug_token = 0;
+            nat_discovery_pending = true;
+            return true;
+        }
+
+        InitializeGameInput();
+
+        constexpr auto hotplug_callback = [](
+            [[maybe_unused]] _In_ GameInputCallbackToken callback_token,
+            [[maybe_unused]] _In_ void * p_context,
+            [[maybe_unused]] _In_ IGameInputDevice * p_device,
+            [[maybe_unused]] _In_ gdk_timestamp_t timestamp,
+            [[maybe_unused]] _In_ GameInputDeviceStatus current_status,
+            [[maybe_unused]] _In_ GameInputDeviceStatus previous_status)
         {
-            const GameInputDeviceInfo *const p_info = p_ndev_->GetDeviceInfo();
-            if (p_info != nullptr && p_info->displayName != nullptr)
+            nat_hotplug_generation++;
+            nat_discovery_pending = true;
+            if (nat_input_event != nullptr) { SetEvent(nat_input_event); }
+        };
+
+        // only report future changes, existing devices are found by DiscoverDevices()
+        if (!SUCCEEDED(p_input->RegisterDeviceCallback(
+            nullptr,
+            Q_INPUT_KIND_ANY,
+            GameInputDeviceStatus::GameInputDeviceConnected,
+            GameInputEnumerationKind::GameInputNoEnumeration,
+            nullptr,
+            // add __stdcall qualifier to lambda
+            static_cast<void (CALLBACK *)(
+                _In_ GameInputCallbackToken,
+                _In_ void *,
+                _In_ IGameInputDevice *,
+                _In_ gdk_timestamp_t,
+                _In_ GameInputDeviceStatus,
+                _In_ GameInputDeviceStatus)>
+                (hotplug_callback),
+            &nat_hotplug_token)))
+        {
+            nat_hotplug_token = 0;
+            return false;
+        }
+
+        nat_discovery_pending = true;
+        return true;
+    }
+
+
+    bool IsHotplugMonitorEnabled()
+    {
+        return nat_hotplug_token != 0;
+    }
+
+
+    void SetProbeThreadCount(const uint32_t count)
+    {
+        ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+        // GameInput enumerates devices itself, the value is only stored
+        nat_probe_thread_count = std::max(count, static_cast<uint32_t>(1));
+    }
+
+
+    uint32_t GetProbeThreadCount()
+    {
+        return nat_probe_thread_count;
+    }
+
+
+    void SetReadingBufferEnabled(const bool enabled)
+    {
+        ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+
+        if (enabled == nat_buffer_readings) { return; }
+        nat_buffer_readings = enabled;
+
+        // re-register reading callbacks of connected devices
+        for (BaseInterface *const p_interface : glob_devices.Interfaces())
+        {
+            WindowsDevice *const p_windev = dynamic_cast<WindowsDevice *>(p_interface);
+            if (p_windev != nullptr && p_windev->IsConnected())
             {
-                return std::string(p_info->displayName->data, p_info->displayName->sizeInBytes);
+                p_windev->DisableReadingCallback();
+                p_windev->EnableReadingCallback();
             }
         }
+    }
+
 
-        return std::string();
+    bool IsReadingBufferEnabled()
+    {
+        return nat_buffer_readings;
+    }
+
+
+    size_t WaitForInput(std::vector<IDevice *> &ready_devices, const float timeout, bool *const p_hotplug_detected)
+    {
+        ProtectManagementAPI(CROSSPUT_FUNCTION_STR);
+        InitializeGameInput();
+
+        if (p_hotplug_detected != nullptr) { *p_hotplug_detected = false; }
+
+        if (nat_input_event == nullptr)
+        {
+            // first invocation -> create auto-reset event and register reading callbacks on all connected devices
+            nat_input_event = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+            if (nat_input_event == nullptr)
+            {
+                throw std::runtime_error(std::format("Failed to create event object (error {}).", GetLastError()));
+            }
+
+            for (BaseInterface *const p_interface : glob_devices.Interfaces())
+            {
+                WindowsDevice *const p_windev = dynamic_cast<WindowsDevice *>(p_interface);
+                if (p_windev != nullptr && p_windev->IsConnected()) { p_windev->EnableReadingCallback(); }
+            }
+
+            nat_wait_hotplug_generation = nat_hotplug_generation;
+        }
+
+        using clock = std::chrono::steady_clock;
+        const bool infinite = IsInfiniteWaitTimeout(timeout);
+        const clock::time_point deadline = clock::now() + std::chrono::duration_cast<clock::duration>(std::chrono::duration<float>(infinite ? 0.0F : timeout));
+
+        while (true)
+        {
+            size_t num_ready = 0;
+            bool requires_polling = false;
+
+            const uint64_t hotplug_generation = nat_hotplug_generation;
+            const bool hotplug_changed = nat_wait_hotplug_generation != hotplug_generation;
+            nat_wait_hotplug_generation = hotplug_generation;
+
+            for (BaseInterface *const p_interface : glob_devices.Interfaces())
+            {
+                WindowsDevice *const p_windev = dynamic_cast<WindowsDevice *>(p_interface);
+                if (p_windev == nullptr) { continue; }
+
+                // disconnected devices may be able to reconnect when the monitor reported a change
+                if (p_windev->IsConnected() ? p_windev->ConsumePendingInput() : hotplug_changed)
+                {
+                    ready_devices.push_back(p_windev);
+                    num_ready++;
+                }
+
+                requires_polling |= p_windev->IsConnected() && !p_windev->HasReadingNotifications();
+            }
+
+            if (hotplug_changed && p_hotplug_detected != nullptr) { *p_hotplug_detected = true; }
+            if (num_ready > 0 || hotplug_changed) { return num_ready; }
+
+            DWORD wait_ms = INFINITE;
+            if (!infinite)
+            {
+                const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - clock::now()).count();
+                if (remaining <= 0) { return 0; }
+                wait_ms = static_cast<DWORD>(std::min(remaining, static_cast<decltype(remaining)>(INFINITE - 1)));
+            }
+
+            // devices without reading callbacks have to be checked periodically
+            if (requires_polling) { wait_ms = std::min(wait_ms, static_cast<DWORD>(1)); }
+
+            const DWORD wait_result = WaitForSingleObject(nat_input_event, wait_ms);
+            CROSSPUT_STATS_ADD_GLOBAL(syscalls, 1);
+            if (wait_result == WAIT_FAILED)
+            {
+                throw std::runtime_error(std::format("Failed to wait for input (error {}).", GetLastError()));
+            }
+        }
+    }
+
+
+    // WINDOWS DEVICE
+    std::string WindowsDevice::GetDisplayName() const
+    {
+        return is_connected_ ? display_name_ : std::string();
     }
 
 
     void WindowsDevice::Update()
     {
-        ProtectManagementAPI(std::format("crossput::IDevice::Update() - Device ID {}", id_));
+        ProtectManagementAPI("crossput::IDevice::Update()", id_);
+        CROSSPUT_STATS_TIME_UPDATE();
+        MarkServiced();
         
         if (!(is_connected_ || TryConnect())) { return; }
 
@@ -979,7 +1270,29 @@ namespace crossput
         PreInputHandling();
         
         last_update_timestamp_ = p_input->GetCurrentTimestamp();
-        if (ReadInputChain(GetQueryInputKind(), p_ndev_, last_reading_timestamp_ + 1, std::bind(&WindowsDevice::HandleNativeReading, this, std::placeholders::_1)) < 1)
+
+        bool success;
+        size_t num_handled;
+        if (reading_buffer_ != nullptr && !reading_overrun_.exchange(false))
+        {
+            success = HandleBufferedReadings(num_handled);
+            CROSSPUT_STATS_ADD(syscalls, 1);
+        }
+        else
+        {
+            // buffered readings are either missing or already part of the chain
+            DiscardBufferedReadings();
+            const size_t num_read = ReadInputChain(GetQueryInputKind(), p_ndev_, last_reading_timestamp_ + 1, readings_, [this](IGameInputReading *const p_reading) { return HandleNativeReading(p_reading); });
+            success = num_read >= 1;
+            num_handled = readings_.size();
+            CROSSPUT_STATS_ADD(syscalls, num_read + 1);
+        }
+
+        // every reading holds the complete state of the device, i.e. it is a group of events by itself
+        CROSSPUT_STATS_ADD(events_read, num_handled);
+        CROSSPUT_STATS_ADD(event_groups, num_handled);
+
+        if (!success)
         {
             // an error occurred, release GDK interface as an attempt to fix issue and disconnect manually
             ReleaseNativeDevicePtr();
@@ -989,10 +1302,119 @@ namespace crossput
     }
 
 
+    bool WindowsDevice::HandleBufferedReadings(size_t &num_handled)
+    {
+        bool result = true;
+        num_handled = 0;
+
+        IGameInputReading *p_reading;
+        while (reading_buffer_->TryPop(p_reading))
+        {
+            // readings which were already handled by walking the input chain are skipped,
+            // and after a failure the remaining readings are only released
+            if (result && p_reading->GetTimestamp() > last_reading_timestamp_)
+            {
+                result = HandleNativeReading(p_reading);
+                num_handled++;
+            }
+
+            p_reading->Release();
+        }
+
+        return result;
+    }
+
+
+    void WindowsDevice::EnableReadingCallback()
+    {
+        if (reading_token_ != 0 || p_ndev_ == nullptr) { return; }
+        if (nat_input_event == nullptr && !nat_buffer_readings) { return; } // not required
+
+        // the buffer must not change while the callback is registered, DisableReadingCallback() releases it
+        if (nat_buffer_readings)
+        {
+            reading_buffer_ = std::make_unique<SpscQueue<IGameInputReading *, READING_BUFFER_CAPACITY>>();
+            reading_overrun_ = true; // readings that arrived before registration are only part of the chain
+        }
+
+        constexpr auto reading_callback = [](
+            [[maybe_unused]] _In_ GameInputCallbackToken callback_token,
+            [[maybe_unused]] _In_ void * p_context,
+            [[maybe_unused]] _In_ IGameInputReading * p_reading,
+            [[maybe_unused]] _In_ bool has_overrun_occurred)
+        {
+            // runs on a GameInput thread
+            WindowsDevice *const p_windev = reinterpret_cast<WindowsDevice *>(p_context);
+            if (p_windev->reading_buffer_ != nullptr)
+            {
+                // keep reading alive until it is handled during the next update
+                p_reading->AddRef();
+                if (!p_windev->reading_buffer_->TryPush(p_reading))
+                {
+                    p_reading->Release();
+                    has_overrun_occurred = true;
+                }
+
+                if (has_overrun_occurred) { p_windev->reading_overrun_ = true; }
+            }
+
+            p_windev->has_pending_input_ = true;
+            if (nat_input_event != nullptr) { SetEvent(nat_input_event); }
+        };
+
+        if (!SUCCEEDED(p_input->RegisterReadingCallback(
+            p_ndev_,
+            GetQueryInputKind(),
+            0.0F,
+            this,
+            // add __stdcall qualifier to lambda
+            static_cast<void (CALLBACK *)(
+                _In_ GameInputCallbackToken,
+                _In_ void *,
+                _In_ IGameInputReading *,
+                _In_ bool)>
+                (reading_callback),
+            &reading_token_)))
+        {
+            // not supported by all versions of GameInput, WaitForInput() and Update() fall back to polling
+            reading_token_ = 0;
+            reading_buffer_.reset();
+        }
+    }
+
+
+    bool WindowsDevice::ConsumePendingInput()
+    {
+        if (reading_token_ != 0) { return has_pending_input_.exchange(false); }
+
+        // fallback: compare timestamp of most recent reading
+        IGameInputReading *p_reading;
+        if (SUCCEEDED(p_input->GetCurrentReading(GetQueryInputKind(), p_ndev_, &p_reading)))
+        {
+            const bool result = p_reading->GetTimestamp() > last_reading_timestamp_;
+            p_reading->Release();
+            return result;
+        }
+
+        // device is likely disconnected, which is detected during its update
+        return !IsNativeDeviceConnected(p_ndev_);
+    }
+
+
     bool WindowsDevice::TryConnect()
     {
         if (is_connected_) [[unlikely]] { return true; }
 
+        if (nat_hotplug_token != 0)
+        {
+            // only attempt to reconnect after the monitor reported a change
+            const uint64_t generation = nat_hotplug_generation;
+            if (hotplug_generation_ == generation) { return false; }
+            hotplug_generation_ = generation;
+        }
+
+        CROSSPUT_STATS_ADD(reconnect_attempts, 1);
+
         // query connection status (re-bind to GDK interface if needed)
         bool result = p_ndev_ != nullptr
             ? IsNativeDeviceConnected(p_ndev_)
@@ -1002,8 +1424,12 @@ namespace crossput
         {
             is_connected_ = true;
 
-            // query sync capability
             const GameInputDeviceInfo &info = *(p_ndev_->GetDeviceInfo());
+            display_name_ = info.displayName != nullptr
+                ? std::string(info.displayName->data, info.displayName->sizeInBytes)
+                : std::string();
+
+            // query sync capability
             supports_sync_ = (info.capabilities & NATIVE_SYNC_CAPABILITY) != GameInputDeviceCapabilities::GameInputDeviceCapabilityNone;
             if (supports_sync_) { p_ndev_->SetInputSynchronizationState(true); }
 
@@ -1049,11 +1475,10 @@ namespace crossput
             }
             #endif // CROSSPUT_FEATURE_FORCE
 
+            EnableReadingCallback();
             OnConnected();
 
-            #ifdef CROSSPUT_FEATURE_CALLBACK
             DeviceStatusChanged(this, DeviceStatusChange::CONNECTED);
-            #endif // CROSSPUT_FEATURE_CALLBACK
         }
 
         return result;
@@ -1067,8 +1492,12 @@ namespace crossput
         is_connected_ = false;
         last_reading_timestamp_ = 0;
         last_update_timestamp_ = 0;
+        hotplug_generation_ = FORCE_RECONNECT_GENERATION;
         supports_sync_ = false;
+        display_name_.clear();
+        DisableReadingCallback();
         #ifdef CROSSPUT_FEATURE_FORCE
+        OrphanAllForces(); // before clearing motor state a force stream might still read
         motor_capabilities_.clear();
         motor_gains_.clear();
         supports_rumble_ = false;
@@ -1077,13 +1506,7 @@ namespace crossput
 
         OnDisconnected();
 
-        #ifdef CROSSPUT_FEATURE_FORCE
-        OrphanAllForces();
-        #endif // CROSSPUT_FEATURE_FORCE
-
-        #ifdef CROSSPUT_FEATURE_CALLBACK
         DeviceStatusChanged(this, DeviceStatusChange::DISCONNECTED);
-        #endif // CROSSPUT_FEATURE_CALLBACK
     }
 
 
@@ -1147,7 +1570,7 @@ namespace crossput
             
         }
 
-        if (p_force_interface != nullptr) { forces_.insert({p_force_interface->GetID(), p_force_interface}); }
+        if (p_force_interface != nullptr) { InsertForce(p_force_interface); }
         p_force = p_force_interface;
         return result;
     }
@@ -1210,21 +1633,15 @@ namespace crossput
         data_.sx += sdx;
         data_.sy += sdy;
         
-        #ifdef CROSSPUT_FEATURE_CALLBACK
-        if (dx != 0 || dy != 0) { MouseMoved(data_.x, data_.y, dx, dy); }
-        if (sdx != 0 || sdy != 0) { MouseScrolled(data_.sx, data_.sy, sdx, sdy); }
-        #endif // CROSSPUT_FEATURE_CALLBACK
+        if (dx != 0 || dy != 0) { MouseMoved(data_.x, data_.y, dx, dy, timestamp); }
+        if (sdx != 0 || sdy != 0) { MouseScrolled(data_.sx, data_.sy, sdx, sdy, timestamp); }
 
         // update button states and timestamps
         for (unsigned int b = 0; b < WindowsMouse::NUM_BUTTONS; b++)
         {
             const float value = ((ms.buttons & INDEXED_BUTTONS[b]) != GameInputMouseButtons::GameInputMouseNone) ? 1.0F : 0.0F;
-            #ifdef CROSSPUT_FEATURE_CALLBACK
             bool state;
-            if (button_data_[b].Modify(value, timestamp, state)) { ButtonChanged(b, value, state); }
-            #else
-            button_data_[b].Modify(value, timestamp);
-            #endif // CROSSPUT_FEATURE_CALLBACK
+            if (button_data_.Modify(b, value, timestamp, state)) { ButtonChanged(b, value, state, timestamp); }
         }
 
         return true;
@@ -1233,7 +1650,7 @@ namespace crossput
 
     void WindowsMouse::OnDisconnected()
     {
-        std::memset(button_data_, 0, sizeof(button_data_));
+        button_data_.Reset();
         data_ = {};
         offset_ = {};
         has_offset_ = false;
@@ -1277,27 +1694,27 @@ namespace crossput
     {
         if (index < WindowsMouse::NUM_BUTTONS)
         {
-            button_data_[index].SetThreshold(std::clamp(threshold, 0.0F, 1.0F));
+            button_data_.SetThreshold(index, std::clamp(threshold, 0.0F, 1.0F));
         }
     }
 
     constexpr void WindowsMouse::SetGlobalThreshold(float threshold) noexcept
     {
         threshold = std::clamp(threshold, 0.0F, 1.0F);
-        for (unsigned int i = 0; i < WindowsMouse::NUM_BUTTONS; i++) { button_data_[i].SetThreshold(threshold); }
+        for (unsigned int i = 0; i < WindowsMouse::NUM_BUTTONS; i++) { button_data_.SetThreshold(i, threshold); }
     }
 
     constexpr float WindowsMouse::GetButtonThreshold(const uint32_t index) const noexcept
     {
         return index < WindowsMouse::NUM_BUTTONS
-            ? button_data_[index].Threshold()
+            ? button_data_.Threshold(index)
             : 0.0F;
     }
 
     constexpr float WindowsMouse::GetButtonValue(const uint32_t index) const noexcept
     {
         return (is_connected_ && index < WindowsMouse::NUM_BUTTONS)
-            ? button_data_[index].Value()
+            ? button_data_.Value(index)
             : 0.0F;
     }
 
@@ -1305,9 +1722,8 @@ namespace crossput
     {
         if (is_connected_ && index < WindowsMouse::NUM_BUTTONS)
         {
-            const TSTV &d = button_data_[index];
-            time = TimestampDeltaSeconds(d.Timestamp(), last_update_timestamp_);
-            return d.State();
+            time = TimestampDeltaSeconds(button_data_.Timestamp(index), last_update_timestamp_);
+            return button_data_.State(index);
         }
         else
         {
@@ -1316,6 +1732,25 @@ namespace crossput
         }
     }
 
+    void WindowsMouse::GetButtonStates(uint64_t *const states, const size_t num_words) const
+    {
+        button_data_.CopyStates(states, num_words, is_connected_);
+    }
+
+    uint32_t WindowsMouse::GetButtonValues(float *const values, const uint32_t max_count) const
+    {
+        const uint32_t n = std::min(max_count, WindowsMouse::GetButtonCount());
+        button_data_.CopyValues(values, n, is_connected_);
+        return n;
+    }
+
+    uint32_t WindowsMouse::GetButtonTimestamps(uint64_t *const timestamps, const uint32_t max_count) const
+    {
+        const uint32_t n = std::min(max_count, WindowsMouse::GetButtonCount());
+        button_data_.CopyTimestamps(timestamps, n, is_connected_);
+        return n;
+    }
+
 
     // KEYBOARD
     bool WindowsKeyboard::HandleNativeReading(IGameInputReading *const p_reading)
@@ -1340,12 +1775,8 @@ namespace crossput
         for (unsigned int k = 0; k < NUM_KEY_CODES; k++)
         {
             const float value = new_states[k] ? 1.0F : 0.0F;
-            #ifdef CROSSPUT_FEATURE_CALLBACK
             bool state;
-            if (key_data_[k].Modify(value, timestamp, state, num_keys_pressed_)) { KeyChanged(static_cast<Key>(k), value, state); }
-            #else
-            key_data_[k].Modify(value, timestamp, num_keys_pressed_);
-            #endif // CROSSPUT_FEATURE_CALLBACK
+            if (key_data_.Modify(k, value, timestamp, state, num_keys_pressed_)) { KeyChanged(static_cast<Key>(k), value, state, timestamp); }
         }
 
         return true;
@@ -1362,7 +1793,7 @@ namespace crossput
     void WindowsKeyboard::OnDisconnected()
     {
         p_giks_cache_.reset();
-        std::memset(key_data_, 0 ,sizeof(key_data_));
+        key_data_.Reset();
         max_num_keys_pressed_ = 0;
         num_keys_pressed_ = 0;
     }
@@ -1377,27 +1808,27 @@ namespace crossput
     {
         if (IsValidKey(key))
         {
-            key_data_[static_cast<int>(key)].SetThreshold(std::clamp(threshold, 0.0F, 1.0F));
+            key_data_.SetThreshold(static_cast<int>(key), std::clamp(threshold, 0.0F, 1.0F));
         }
     }
 
     constexpr void WindowsKeyboard::SetGlobalThreshold(float threshold)
     {
         threshold = std::clamp(threshold, 0.0F, 1.0F);
-        for (unsigned int i = 0; i < NUM_KEY_CODES; i++) { key_data_[i].SetThreshold(threshold); }
+        for (unsigned int i = 0; i < NUM_KEY_CODES; i++) { key_data_.SetThreshold(i, threshold); }
     }
 
     constexpr float WindowsKeyboard::GetKeyThreshold(const Key key) const
     {
         return IsValidKey(key)
-            ? key_data_[static_cast<int>(key)].Threshold()
+            ? key_data_.Threshold(static_cast<int>(key))
             : 0.0F;
     }
 
     constexpr float WindowsKeyboard::GetKeyValue(const Key key) const
     {
         return (is_connected_ && IsValidKey(key))
-            ? key_data_[static_cast<int>(key)].Value()
+            ? key_data_.Value(static_cast<int>(key))
             : 0.0F;
     }
 
@@ -1405,9 +1836,8 @@ namespace crossput
     {
         if (is_connected_ && IsValidKey(key))
         {
-            const TSTV &d = key_data_[static_cast<int>(key)];
-            time = TimestampDeltaSeconds(d.Timestamp(), last_update_timestamp_);
-            return d.State();
+            time = TimestampDeltaSeconds(key_data_.Timestamp(static_cast<int>(key)), last_update_timestamp_);
+            return key_data_.State(static_cast<int>(key));
         }
         else
         {
@@ -1416,6 +1846,21 @@ namespace crossput
         }
     }
 
+    void WindowsKeyboard::GetKeyStates(uint64_t *const states) const
+    {
+        key_data_.CopyStates(states, NUM_KEY_STATE_WORDS, is_connected_);
+    }
+
+    void WindowsKeyboard::GetKeyValues(float *const values) const
+    {
+        key_data_.CopyValues(values, NUM_KEY_CODES, is_connected_);
+    }
+
+    void WindowsKeyboard::GetKeyTimestamps(uint64_t *const timestamps) const
+    {
+        key_data_.CopyTimestamps(timestamps, NUM_KEY_CODES, is_connected_);
+    }
+
 
     // GAMEPAD
     bool WindowsGamepad::HandleNativeReading(IGameInputReading *const p_reading)
@@ -1431,38 +1876,22 @@ namespace crossput
         last_reading_timestamp_ = gdk_timestamp;
         last_update_timestamp_ = std::max(timestamp, last_update_timestamp_);
 
-        #ifdef CROSSPUT_FEATURE_CALLBACK
-        // => event-based handlers
-
+        // digital button enum handler
         #define HANDLE_GAMEPAD_BUTTON_(from, to) \
         { \
             bool state; \
             const float value = (gs.buttons & GameInputGamepadButtons:: ## from) ? 1.0F : 0.0F; \
-            if (button_data_[static_cast<size_t>(to)].Modify(value, timestamp, state)) { ButtonChanged(static_cast<Button>(to), value, state); } \
+            if (button_data_.Modify(static_cast<size_t>(to), value, timestamp, state)) { ButtonChanged(static_cast<Button>(to), value, state, timestamp); } \
         }
 
-        #define HANDLE_GAMEPAD_TRIGGER_(value, to) \
+        // analog button field handler
+        #define HANDLE_GAMEPAD_TRIGGER_(raw_value, to) \
         { \
             bool state; \
-            if (button_data_[static_cast<size_t>(to)].Modify(value, timestamp, state)) { ButtonChanged(static_cast<Button>(to), value, state); } \
+            const float value = ProcessButton(to, raw_value); \
+            if (button_data_.Modify(static_cast<size_t>(to), value, timestamp, state)) { ButtonChanged(static_cast<Button>(to), value, state, timestamp); } \
         }
 
-        #else
-        // => regular handlers
-
-        // digital button enum handler
-        #define HANDLE_GAMEPAD_BUTTON_(from, to) \
-        { \
-            const float value = (gs.buttons & GameInputGamepadButtons:: ## from) ? 1.0F : 0.0F; \
-            button_data_[static_cast<size_t>(to)].Modify(value, timestamp); \
-        }
-        
-        // analog button field handler
-        #define HANDLE_GAMEPAD_TRIGGER_(value, to) \
-        { button_data_[static_cast<size_t>(to)].Modify(value, timestamp); }
-
-        #endif // CROSSPUT_FEATURE_CALLBACK
-
         // update buttons
         HANDLE_GAMEPAD_BUTTON_(GameInputGamepadY, Button::NORTH)
         HANDLE_GAMEPAD_BUTTON_(GameInputGamepadA, Button::SOUTH)
@@ -1485,8 +1914,8 @@ namespace crossput
         #undef HANDLE_GAMEPAD_BUTTON_
 
         // update thumbsticks
-        HandleThumbstick(0, gs.leftThumbstickX, gs.leftThumbstickY);
-        HandleThumbstick(1, gs.rightThumbstickX, gs.rightThumbstickY);
+        HandleThumbstick(0, gs.leftThumbstickX, gs.leftThumbstickY, timestamp);
+        HandleThumbstick(1, gs.rightThumbstickX, gs.rightThumbstickY, timestamp);
 
         return true;
     }
@@ -1494,8 +1923,9 @@ namespace crossput
 
     void WindowsGamepad::OnDisconnected()
     {
-        std::memset(button_data_, 0, sizeof(button_data_));
+        button_data_.Reset();
         std::memset(thumbstick_values_, 0, sizeof(thumbstick_values_));
+        ResetRawThumbsticks();
     }
 
 
@@ -1503,27 +1933,27 @@ namespace crossput
     {
         if (IsValidButton(button))
         {
-            button_data_[static_cast<int>(button)].SetThreshold(std::clamp(threshold, 0.0F, 1.0F));
+            button_data_.SetThreshold(static_cast<int>(button), std::clamp(threshold, 0.0F, 1.0F));
         }
     }
 
     constexpr void WindowsGamepad::SetGlobalThreshold(float threshold)
     {
         threshold = std::clamp(threshold, 0.0F, 1.0F);
-        for (unsigned int i = 0; i < NUM_BUTTON_CODES; i++) { button_data_[i].SetThreshold(threshold); }
+        for (unsigned int i = 0; i < NUM_BUTTON_CODES; i++) { button_data_.SetThreshold(i, threshold); }
     }
 
     constexpr float WindowsGamepad::GetButtonThreshold(const Button button) const
     {
         return IsValidButton(button)
-            ? button_data_[static_cast<int>(button)].Threshold()
+            ? button_data_.Threshold(static_cast<int>(button))
             : 0.0F;
     }
 
     constexpr float WindowsGamepad::GetButtonValue(const Button button) const
     {
         return (is_connected_ && IsValidButton(button))
-            ? button_data_[static_cast<int>(button)].Value()
+            ? button_data_.Value(static_cast<int>(button))
             : 0.0F;
     }
 
@@ -1531,9 +1961,8 @@ namespace crossput
     {
         if (is_connected_ && IsValidButton(button))
         {
-            const TSTV &d = button_data_[static_cast<int>(button)];
-            time = TimestampDeltaSeconds(d.Timestamp(), last_update_timestamp_);
-            return d.State();
+            time = TimestampDeltaSeconds(button_data_.Timestamp(static_cast<int>(button)), last_update_timestamp_);
+            return button_data_.State(static_cast<int>(button));
         }
         else
         {
@@ -1542,6 +1971,21 @@ namespace crossput
         }
     }
 
+    void WindowsGamepad::GetButtonStates(uint64_t *const states) const
+    {
+        button_data_.CopyStates(states, NUM_BUTTON_STATE_WORDS, is_connected_);
+    }
+
+    void WindowsGamepad::GetButtonValues(float *const values) const
+    {
+        button_data_.CopyValues(values, NUM_BUTTON_CODES, is_connected_);
+    }
+
+    void WindowsGamepad::GetButtonTimestamps(uint64_t *const timestamps) const
+    {
+        button_data_.CopyTimestamps(timestamps, NUM_BUTTON_CODES, is_connected_);
+    }
+
     constexpr uint32_t WindowsGamepad::GetThumbstickCount() const
     {
         return is_connected_ ? WindowsGamepad::NUM_THUMBSTICKS : 0;
@@ -1554,6 +1998,17 @@ namespace crossput
             : std::make_pair(0.0F, 0.0F);
     }
 
+    uint32_t WindowsGamepad::GetThumbsticks(float *const xy, const uint32_t max_count) const
+    {
+        const uint32_t n = std::min(max_count, WindowsGamepad::GetThumbstickCount());
+        for (uint32_t i = 0; i < n; i++)
+        {
+            xy[i * 2] = thumbstick_values_[i].first;
+            xy[i * 2 + 1] = thumbstick_values_[i].second;
+        }
+        return n;
+    }
+
 
     #ifdef CROSSPUT_FEATURE_FORCE
     // RUMBLE FORCE
@@ -1567,6 +2022,7 @@ namespace crossput
         
         p_device_->p_ndev_->SetRumbleState(&p);
         is_active_ = active;
+        if (active) { MarkWritten(); }
     }
 
 
@@ -1575,8 +2031,10 @@ namespace crossput
         const bool result = !IsOrphaned() && params_.type == ForceType::RUMBLE && is_active_;
         if (result)
         {
+            // the rumble state depends on the gain, so uploads are never skipped
             GameInputRumbleParams p = TranslateRumbleParams(params_.rumble, p_device_->motor_gains_[0]);
             p_device_->p_ndev_->SetRumbleState(&p);
+            MarkWritten();
         }
         return result;
     }
@@ -1600,8 +2058,12 @@ namespace crossput
             if (p_ff_effect_->GetState() == GameInputFeedbackEffectState::GameInputFeedbackRunning) { return; }
 
             // implicitly apply changes to parameters before activating force
-            GameInputForceFeedbackParams p = TranslateForceFeedbackParams(params_);
-            if (!p_ff_effect_->SetParams(&p)) { return; }
+            if (IsDirty())
+            {
+                GameInputForceFeedbackParams p = TranslateForceFeedbackParams(params_);
+                if (!p_ff_effect_->SetParams(&p)) { return; }
+                MarkWritten();
+            }
         }
 
         p_ff_effect_->SetState(active ? GameInputFeedbackEffectState::GameInputFeedbackRunning : GameInputFeedbackEffectState::GameInputFeedbackStopped);
@@ -1612,8 +2074,13 @@ namespace crossput
     {
         if (!IsOrphaned() && type_ == params_.type)
         {
+            if (!IsDirty()) { return true; } // effect already holds these parameters
+
             GameInputForceFeedbackParams p = TranslateForceFeedbackParams(params_);
-            return p_ff_effect_->SetParams(&p);
+            if (!p_ff_effect_->SetParams(&p)) { return false; }
+
+            MarkWritten();
+            return true;
         }
         return false;        
     }
@@ -0,0 +1,71 @@
+/*================================================================================= *
+*                                   +----------+                                    *
+*                                   | crossput |                                    *
+*                                   +----------+                                    *
+*                            Copyright 2024 Trice Helix                             *
+*                                                                                   *
+* This file is part of crossput and is distributed under the BSD-3-Clause License.  *
+* Please refer to LICENSE.txt for additional information.                           *
+* =================================================================================*/
+
+// Disabling the reading buffer without ever invoking WaitForInput() must make devices read the input history of GameInput again.
+// An update which handles buffered readings issues a single call, while reading the history always issues at least two.
+
+#include <format>
+#include <iostream>
+#include <vector>
+
+#include "crossput.hpp"
+
+
+// reported to CTest when no device is connected
+constexpr int SKIP_RETURN_CODE = 77;
+
+
+uint64_t CountUpdateSyscalls(crossput::IDevice *const p_device)
+{
+    crossput::DeviceStats before, after;
+    crossput::GetDeviceStats(p_device->GetID(), before);
+    p_device->Update();
+    crossput::GetDeviceStats(p_device->GetID(), after);
+    return after.syscalls - before.syscalls;
+}
+
+
+int main()
+{
+    std::vector<crossput::IDevice *> devices;
+    crossput::SetReadingBufferEnabled(true);
+    crossput::DiscoverDevices();
+    crossput::UpdateAllDevices();
+    crossput::GetDevices(devices, true);
+
+    if (devices.empty())
+    {
+        std::cout << "No connected device, skipping." << std::endl;
+        return SKIP_RETURN_CODE;
+    }
+
+    crossput::IDevice *const p_device = devices.front();
+
+    // the first update after registration reads the history, the following ones handle buffered readings
+    p_device->Update();
+    if (CountUpdateSyscalls(p_device) != 1)
+    {
+        std::cout << "Reading callbacks are not supported, skipping." << std::endl;
+        return SKIP_RETURN_CODE;
+    }
+
+    crossput::SetReadingBufferEnabled(false);
+    for (int i = 0; i < 4; i++)
+    {
+        const uint64_t syscalls = CountUpdateSyscalls(p_device);
+        if (syscalls < 2)
+        {
+            std::cout << std::format("Update {} after disabling the reading buffer did not read the input history ({} calls).", i, syscalls) << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}